@@ -39,9 +39,13 @@ SOURCES += \
     src/HistoryModel.cpp \
     src/MeCardConverter.cpp \
     src/OfdReceiptFetcher.cpp \
+    src/ScanStats.cpp \
     src/Settings.cpp \
+    src/ThreadPriority.cpp \
     src/scanner/BarcodeScanner.cpp \
     src/scanner/Decoder.cpp \
+    src/scanner/DecodingScheduler.cpp \
+    src/scanner/FrameAccumulator.cpp \
     src/scanner/ImageSource.cpp
 
 HEADERS += \
@@ -52,9 +56,13 @@ HEADERS += \
     src/HistoryModel.h \
     src/MeCardConverter.h \
     src/OfdReceiptFetcher.h \
+    src/ScanStats.h \
     src/Settings.h \
+    src/ThreadPriority.h \
     src/scanner/BarcodeScanner.h \
     src/scanner/Decoder.h \
+    src/scanner/DecodingScheduler.h \
+    src/scanner/FrameAccumulator.h \
     src/scanner/ImageSource.h
 
 OTHER_FILES += \
@@ -132,12 +140,16 @@ HEADERS += \
     src/zxing/bigint/NumberlikeArray.hh
 
 SOURCES += \
+    src/zxing/zxing/common/AdaptiveBinarizer.cpp \
     src/zxing/zxing/common/BitArray.cpp \
     src/zxing/zxing/common/BitMatrix.cpp \
     src/zxing/zxing/common/BitSource.cpp \
+    src/zxing/zxing/common/CharacterSetDecoder.cpp \
     src/zxing/zxing/common/CharacterSetECI.cpp \
     src/zxing/zxing/common/DecoderResult.cpp \
+    src/zxing/zxing/common/DecoderResultCache.cpp \
     src/zxing/zxing/common/DetectorResult.cpp \
+    src/zxing/zxing/common/GlareMask.cpp \
     src/zxing/zxing/common/GlobalHistogramBinarizer.cpp \
     src/zxing/zxing/common/GridSampler.cpp \
     src/zxing/zxing/common/HybridBinarizer.cpp \
@@ -148,13 +160,17 @@ SOURCES += \
 
 HEADERS += \
     src/zxing/zxing/common/Array.h \
+    src/zxing/zxing/common/AdaptiveBinarizer.h \
     src/zxing/zxing/common/BitArray.h \
     src/zxing/zxing/common/BitMatrix.h \
     src/zxing/zxing/common/BitSource.h \
+    src/zxing/zxing/common/CharacterSetDecoder.h \
     src/zxing/zxing/common/CharacterSetECI.h \
     src/zxing/zxing/common/Counted.h \
     src/zxing/zxing/common/DecoderResult.h \
+    src/zxing/zxing/common/DecoderResultCache.h \
     src/zxing/zxing/common/DetectorResult.h \
+    src/zxing/zxing/common/GlareMask.h \
     src/zxing/zxing/common/GlobalHistogramBinarizer.h \
     src/zxing/zxing/common/GridSampler.h \
     src/zxing/zxing/common/HybridBinarizer.h \
@@ -167,11 +183,13 @@ HEADERS += \
 
 SOURCES += \
     src/zxing/zxing/common/detector/MonochromeRectangleDetector.cpp \
+    src/zxing/zxing/common/detector/RunLengthDetector.cpp \
     src/zxing/zxing/common/detector/WhiteRectangleDetector.cpp
 
 HEADERS += \
     src/zxing/zxing/common/detector/MathUtils.h \
     src/zxing/zxing/common/detector/MonochromeRectangleDetector.h \
+    src/zxing/zxing/common/detector/RunLengthDetector.h \
     src/zxing/zxing/common/detector/WhiteRectangleDetector.h
 
 SOURCES += \
@@ -247,10 +265,12 @@ SOURCES += \
     src/zxing/zxing/oned/EAN13Reader.cpp \
     src/zxing/zxing/oned/EAN8Reader.cpp \
     src/zxing/zxing/oned/ITFReader.cpp \
+    src/zxing/zxing/oned/MotionDeblur.cpp \
     src/zxing/zxing/oned/MultiFormatOneDReader.cpp \
     src/zxing/zxing/oned/MultiFormatUPCEANReader.cpp \
     src/zxing/zxing/oned/OneDReader.cpp \
     src/zxing/zxing/oned/OneDResultPoint.cpp \
+    src/zxing/zxing/oned/SubPixelRow.cpp \
     src/zxing/zxing/oned/UPCAReader.cpp \
     src/zxing/zxing/oned/UPCEANReader.cpp \
     src/zxing/zxing/oned/UPCEReader.cpp
@@ -263,10 +283,12 @@ HEADERS += \
     src/zxing/zxing/oned/EAN13Reader.h \
     src/zxing/zxing/oned/EAN8Reader.h \
     src/zxing/zxing/oned/ITFReader.h \
+    src/zxing/zxing/oned/MotionDeblur.h \
     src/zxing/zxing/oned/MultiFormatOneDReader.h \
     src/zxing/zxing/oned/MultiFormatUPCEANReader.h \
     src/zxing/zxing/oned/OneDReader.h \
     src/zxing/zxing/oned/OneDResultPoint.h \
+    src/zxing/zxing/oned/SubPixelRow.h \
     src/zxing/zxing/oned/UPCAReader.h \
     src/zxing/zxing/oned/UPCEANReader.h \
     src/zxing/zxing/oned/UPCEReader.h
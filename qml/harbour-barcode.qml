@@ -65,6 +65,12 @@ ApplicationWindow {
         value: AppSettings.saveImages
     }
 
+    Binding {
+        target: HistoryModel
+        property: "dedupe"
+        value: AppSettings.historyDedupe
+    }
+
     Component.onCompleted: pageStack.pushAttached(historyPage)
 
     Component {
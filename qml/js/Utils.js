@@ -26,48 +26,6 @@ THE SOFTWARE.
 .pragma library
 .import harbour.barcode 1.0 as App
 
-function isVcard(text) {
-    if (text.length > 11 && text.substring(0,11) === "BEGIN:VCARD") {
-        var c = text.charAt(11)
-        return c === '\r' || c === '\n'
-    }
-    return false
-}
-
-function isVevent(text) {
-    if (text.length > 12) {
-        var c
-        if (text.substring(0,12) === "BEGIN:VEVENT") {
-            c = text.charAt(12)
-            if (c === '\r' || c === '\n') {
-                return true
-            }
-        }
-        if (text.length > 15) {
-            if (text.substring(0,15) === "BEGIN:VCALENDAR") {
-                c = text.charAt(15)
-                if (c === '\r' || c === '\n') {
-                    return true
-                }
-            }
-        }
-    }
-    return false
-}
-
-function isUrl(text) {
-    return App.BarcodeUtils.urlScheme(text).length > 0
-}
-
-function isLink(text) {
-    var scheme = App.BarcodeUtils.urlScheme(text)
-    return scheme === "http" || scheme === "https"
-}
-
-function isText(text) {
-    return !isLink(text);
-}
-
 function calendarText(text) {
     return (text.substring(0,12) === "BEGIN:VEVENT") ?
         ("BEGIN:VCALENDAR\nVERSION:1.0\n" + text + "\nEND:VCALENDAR") :
@@ -82,8 +40,8 @@ function convertLineBreaks(text) {
     return text.replace(/\r\n/g, '\n').replace(/\r/g, '\n')
 }
 
-function getValueText(value) {
-    if (isLink(value)) {
+function getValueText(value, type) {
+    if (type === App.BarcodeUtils.ContentLink) {
         return value
     } else {
         return removeLineBreak(value)
@@ -36,16 +36,17 @@ Item {
     property string recordId
     property bool hasImage
     property string format
+    property int type: BarcodeUtils.contentType(text, format)
     property string timestamp
     property bool isPortrait
     property bool canDelete: true
     property real offsetY
 
     readonly property string normalizedText: Utils.convertLineBreaks(text)
-    readonly property bool isUrl: Utils.isUrl(text) && !isVCard && !isVEvent
-    readonly property bool isLink: Utils.isLink(text) && !isVCard && !isVEvent
-    readonly property bool isVCard: (meCardConverter.vcard.length > 0 || Utils.isVcard(normalizedText)) && !isVEvent
-    readonly property bool isVEvent: Utils.isVevent(normalizedText)
+    readonly property bool isUrl: type === BarcodeUtils.ContentUrl || type === BarcodeUtils.ContentWiFi || isLink
+    readonly property bool isLink: type === BarcodeUtils.ContentLink
+    readonly property bool isVCard: type === BarcodeUtils.ContentVCard || meCardConverter.vcard.length > 0
+    readonly property bool isVEvent: type === BarcodeUtils.ContentVEvent
     readonly property bool haveContact: vcard ? (vcard.count > 0) : false
     readonly property bool haveEvent: !!calendarEvent.fileName
     property var vcard
@@ -77,7 +78,7 @@ Item {
     MeCardConverter {
         id: meCardConverter
 
-        mecard: normalizedText
+        mecard: (type === BarcodeUtils.ContentMeCard) ? normalizedText : ""
         onVcardChanged: updateVcard()
     }
 
@@ -91,7 +92,7 @@ Item {
     ReceiptFetcher {
         id: receiptFetcher
 
-        code: codeItem.text
+        code: (type === BarcodeUtils.ContentReceipt) ? codeItem.text : ""
     }
 
     SilicaFlickable {
@@ -74,6 +74,7 @@ Page {
             recordId: model.id
             text: model.value
             format: model.format
+            type: model.type
             timestamp: model.timestamp
             isPortrait: codePage.isPortrait
             canDelete: true
@@ -35,6 +35,8 @@ ListItem {
     property string value
     property string timestamp
     property string format
+    property int type
+    property int scanCount: 1
     property bool selected
 
     Column {
@@ -48,7 +50,7 @@ ListItem {
             font.pixelSize: Theme.fontSizeSmall
             maximumLineCount: 1
             truncationMode: TruncationMode.Fade
-            text: Utils.getValueText(item.value)
+            text: Utils.getValueText(item.value, item.type)
         }
 
         Item {
@@ -64,7 +66,8 @@ ListItem {
                 }
                 color: item.highlighted ? Theme.secondaryHighlightColor : Theme.secondaryColor
                 font.pixelSize: Theme.fontSizeExtraSmall
-                text: HistoryModel.formatTimestamp(item.timestamp)
+                text: HistoryModel.formatTimestamp(item.timestamp) +
+                    (item.scanCount > 1 ? "  \u00d7" + item.scanCount : "")
             }
 
             Label {
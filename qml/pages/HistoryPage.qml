@@ -41,7 +41,10 @@ Page {
     readonly property bool empty: HistoryModel.count === 0
 
     onStatusChanged: {
-        if (status === PageStatus.Active) {
+        if (status === PageStatus.Activating) {
+            // History is loaded on demand
+            HistoryModel.load()
+        } else if (status === PageStatus.Active) {
             myStackDepth = pageStack.depth
         } else if (status === PageStatus.Inactive) {
             // We also end up here after TextPage gets pushed
@@ -94,9 +97,11 @@ Page {
         delegate: HistoryItem {
             id: delegate
 
-            value: model.value
-            timestamp: model.timestamp
+            value: model.preview
+            timestamp: model.last_seen
             format: model.format
+            type: model.type
+            scanCount: model.scan_count
             enabled: !model.selected || !remorsePopup.visible
             opacity: enabled ? 1 : 0.2
 
@@ -151,8 +156,14 @@ Page {
         }
 
         PullDownMenu {
-            visible: !historyPage.empty
             MenuItem {
+                //: Pulley menu item
+                //% "Statistics"
+                text: qsTrId("history-menu-stats")
+                onClicked: pageStack.push("StatsPage.qml")
+            }
+            MenuItem {
+                visible: !historyPage.empty
                 //: Pulley menu item
                 //% "Clear"
                 text: qsTrId("history-menu-clear")
@@ -164,6 +175,7 @@ Page {
                 }
             }
             MenuItem {
+                visible: !historyPage.empty
                 //: Pulley menu item
                 //% "Select"
                 text: qsTrId("history-menu-select")
@@ -209,6 +209,8 @@ Page {
         viewFinderItem: viewFinderContainer
         markerColor: AppSettings.markerColor
         rotation: orientationAngle()
+        decodingPriority: AppSettings.decodingPriority
+        decodingCpus: AppSettings.decodingCpus
 
         onDecodingFinished: {
             if (result.ok) {
@@ -512,15 +514,16 @@ Page {
                 property string recordId
                 property string text
                 property string format
+                readonly property int type: BarcodeUtils.contentType(text, format)
 
                 property var vcard: null
                 readonly property bool haveContact: vcard && vcard.count > 0
                 readonly property string normalizedText: Utils.convertLineBreaks(text)
                 readonly property string vcardText: (meCardConverter.vcard.length > 0) ? meCardConverter.vcard :
-                    Utils.isVcard(normalizedText) ? normalizedText : ""
+                    (type === BarcodeUtils.ContentVCard) ? normalizedText : ""
                 readonly property bool isVCard: vcardText.length > 0
-                readonly property bool isLink: Utils.isLink(text)
-                readonly property bool isUrl: Utils.isUrl(text)
+                readonly property bool isLink: type === BarcodeUtils.ContentLink
+                readonly property bool isUrl: type === BarcodeUtils.ContentUrl || type === BarcodeUtils.ContentWiFi || isLink
 
                 function setValue(recId, text, format) {
                     clickableResult.recordId = recId
@@ -563,7 +566,7 @@ Page {
                 MeCardConverter {
                     id: meCardConverter
 
-                    mecard: clickableResult.normalizedText
+                    mecard: (clickableResult.type === BarcodeUtils.ContentMeCard) ? clickableResult.normalizedText : ""
                 }
 
                 // Clear results when the first history item gets deleted
@@ -687,7 +690,7 @@ Page {
                     width: parent.width - x
                     anchors.verticalCenter: parent.verticalCenter
                     Label {
-                        text: Utils.getValueText(clickableResult.text)
+                        text: Utils.getValueText(clickableResult.text, clickableResult.type)
                         color: resultItem.highlighted ? Theme.highlightColor : Theme.primaryColor
                         width: parent.width
                         truncationMode: TruncationMode.Fade
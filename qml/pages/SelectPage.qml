@@ -91,9 +91,11 @@ Page {
         }
 
         delegate: HistoryItem {
-            value: model.value
-            timestamp: model.timestamp
+            value: model.preview
+            timestamp: model.last_seen
             format: model.format
+            type: model.type
+            scanCount: model.scan_count
             selected: model.selected
             onClicked: model.selected = !model.selected
         }
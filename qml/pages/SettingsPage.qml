@@ -377,6 +377,18 @@ Page {
                 }
             }
 
+            TextSwitch {
+                checked: AppSettings.historyDedupe
+                //: Switch button text
+                //% "Merge repeated scans"
+                text: qsTrId("settings-history-dedupe-label")
+                //: Switch button description (explanation)
+                //% "Scanning the same code again updates its scan count instead of adding a new entry. Turning this on permanently deletes the existing duplicates, only the most recent entry of each code is kept."
+                description: qsTrId("settings-history-dedupe-description")
+                automaticCheck: false
+                onClicked: AppSettings.historyDedupe = !checked
+            }
+
             //: Section header
             //% "Marker"
             SectionHeader { text: qsTrId("settings-marker-section") }
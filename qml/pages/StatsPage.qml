@@ -0,0 +1,131 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+import QtQuick 2.0
+import Sailfish.Silica 1.0
+import harbour.barcode 1.0
+
+import "../js/Utils.js" as Utils
+import "../components"
+
+Page {
+    id: statsPage
+
+    allowedOrientations: window.allowedOrientations
+
+    // Everything on this page is read from the aggregates, never
+    // from the history itself
+    property int days: 7
+    property var daily: ScanStats.daily(days)
+    property var formats: ScanStats.formats(days)
+
+    Connections {
+        target: ScanStats
+        onChanged: {
+            statsPage.daily = ScanStats.daily(statsPage.days)
+            statsPage.formats = ScanStats.formats(statsPage.days)
+        }
+    }
+
+    SilicaFlickable {
+        anchors.fill: parent
+        contentHeight: statsColumn.height
+
+        Column {
+            id: statsColumn
+
+            width: parent.width
+
+            PageHeader {
+                //: Statistics page title
+                //% "Statistics"
+                title: qsTrId("stats-title")
+            }
+
+            LabelText {
+                //: Statistics page label
+                //% "Total scans"
+                label: qsTrId("stats-total_scans-label")
+                text: ScanStats.totalScans
+            }
+
+            LabelText {
+                //: Statistics page label
+                //% "Distinct codes"
+                label: qsTrId("stats-distinct_codes-label")
+                text: ScanStats.distinctCodes
+            }
+
+            SectionHeader {
+                //: Section header
+                //% "Last %1 days"
+                text: qsTrId("stats-days-section").arg(statsPage.days)
+            }
+
+            Repeater {
+                model: statsPage.daily
+                LabelText {
+                    label: modelData.day
+                    //: Number of scans and new codes on a particular day
+                    //% "%1 scan(s), %2 new"
+                    text: qsTrId("stats-day-text", modelData.scans).arg(modelData.scans).arg(modelData.newCodes)
+                }
+            }
+
+            SectionHeader {
+                //: Section header
+                //% "Formats"
+                text: qsTrId("stats-formats-section")
+            }
+
+            Repeater {
+                model: statsPage.formats
+                LabelText {
+                    label: Utils.barcodeFormat(modelData.format)
+                    text: modelData.scans
+                }
+            }
+        }
+
+        PullDownMenu {
+            MenuItem {
+                //: Pulley menu item
+                //% "Reset"
+                text: qsTrId("stats-menu-reset")
+                onClicked: {
+                    //: Remorse popup text
+                    //% "Resetting statistics"
+                    remorsePopup.execute(qsTrId("stats-remorse-resetting"),
+                        function() { ScanStats.reset() })
+                }
+            }
+        }
+
+        RemorsePopup {
+            id: remorsePopup
+        }
+
+        VerticalScrollDecorator { }
+    }
+}
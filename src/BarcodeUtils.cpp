@@ -23,6 +23,46 @@ THE SOFTWARE.
 */
 
 #include "BarcodeUtils.h"
+#include "OfdReceiptFetcher.h"
+
+// Text starting with the prefix followed by a line break
+static bool startsWithLine(QString aText, QString aPrefix)
+{
+    const int n = aPrefix.length();
+    if (aText.length() > n && aText.startsWith(aPrefix)) {
+        const QChar c(aText.at(n));
+        return c == '\r' || c == '\n';
+    }
+    return false;
+}
+
+// GS1 data carries a symbology identifier, a leading FNC1 (which the
+// decoder turns into ASCII 29) or human readable AIs in parentheses
+static bool isGS1(QString aText, QString aFormat)
+{
+    static const QString gs1Prefix[] = {
+        QStringLiteral("]C1"), QStringLiteral("]d2"),
+        QStringLiteral("]Q3"), QStringLiteral("]e0")
+    };
+    for (uint i = 0; i < sizeof(gs1Prefix)/sizeof(gs1Prefix[0]); i++) {
+        if (aText.startsWith(gs1Prefix[i])) {
+            return true;
+        }
+    }
+    if (aText.startsWith(QChar(29))) {
+        return true;
+    }
+    if (aFormat == QLatin1String("CODE_128") ||
+        aFormat == QLatin1String("DATA_MATRIX") ||
+        aFormat == QLatin1String("RSS_14") ||
+        aFormat == QLatin1String("RSS_EXPANDED")) {
+        // e.g. "(01)09501101530003(17)140704(10)AB-123"
+        return aText.length() > 4 && aText.at(0) == '(' &&
+            aText.at(1).isDigit() && aText.at(2).isDigit() &&
+            aText.at(3) == ')';
+    }
+    return false;
+}
 
 BarcodeUtils::BarcodeUtils(QObject* aParent) :
     QObject(aParent)
@@ -43,3 +83,33 @@ QString BarcodeUtils::urlScheme(QString aText)
         QUrl(aText, QUrl::StrictMode).scheme() :
         QString();
 }
+
+// Classifies the payload once, so that QML doesn't have to re-run the
+// same string tests every time a delegate is created
+int BarcodeUtils::contentType(QString aText, QString aFormat)
+{
+    if (startsWithLine(aText, QStringLiteral("BEGIN:VEVENT")) ||
+        startsWithLine(aText, QStringLiteral("BEGIN:VCALENDAR"))) {
+        return ContentVEvent;
+    } else if (startsWithLine(aText, QStringLiteral("BEGIN:VCARD"))) {
+        return ContentVCard;
+    } else if (aText.startsWith(QStringLiteral("MECARD:"))) {
+        return ContentMeCard;
+    } else if (aText.startsWith(QStringLiteral("WIFI:"))) {
+        return ContentWiFi;
+    } else if (isGS1(aText, aFormat)) {
+        return ContentGS1;
+    } else if (OfdReceiptFetcher::isReceiptCode(aText)) {
+        return ContentReceipt;
+    } else {
+        const QString scheme(urlScheme(aText));
+        if (scheme.isEmpty()) {
+            return ContentText;
+        } else if (scheme == QLatin1String("http") ||
+            scheme == QLatin1String("https")) {
+            return ContentLink;
+        } else {
+            return ContentUrl;
+        }
+    }
+}
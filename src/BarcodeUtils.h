@@ -33,14 +33,29 @@ class QJSEngine;
 
 class BarcodeUtils : public QObject {
     Q_OBJECT
+    Q_ENUMS(ContentType)
 
 public:
+    // Values are stored in the database, don't renumber
+    enum ContentType {
+        ContentText,
+        ContentUrl,     // Any URL other than http(s)
+        ContentLink,    // http or https URL
+        ContentVCard,
+        ContentMeCard,
+        ContentVEvent,  // Including VCALENDAR
+        ContentReceipt, // Russian fiscal receipt
+        ContentWiFi,
+        ContentGS1
+    };
+
     BarcodeUtils(QObject* aParent = Q_NULLPTR);
 
     // Callback for qmlRegisterSingletonType<BarcodeUtils>
     static QObject* createSingleton(QQmlEngine* aEngine, QJSEngine* aScript);
 
     Q_INVOKABLE static QString urlScheme(QString aText);
+    Q_INVOKABLE static int contentType(QString aText, QString aFormat);
 };
 
 #endif // BARCODE_UTILS_H
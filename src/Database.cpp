@@ -24,6 +24,7 @@ THE SOFTWARE.
 
 #include "Database.h"
 #include "HistoryModel.h"
+#include "ScanStats.h"
 #include "Settings.h"
 
 #include "HarbourDebug.h"
@@ -41,6 +42,9 @@ THE SOFTWARE.
 #define SETTINGS_FIELD_VALUE    "value"
 
 #define HISTORY_TMP_TABLE        HISTORY_TABLE "_tmp"
+#define HISTORY_TYPE_INDEX       HISTORY_TABLE "_" HISTORY_FIELD_TYPE
+#define HISTORY_LAST_SEEN_INDEX  HISTORY_TABLE "_" HISTORY_FIELD_LAST_SEEN
+#define HISTORY_FORMAT_INDEX     HISTORY_TABLE "_" HISTORY_FIELD_FORMAT
 
 // ==========================================================================
 // Database::Private
@@ -53,11 +57,13 @@ public:
 
     static QString gDatabasePath;
     static QDir gImageDir;
+    static bool gUpsertSupported;
 
     typedef void (Settings::*SetBool)(bool aValue);
     typedef void (Settings::*SetInt)(int aValue);
     typedef void (Settings::*SetString)(QString aValue);
 
+    static bool checkUpsert(QSqlDatabase aDb);
     static QVariant settingsValue(QSqlDatabase aDb, QString aKey);
     static void migrateBool(QSqlDatabase aDb, QString aKey,
         Settings* aSettings, SetBool aSetter);
@@ -72,6 +78,26 @@ const QString Database::Private::DB_NAME("CodeReader");
 
 QString Database::Private::gDatabasePath;
 QDir Database::Private::gImageDir;
+bool Database::Private::gUpsertSupported = false;
+
+// INSERT ... ON CONFLICT DO UPDATE appeared in SQLite 3.24.0
+bool Database::Private::checkUpsert(QSqlDatabase aDb)
+{
+    QSqlQuery query(aDb);
+    if (query.exec("SELECT sqlite_version()") && query.next()) {
+        const QString version(query.value(0).toString());
+        const QStringList parts(version.split(QChar('.')));
+        const int major = parts.value(0).toInt();
+        const int minor = parts.value(1).toInt();
+        const bool ok = (major > 3 || (major == 3 && minor >= 24));
+        HDEBUG("SQLite" << qPrintable(version) << (ok ? "supports" :
+            "doesn't support") << "upsert");
+        return ok;
+    } else {
+        HWARN(query.lastError());
+        return false;
+    }
+}
 
 QVariant Database::Private::settingsValue(QSqlDatabase aDb, QString aKey)
 {
@@ -176,6 +202,7 @@ void Database::initialize(QQmlEngine* aEngine, Settings* aSettings)
     if (db.open()) {
         tables = db.tables();
         HDEBUG(tables);
+        Private::gUpsertSupported = Private::checkUpsert(db);
     } else {
         HWARN(db.lastError());
     }
@@ -229,6 +256,79 @@ void Database::initialize(QQmlEngine* aEngine, Settings* aSettings)
                 HWARN(db.lastError());
                 HVERIFY(db.rollback());
             }
+            record = db.record(history);
+        }
+        if (record.indexOf(HISTORY_FIELD_TYPE) < 0) {
+            // Content type is NULL until the existing rows get
+            // classified by HistoryModel in the background
+            HDEBUG("Adding " HISTORY_FIELD_TYPE " to the database");
+            QSqlQuery query(db);
+            query.prepare("ALTER TABLE " HISTORY_TABLE " ADD COLUMN "
+                HISTORY_FIELD_TYPE " INTEGER");
+            if (!query.exec()) {
+                HWARN(query.lastError());
+            }
+        }
+        if (record.indexOf(HISTORY_FIELD_PREVIEW) < 0) {
+            // The list only shows the beginning of each value. SQLite's
+            // substr() counts characters, which is what we need here.
+            static const char* stmts[] = {
+                "ALTER TABLE " HISTORY_TABLE " ADD COLUMN "
+                    HISTORY_FIELD_PREVIEW " TEXT",
+                "UPDATE " HISTORY_TABLE " SET " HISTORY_FIELD_PREVIEW
+                    " = substr(" HISTORY_FIELD_VALUE ", 1, "
+                    QT_STRINGIFY(HISTORY_PREVIEW_LENGTH) ")",
+                NULL
+            };
+            HDEBUG("Adding " HISTORY_FIELD_PREVIEW " to the database");
+            HVERIFY(db.transaction());
+            bool ok = true;
+            for (int i = 0; ok && stmts[i]; i++) {
+                ok = QSqlQuery(db).exec(QLatin1String(stmts[i]));
+            }
+            if (ok) {
+                HVERIFY(db.commit());
+            } else {
+                HWARN(db.lastError());
+                HVERIFY(db.rollback());
+            }
+        }
+        if (record.indexOf(HISTORY_FIELD_SCAN_COUNT) < 0) {
+            // Rows stored so far have been seen once, when they were
+            // scanned. ADD COLUMN fills existing rows with the default.
+            static const char* stmts[] = {
+                "ALTER TABLE " HISTORY_TABLE " ADD COLUMN "
+                    HISTORY_FIELD_SCAN_COUNT " INTEGER DEFAULT 1",
+                "ALTER TABLE " HISTORY_TABLE " ADD COLUMN "
+                    HISTORY_FIELD_LAST_SEEN " TEXT",
+                "UPDATE " HISTORY_TABLE " SET " HISTORY_FIELD_LAST_SEEN
+                    " = " HISTORY_FIELD_TIMESTAMP,
+                NULL
+            };
+            HDEBUG("Adding " HISTORY_FIELD_SCAN_COUNT " and "
+                HISTORY_FIELD_LAST_SEEN " to the database");
+            HVERIFY(db.transaction());
+            bool ok = true;
+            for (int i = 0; ok && stmts[i]; i++) {
+                ok = QSqlQuery(db).exec(QLatin1String(stmts[i]));
+            }
+            if (ok) {
+                HVERIFY(db.commit());
+            } else {
+                HWARN(db.lastError());
+                HVERIFY(db.rollback());
+            }
+        }
+        if (record.indexOf(HISTORY_FIELD_IMAGE) < 0) {
+            // NULL means that it's not known yet whether the row has an
+            // image. HistoryModel finds out when it's cleaning up files.
+            HDEBUG("Adding " HISTORY_FIELD_IMAGE " to the database");
+            QSqlQuery query(db);
+            query.prepare("ALTER TABLE " HISTORY_TABLE " ADD COLUMN "
+                HISTORY_FIELD_IMAGE " INTEGER");
+            if (!query.exec()) {
+                HWARN(query.lastError());
+            }
         }
         if (tables.contains(SETTINGS_TABLE)) {
             // The settings table is there, copy those to dconf
@@ -263,10 +363,84 @@ void Database::initialize(QQmlEngine* aEngine, Settings* aSettings)
             HISTORY_FIELD_ID " INTEGER PRIMARY KEY AUTOINCREMENT, "
             HISTORY_FIELD_VALUE " TEXT, "
             HISTORY_FIELD_TIMESTAMP " TEXT, "
-            HISTORY_FIELD_FORMAT " TEXT)")) {
+            HISTORY_FIELD_FORMAT " TEXT, "
+            HISTORY_FIELD_TYPE " INTEGER, "
+            HISTORY_FIELD_PREVIEW " TEXT, "
+            HISTORY_FIELD_SCAN_COUNT " INTEGER DEFAULT 1, "
+            HISTORY_FIELD_LAST_SEEN " TEXT, "
+            HISTORY_FIELD_IMAGE " INTEGER)")) {
             HWARN(query.lastError());
         }
     }
+
+    // Neither sorting nor filtering by content type, format or date
+    // should require a full table scan
+    static const char* indices[] = {
+        "CREATE INDEX IF NOT EXISTS " HISTORY_TYPE_INDEX
+            " ON " HISTORY_TABLE " (" HISTORY_FIELD_TYPE ")",
+        "CREATE INDEX IF NOT EXISTS " HISTORY_LAST_SEEN_INDEX
+            " ON " HISTORY_TABLE " (" HISTORY_FIELD_LAST_SEEN ")",
+        "CREATE INDEX IF NOT EXISTS " HISTORY_FORMAT_INDEX
+            " ON " HISTORY_TABLE " (" HISTORY_FIELD_FORMAT ", "
+            HISTORY_FIELD_LAST_SEEN ")",
+        NULL
+    };
+    for (int i = 0; indices[i]; i++) {
+        QSqlQuery query(db);
+        if (!query.exec(QLatin1String(indices[i]))) {
+            HWARN(query.lastError());
+        }
+    }
+
+    if (!tables.contains(STATS_TABLE)) {
+        // The statistics didn't exist before, start with what's in the
+        // history. Scans which didn't make it there are lost, obviously.
+        static const char* stmts[] = {
+            "CREATE TABLE " STATS_TABLE " ("
+                STATS_FIELD_DAY " TEXT, "
+                STATS_FIELD_HOUR " INTEGER, "
+                STATS_FIELD_FORMAT " TEXT, "
+                STATS_FIELD_SCANS " INTEGER, "
+                STATS_FIELD_NEW_CODES " INTEGER, "
+                "PRIMARY KEY (" STATS_FIELD_DAY ", " STATS_FIELD_HOUR ", "
+                STATS_FIELD_FORMAT ")) WITHOUT ROWID",
+            "CREATE TABLE " STATS_CODES_TABLE " ("
+                STATS_CODES_FIELD_CODE " BLOB PRIMARY KEY, "
+                STATS_CODES_FIELD_DAY " TEXT) WITHOUT ROWID",
+            NULL
+        };
+        HDEBUG("Initializing " STATS_TABLE);
+        HVERIFY(db.transaction());
+        bool ok = true;
+        for (int i = 0; ok && stmts[i]; i++) {
+            ok = QSqlQuery(db).exec(QLatin1String(stmts[i]));
+        }
+        if (ok) {
+            QSqlQuery rows(db);
+            if (rows.exec("SELECT " HISTORY_FIELD_VALUE ", "
+                HISTORY_FIELD_FORMAT ", " HISTORY_FIELD_TIMESTAMP ", "
+                HISTORY_FIELD_SCAN_COUNT " FROM " HISTORY_TABLE
+                " ORDER BY " HISTORY_FIELD_ID)) {
+                while (ok && rows.next()) {
+                    const QDateTime time(QDateTime::fromString(rows.value(2).
+                        toString(), Qt::ISODate));
+                    if (time.isValid()) {
+                        ok = ScanStats::addScan(db, rows.value(0).toString(),
+                            rows.value(1).toString(), time,
+                            qMax(rows.value(3).toInt(), 1));
+                    }
+                }
+            } else {
+                HWARN(rows.lastError());
+            }
+        }
+        if (ok) {
+            HVERIFY(db.commit());
+        } else {
+            HWARN(db.lastError());
+            HVERIFY(db.rollback());
+        }
+    }
 }
 
 QSqlDatabase Database::database()
@@ -280,3 +454,8 @@ QDir Database::imageDir()
 {
     return Private::gImageDir;
 }
+
+bool Database::upsertSupported()
+{
+    return Private::gUpsertSupported;
+}
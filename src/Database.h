@@ -38,6 +38,7 @@ public:
     static void initialize(QQmlEngine* aEngine, Settings* aSettings);
     static QSqlDatabase database();
     static QDir imageDir();
+    static bool upsertSupported();
 };
 
 #endif // BARCODE_DATABASE_H
@@ -24,13 +24,17 @@ THE SOFTWARE.
 
 #include "HistoryModel.h"
 #include "HistoryImageProvider.h"
+#include "BarcodeUtils.h"
 #include "Database.h"
+#include "ScanStats.h"
+#include "ThreadPriority.h"
 
 #include "HarbourDebug.h"
 #include "HarbourTask.h"
 
 #include <QDirIterator>
 #include <QThreadPool>
+#include <QTimer>
 #include <QFileInfo>
 #include <QImage>
 #include <QSqlQuery>
@@ -40,6 +44,20 @@ THE SOFTWARE.
 
 #define DEFAULT_MAX_COUNT (100)
 
+// Exists while repeated scans are merged into one row (see setDedupe)
+#define HISTORY_DEDUPE_INDEX \
+    HISTORY_TABLE "_" HISTORY_FIELD_VALUE "_" HISTORY_FIELD_FORMAT
+
+// Stale files are cleaned up once the app is done starting up
+#define CLEANUP_DELAY_MS (5000)
+
+// Rows stored by older versions get classified after the cleanup
+#define CLASSIFY_DELAY_MS (CLEANUP_DELAY_MS + 1000)
+
+// Nice value of the thread doing file I/O. Nothing here is urgent,
+// it shouldn't steal CPU time from the scanner and the UI.
+#define STORAGE_PRIORITY (10)
+
 // ==========================================================================
 // HistoryModel::CleanupTask
 // Removes image files not associated with any rows in the database
@@ -53,6 +71,7 @@ public:
 
 public:
     QStringList iList;
+    QVariantList iImageIds;
     bool iHaveImages;
 };
 
@@ -63,6 +82,7 @@ HistoryModel::CleanupTask::CleanupTask(QThreadPool* aPool, QStringList aList) :
 
 void HistoryModel::CleanupTask::performTask()
 {
+    ThreadPriority::setNice(STORAGE_PRIORITY);
     QDirIterator it(Database::imageDir().path(), QDir::Files);
     while (it.hasNext()) {
         it.next();
@@ -73,6 +93,7 @@ void HistoryModel::CleanupTask::performTask()
             const int pos = iList.indexOf(base);
             if (pos >= 0) {
                 iList.removeAt(pos);
+                iImageIds.append(base.toInt());
                 iHaveImages = true;
             } else {
                 const QString path(it.filePath());
@@ -86,6 +107,43 @@ void HistoryModel::CleanupTask::performTask()
     HDEBUG("done");
 }
 
+// ==========================================================================
+// HistoryModel::ClassifyTask
+// Determines content type of the rows stored without one
+// ==========================================================================
+
+class HistoryModel::ClassifyTask : public HarbourTask {
+    Q_OBJECT
+public:
+    ClassifyTask(QThreadPool* aPool, QVariantList aIds, QStringList aValues,
+        QStringList aFormats);
+    void performTask() Q_DECL_OVERRIDE;
+
+public:
+    QVariantList iIds;
+    QStringList iValues;
+    QStringList iFormats;
+    QVariantList iTypes;
+};
+
+HistoryModel::ClassifyTask::ClassifyTask(QThreadPool* aPool, QVariantList aIds,
+    QStringList aValues, QStringList aFormats) :
+    HarbourTask(aPool), iIds(aIds), iValues(aValues), iFormats(aFormats)
+{
+}
+
+void HistoryModel::ClassifyTask::performTask()
+{
+    ThreadPriority::setNice(STORAGE_PRIORITY);
+    const int n = iIds.count();
+    iTypes.reserve(n);
+    for (int i = 0; i < n; i++) {
+        iTypes.append(BarcodeUtils::contentType(iValues.at(i),
+            iFormats.at(i)));
+    }
+    HDEBUG("classified" << n << "row(s)");
+}
+
 // ==========================================================================
 // HistoryModel::SaveTask
 // ==========================================================================
@@ -100,23 +158,28 @@ public:
     QImage iImage;
     QString iId;
     QString iName;
+    bool iSaved;
 };
 
 HistoryModel::SaveTask::SaveTask(QThreadPool* aPool, QImage aImage, QString aId) :
     HarbourTask(aPool), iImage(aImage), iId(aId),
-    iName(aId + HistoryImageProvider::IMAGE_EXT)
+    iName(aId + HistoryImageProvider::IMAGE_EXT),
+    iSaved(false)
 {
 }
 
 void HistoryModel::SaveTask::performTask()
 {
+    ThreadPriority::setNice(STORAGE_PRIORITY);
     QDir dir(Database::imageDir());
     if (!dir.exists()) {
         dir.mkpath(".");
     }
     const QString path(dir.path() + QDir::separator() + iName);
     HDEBUG(qPrintable(path));
-    if (!iImage.save(path)) {
+    if (iImage.save(path)) {
+        iSaved = true;
+    } else {
         HWARN("Fails to save" << qPrintable(path));
     }
     HDEBUG("done");
@@ -133,6 +196,7 @@ public:
 
 void HistoryModel::PurgeTask::run()
 {
+    ThreadPriority::setNice(STORAGE_PRIORITY);
     QDirIterator it(Database::imageDir().path(), QDir::Files);
     while (it.hasNext()) {
         it.next();
@@ -164,8 +228,13 @@ public:
     enum {
         FIELD_ID,
         FIELD_VALUE,
-        FIELD_TIMESTAMP, // DB_SORT_COLUMN (see below)
+        FIELD_TIMESTAMP,
         FIELD_FORMAT,
+        FIELD_TYPE,
+        FIELD_PREVIEW,
+        FIELD_SCAN_COUNT,
+        FIELD_LAST_SEEN, // DB_SORT_COLUMN (see below)
+        FIELD_IMAGE,
         NUM_FIELDS
     };
     // Order of first NUM_FIELDS roles must match the order of fields:
@@ -175,18 +244,33 @@ public:
         ValueRole,
         TimestampRole,
         FormatRole,
+        TypeRole,
+        PreviewRole,
+        ScanCountRole,
+        LastSeenRole,
+        ImageRole,
         HasImageRole,
         LastRole = HasImageRole
     };
-    static const int DB_SORT_COLUMN = FIELD_TIMESTAMP;
+    static const int DB_SORT_COLUMN = FIELD_LAST_SEEN;
     static const QString DB_TABLE;
     static const QString DB_FIELD[NUM_FIELDS];
     static const QString HAS_IMAGE;
+    static const QString QUERY_FORMATS;
+    static const QString QUERY_FROM;
+    static const QString QUERY_TO;
+    static const QString QUERY_TYPES;
+    static const QString QUERY_HAS_IMAGE;
 
 #define DB_FIELD_ID DB_FIELD[HistoryModel::Private::FIELD_ID]
 #define DB_FIELD_VALUE DB_FIELD[HistoryModel::Private::FIELD_VALUE]
 #define DB_FIELD_TIMESTAMP DB_FIELD[HistoryModel::Private::FIELD_TIMESTAMP]
 #define DB_FIELD_FORMAT DB_FIELD[HistoryModel::Private::FIELD_FORMAT]
+#define DB_FIELD_TYPE DB_FIELD[HistoryModel::Private::FIELD_TYPE]
+#define DB_FIELD_PREVIEW DB_FIELD[HistoryModel::Private::FIELD_PREVIEW]
+#define DB_FIELD_SCAN_COUNT DB_FIELD[HistoryModel::Private::FIELD_SCAN_COUNT]
+#define DB_FIELD_LAST_SEEN DB_FIELD[HistoryModel::Private::FIELD_LAST_SEEN]
+#define DB_FIELD_IMAGE DB_FIELD[HistoryModel::Private::FIELD_IMAGE]
 
     enum TriState { No, Maybe, Yes };
 
@@ -194,26 +278,64 @@ public:
     ~Private();
 
     HistoryModel* historyModel() const;
+    int storedCount() const;
     QVariant valueAt(int aRow, int aField) const;
+    QString fetchValue(int aRow) const;
+    static QString preview(QString aValue);
     bool imageFileExistsAt(int aRow) const;
     bool removeExtraRows(int aReserve = 0);
+    bool trimTable(int aMaxCount);
     void commitChanges();
-    void cleanupFiles();
-
+    bool dedupeIndexExists() const;
+    bool createDedupeIndex();
+    bool dropDedupeIndex();
+    QString upsert(QString aValue, QString aFormat, QString aTimestamp,
+        int* aScanCount);
+    QString appendRow(QString aValue, QString aFormat, QString aTimestamp);
+    void rowAppended();
+    bool updateRow(QString aId, int aScanCount, QString aLastSeen);
+    void updateImageFlags(QVariantList aImageIds);
+    bool selectUnclassified(QVariantList* aIds, QStringList* aValues,
+        QStringList* aFormats);
+    void storeTypes(QVariantList aIds, QVariantList aTypes);
+    void classifyNow();
+    static QString timeCondition(QVariant aTime, const char* aOperator);
+    static QString filterFor(QVariantMap aQuery);
+
+    bool select() Q_DECL_OVERRIDE;
+    QString selectStatement() const Q_DECL_OVERRIDE;
     QHash<int,QByteArray> roleNames() const Q_DECL_OVERRIDE;
     QVariant data(const QModelIndex& aIndex, int aRole) const Q_DECL_OVERRIDE;
+    bool canFetchMore(const QModelIndex& aParent) const Q_DECL_OVERRIDE;
+    void fetchMore(const QModelIndex& aParent) Q_DECL_OVERRIDE;
+
+public Q_SLOTS:
+    void cleanupFiles();
+    void classifyRows();
 
 private Q_SLOTS:
     void onSaveDone();
     void onCleanupDone();
+    void onClassifyDone();
 
 public:
     QThreadPool* iThreadPool;
     TriState iHaveImages;
     bool iSaveImages;
+    bool iDedupe;
+    bool iLoaded;
     int iMaxCount;
+    int iStoredCount;
     int iLastKnownCount;
     int iFieldIndex[NUM_FIELDS];
+    QString iSelectColumns;
+    QVariantMap iQuery;
+    // Rows updated by repeated scans since the last select(), by id
+    QHash<QString,int> iScanCount;
+    QHash<QString,QString> iLastSeen;
+    // Content types of the selected rows which were stored without one,
+    // by id (see classifyRows)
+    mutable QHash<QString,QVariant> iTypes;
 };
 
 const QString HistoryModel::Private::DB_TABLE(QLatin1String(HISTORY_TABLE));
@@ -221,16 +343,29 @@ const QString HistoryModel::Private::DB_FIELD[] = {
     QLatin1String(HISTORY_FIELD_ID),
     QLatin1String(HISTORY_FIELD_VALUE),
     QLatin1String(HISTORY_FIELD_TIMESTAMP),
-    QLatin1String(HISTORY_FIELD_FORMAT)
+    QLatin1String(HISTORY_FIELD_FORMAT),
+    QLatin1String(HISTORY_FIELD_TYPE),
+    QLatin1String(HISTORY_FIELD_PREVIEW),
+    QLatin1String(HISTORY_FIELD_SCAN_COUNT),
+    QLatin1String(HISTORY_FIELD_LAST_SEEN),
+    QLatin1String(HISTORY_FIELD_IMAGE)
 };
 const QString HistoryModel::Private::HAS_IMAGE("hasImage");
+const QString HistoryModel::Private::QUERY_FORMATS("formats");
+const QString HistoryModel::Private::QUERY_FROM("from");
+const QString HistoryModel::Private::QUERY_TO("to");
+const QString HistoryModel::Private::QUERY_TYPES("types");
+const QString HistoryModel::Private::QUERY_HAS_IMAGE("hasImage");
 
 HistoryModel::Private::Private(HistoryModel* aPublicModel) :
     QSqlTableModel(aPublicModel, Database::database()),
     iThreadPool(new QThreadPool(this)),
     iHaveImages(Maybe),
     iSaveImages(true),
+    iDedupe(false),
+    iLoaded(false),
     iMaxCount(DEFAULT_MAX_COUNT),
+    iStoredCount(0),
     iLastKnownCount(0)
 {
     iThreadPool->setMaxThreadCount(1);
@@ -238,13 +373,29 @@ HistoryModel::Private::Private(HistoryModel* aPublicModel) :
     QSqlDatabase db = database();
     if (db.open()) {
         HDEBUG("database opened");
+        // The rows are selected by HistoryModel::load() when (and if)
+        // they are actually needed. Until then, only count them.
         setTable(DB_TABLE);
-        select();
+        iStoredCount = storedCount();
+        // The database remembers whether duplicates are being merged
+        iDedupe = dedupeIndexExists();
         for (int i = 0; i < NUM_FIELDS; i++) {
             const QString name(DB_FIELD[i]);
             iFieldIndex[i] = fieldIndex(name);
             HDEBUG(iFieldIndex[i] << name);
         }
+        // Same columns in the same order (so that iFieldIndex remains
+        // valid) except that the values aren't selected. Those may be
+        // kilobytes long and are fetched on demand.
+        const QSqlRecord rec(record());
+        const int n = rec.count();
+        QStringList columns;
+        for (int i = 0; i < n; i++) {
+            const QString name(rec.fieldName(i));
+            columns.append((name == DB_FIELD_VALUE) ?
+                QString("NULL AS " + name) : name);
+        }
+        iSelectColumns = columns.join(", ");
     } else {
         HWARN(db.lastError());
     }
@@ -252,11 +403,8 @@ HistoryModel::Private::Private(HistoryModel* aPublicModel) :
     if (sortColumn >= 0) {
         HDEBUG("sort column" << sortColumn);
         setSort(sortColumn, Qt::DescendingOrder);
-        sort(sortColumn, Qt::DescendingOrder);
     }
     setEditStrategy(QSqlTableModel::OnManualSubmit);
-    // At startup we assume that images are being saved
-    cleanupFiles();
 }
 
 HistoryModel::Private::~Private()
@@ -273,6 +421,59 @@ HistoryModel* HistoryModel::Private::historyModel() const
     return qobject_cast<HistoryModel*>(QObject::parent());
 }
 
+int HistoryModel::Private::storedCount() const
+{
+    QSqlQuery query(database());
+    if (query.exec("SELECT COUNT(*) FROM " HISTORY_TABLE) && query.next()) {
+        return query.value(0).toInt();
+    } else {
+        HWARN(query.lastError());
+        return 0;
+    }
+}
+
+bool HistoryModel::Private::select()
+{
+    // The updated values are in the database now
+    iScanCount.clear();
+    iLastSeen.clear();
+    iTypes.clear();
+    return QSqlTableModel::select();
+}
+
+QString HistoryModel::Private::selectStatement() const
+{
+    if (iSelectColumns.isEmpty()) {
+        return QSqlTableModel::selectStatement();
+    } else {
+        QString sql("SELECT " + iSelectColumns + " FROM " HISTORY_TABLE);
+        const QString where(filter());
+        if (!where.isEmpty()) {
+            sql += " WHERE " + where;
+        }
+        const QString orderBy(orderByClause());
+        if (!orderBy.isEmpty()) {
+            sql += QChar(' ') + orderBy;
+        }
+        return sql;
+    }
+}
+
+bool HistoryModel::Private::canFetchMore(const QModelIndex& aParent) const
+{
+    return !iLoaded || QSqlTableModel::canFetchMore(aParent);
+}
+
+void HistoryModel::Private::fetchMore(const QModelIndex& aParent)
+{
+    if (iLoaded) {
+        QSqlTableModel::fetchMore(aParent);
+    } else {
+        // The view wants to see the rows
+        historyModel()->load();
+    }
+}
+
 QHash<int,QByteArray> HistoryModel::Private::roleNames() const
 {
     QHash<int,QByteArray> roles;
@@ -306,7 +507,31 @@ QVariant HistoryModel::Private::data(const QModelIndex& aIndex, int aRole) const
         if (i < NUM_FIELDS) {
             int column = iFieldIndex[i];
             if (column >= 0) {
-                return QSqlTableModel::data(index(row, column));
+                if (i == FIELD_VALUE) {
+                    return fetchValue(row);
+                }
+                if ((i == FIELD_SCAN_COUNT || i == FIELD_LAST_SEEN) &&
+                    !iScanCount.isEmpty()) {
+                    const QString id(valueAt(row, FIELD_ID).toString());
+                    if (iScanCount.contains(id)) {
+                        return (i == FIELD_SCAN_COUNT) ?
+                            QVariant(iScanCount.value(id)) :
+                            QVariant(iLastSeen.value(id));
+                    }
+                }
+                QVariant value(QSqlTableModel::data(index(row, column)));
+                if (i == FIELD_TYPE && value.isNull()) {
+                    // Not classified when selected (see classifyRows).
+                    // Classify it once, the value has to be fetched.
+                    const QString id(valueAt(row, FIELD_ID).toString());
+                    value = iTypes.value(id);
+                    if (value.isNull()) {
+                        value = BarcodeUtils::contentType(fetchValue(row),
+                            valueAt(row, FIELD_FORMAT).toString());
+                        iTypes.insert(id, value);
+                    }
+                }
+                return value;
             }
         } else if (aRole == HasImageRole) {
             return QVariant::fromValue(iSaveImages && imageFileExistsAt(row));
@@ -328,11 +553,50 @@ QVariant HistoryModel::Private::valueAt(int aRow, int aField) const
     return QVariant();
 }
 
+QString HistoryModel::Private::fetchValue(int aRow) const
+{
+    // The value is only cached for the rows inserted since the last
+    // select(), the rest have to be read from the database
+    const QVariant cached(valueAt(aRow, FIELD_VALUE));
+    if (!cached.isNull()) {
+        return cached.toString();
+    }
+    const QVariant id(valueAt(aRow, FIELD_ID));
+    if (!id.isNull()) {
+        QSqlQuery query(database());
+        query.prepare("SELECT " HISTORY_FIELD_VALUE " FROM " HISTORY_TABLE
+            " WHERE " HISTORY_FIELD_ID " = ?");
+        query.addBindValue(id);
+        if (query.exec() && query.next()) {
+            return query.value(0).toString();
+        } else {
+            HWARN(id.toString() << query.lastError());
+        }
+    }
+    return QString();
+}
+
+QString HistoryModel::Private::preview(QString aValue)
+{
+    if (aValue.length() > HISTORY_PREVIEW_LENGTH) {
+        int n = HISTORY_PREVIEW_LENGTH;
+        // Don't cut a surrogate pair in half
+        if (aValue.at(n - 1).isHighSurrogate()) n--;
+        return aValue.left(n);
+    } else {
+        return aValue;
+    }
+}
+
 bool HistoryModel::Private::removeExtraRows(int aReserve)
 {
     if (iMaxCount > 0) {
-        HistoryModel* filter = historyModel();
         const int max = qMax(iMaxCount - aReserve, 0);
+        if (!filter().isEmpty()) {
+            // The rows which don't match the query aren't there
+            return trimTable(max);
+        }
+        HistoryModel* filter = historyModel();
         const int n = filter->rowCount();
         if (n > max) {
             for (int i = n; i > max; i--) {
@@ -347,6 +611,36 @@ bool HistoryModel::Private::removeExtraRows(int aReserve)
     return false;
 }
 
+// Removes the oldest rows from the whole table, whatever is selected
+bool HistoryModel::Private::trimTable(int aMaxCount)
+{
+    QSqlQuery query(database());
+    if (!query.exec("SELECT COUNT(*) FROM " HISTORY_TABLE) || !query.next()) {
+        HWARN(query.lastError());
+        return false;
+    }
+    const int n = query.value(0).toInt();
+    if (n > aMaxCount) {
+        // Pending changes would be lost by select()
+        commitChanges();
+        query.prepare("DELETE FROM " HISTORY_TABLE " WHERE " HISTORY_FIELD_ID
+            " NOT IN (SELECT " HISTORY_FIELD_ID " FROM " HISTORY_TABLE
+            " ORDER BY " HISTORY_FIELD_LAST_SEEN " DESC, " HISTORY_FIELD_ID
+            " DESC LIMIT ?)");
+        query.addBindValue(aMaxCount);
+        if (query.exec()) {
+            HDEBUG("Removed" << query.numRowsAffected() << "row(s) of" << n);
+            if (iLoaded) {
+                select();
+            }
+            return true;
+        } else {
+            HWARN(query.lastError());
+        }
+    }
+    return false;
+}
+
 void HistoryModel::Private::commitChanges()
 {
     if (isDirty()) {
@@ -362,6 +656,328 @@ void HistoryModel::Private::commitChanges()
     }
 }
 
+bool HistoryModel::Private::dedupeIndexExists() const
+{
+    QSqlQuery query(database());
+    query.prepare("SELECT COUNT(*) FROM sqlite_master "
+        "WHERE type = 'index' AND name = ?");
+    query.addBindValue(QLatin1String(HISTORY_DEDUPE_INDEX));
+    if (query.exec() && query.next()) {
+        return query.value(0).toInt() > 0;
+    } else {
+        HWARN(query.lastError());
+        return false;
+    }
+}
+
+bool HistoryModel::Private::createDedupeIndex()
+{
+    // The unique index can't be created while there are duplicates.
+    // Those get merged into the most recent row (which also has the
+    // most recent image) and the rest of them are deleted. The merged
+    // row remembers when the code was first scanned.
+    static const char* stmts[] = {
+        "UPDATE " HISTORY_TABLE " SET "
+            HISTORY_FIELD_SCAN_COUNT " = (SELECT SUM(d." HISTORY_FIELD_SCAN_COUNT
+                ") FROM " HISTORY_TABLE " AS d WHERE d." HISTORY_FIELD_VALUE
+                " IS " HISTORY_TABLE "." HISTORY_FIELD_VALUE " AND d."
+                HISTORY_FIELD_FORMAT " IS " HISTORY_TABLE "." HISTORY_FIELD_FORMAT "), "
+            HISTORY_FIELD_TIMESTAMP " = (SELECT MIN(d." HISTORY_FIELD_TIMESTAMP
+                ") FROM " HISTORY_TABLE " AS d WHERE d." HISTORY_FIELD_VALUE
+                " IS " HISTORY_TABLE "." HISTORY_FIELD_VALUE " AND d."
+                HISTORY_FIELD_FORMAT " IS " HISTORY_TABLE "." HISTORY_FIELD_FORMAT "), "
+            HISTORY_FIELD_LAST_SEEN " = (SELECT MAX(d." HISTORY_FIELD_LAST_SEEN
+                ") FROM " HISTORY_TABLE " AS d WHERE d." HISTORY_FIELD_VALUE
+                " IS " HISTORY_TABLE "." HISTORY_FIELD_VALUE " AND d."
+                HISTORY_FIELD_FORMAT " IS " HISTORY_TABLE "." HISTORY_FIELD_FORMAT ") "
+            "WHERE " HISTORY_FIELD_ID " IN (SELECT MAX(" HISTORY_FIELD_ID ") FROM "
+                HISTORY_TABLE " GROUP BY " HISTORY_FIELD_VALUE ", "
+                HISTORY_FIELD_FORMAT " HAVING COUNT(*) > 1)",
+        "DELETE FROM " HISTORY_TABLE " WHERE " HISTORY_FIELD_ID " NOT IN "
+            "(SELECT MAX(" HISTORY_FIELD_ID ") FROM " HISTORY_TABLE
+            " GROUP BY " HISTORY_FIELD_VALUE ", " HISTORY_FIELD_FORMAT ")",
+        "CREATE UNIQUE INDEX IF NOT EXISTS " HISTORY_DEDUPE_INDEX " ON "
+            HISTORY_TABLE " (" HISTORY_FIELD_VALUE ", " HISTORY_FIELD_FORMAT ")",
+        NULL
+    };
+    QSqlDatabase db = database();
+    HVERIFY(db.transaction());
+    bool ok = true;
+    for (int i = 0; ok && stmts[i]; i++) {
+        ok = QSqlQuery(db).exec(QLatin1String(stmts[i]));
+    }
+    if (ok) {
+        HVERIFY(db.commit());
+    } else {
+        HWARN(db.lastError());
+        HVERIFY(db.rollback());
+    }
+    return ok;
+}
+
+bool HistoryModel::Private::dropDedupeIndex()
+{
+    QSqlQuery query(database());
+    if (query.exec("DROP INDEX IF EXISTS " HISTORY_DEDUPE_INDEX)) {
+        return true;
+    } else {
+        HWARN(query.lastError());
+        return false;
+    }
+}
+
+// The image flag is set by onSaveDone() once the image has been saved
+static const char* insertSql = "INSERT INTO " HISTORY_TABLE " ("
+    HISTORY_FIELD_VALUE ", " HISTORY_FIELD_TIMESTAMP ", "
+    HISTORY_FIELD_FORMAT ", " HISTORY_FIELD_TYPE ", "
+    HISTORY_FIELD_PREVIEW ", " HISTORY_FIELD_SCAN_COUNT ", "
+    HISTORY_FIELD_LAST_SEEN ", " HISTORY_FIELD_IMAGE ") "
+    "VALUES (?, ?, ?, ?, ?, 1, ?, 0)";
+
+// Returns the id of the row and how many times it's been scanned,
+// including this time (one for a new row)
+QString HistoryModel::Private::upsert(QString aValue, QString aFormat,
+    QString aTimestamp, int* aScanCount)
+{
+    // Repeated scans only bump the counter and the last seen time
+    QSqlDatabase db = database();
+    QSqlQuery query(db);
+    bool ok;
+    HVERIFY(db.transaction());
+    if (Database::upsertSupported()) {
+        query.prepare(QString(insertSql) + " "
+            "ON CONFLICT (" HISTORY_FIELD_VALUE ", " HISTORY_FIELD_FORMAT ") "
+            "DO UPDATE SET " HISTORY_FIELD_SCAN_COUNT " = "
+            HISTORY_FIELD_SCAN_COUNT " + 1, " HISTORY_FIELD_LAST_SEEN
+            " = excluded." HISTORY_FIELD_LAST_SEEN);
+        query.addBindValue(aValue);
+        query.addBindValue(aTimestamp);
+        query.addBindValue(aFormat);
+        query.addBindValue(BarcodeUtils::contentType(aValue, aFormat));
+        query.addBindValue(preview(aValue));
+        query.addBindValue(aTimestamp);
+        ok = query.exec();
+    } else {
+        // Older SQLite, update the existing row or insert a new one
+        query.prepare("UPDATE " HISTORY_TABLE " SET "
+            HISTORY_FIELD_SCAN_COUNT " = " HISTORY_FIELD_SCAN_COUNT " + 1, "
+            HISTORY_FIELD_LAST_SEEN " = ? WHERE " HISTORY_FIELD_VALUE
+            " = ? AND " HISTORY_FIELD_FORMAT " = ?");
+        query.addBindValue(aTimestamp);
+        query.addBindValue(aValue);
+        query.addBindValue(aFormat);
+        ok = query.exec();
+        if (ok && query.numRowsAffected() < 1) {
+            query.prepare(insertSql);
+            query.addBindValue(aValue);
+            query.addBindValue(aTimestamp);
+            query.addBindValue(aFormat);
+            query.addBindValue(BarcodeUtils::contentType(aValue, aFormat));
+            query.addBindValue(preview(aValue));
+            query.addBindValue(aTimestamp);
+            ok = query.exec();
+        }
+    }
+    if (ok) {
+        query.prepare("SELECT " HISTORY_FIELD_ID ", " HISTORY_FIELD_SCAN_COUNT
+            " FROM " HISTORY_TABLE " WHERE " HISTORY_FIELD_VALUE " = ? AND "
+            HISTORY_FIELD_FORMAT " = ?");
+        query.addBindValue(aValue);
+        query.addBindValue(aFormat);
+        ok = query.exec() && query.next();
+    }
+    if (ok) {
+        const int scanCount = query.value(1).toInt();
+        const QString id(query.value(0).toString());
+        HDEBUG("scanned" << scanCount << "time(s)");
+        HVERIFY(db.commit());
+        *aScanCount = scanCount;
+        return id;
+    } else {
+        HWARN(query.lastError());
+        HVERIFY(db.rollback());
+        return QString();
+    }
+}
+
+// Inserts a new row straight into the table, bypassing the model.
+// Only used while the rows haven't been selected. Returns the row id.
+QString HistoryModel::Private::appendRow(QString aValue, QString aFormat,
+    QString aTimestamp)
+{
+    QSqlQuery query(database());
+    query.prepare(insertSql);
+    query.addBindValue(aValue);
+    query.addBindValue(aTimestamp);
+    query.addBindValue(aFormat);
+    query.addBindValue(BarcodeUtils::contentType(aValue, aFormat));
+    query.addBindValue(preview(aValue));
+    query.addBindValue(aTimestamp);
+    if (query.exec()) {
+        return query.lastInsertId().toString();
+    } else {
+        HWARN(query.lastError());
+        return QString();
+    }
+}
+
+// Accounts for a row added by appendRow() or upsert() while the rows
+// haven't been selected, removing the oldest one(s) if there are too many
+void HistoryModel::Private::rowAppended()
+{
+    iStoredCount++;
+    if (iMaxCount > 0 && iStoredCount > iMaxCount && trimTable(iMaxCount)) {
+        iStoredCount = storedCount();
+        if (iSaveImages) {
+            cleanupFiles();
+        }
+    }
+}
+
+// Updates the cached row after a repeated scan, without selecting
+// the rows again. The proxy moves it to the top, it has been seen last.
+// Returns false if the row hasn't been fetched or didn't match the query.
+bool HistoryModel::Private::updateRow(QString aId, int aScanCount,
+    QString aLastSeen)
+{
+    if (!iLoaded || iQuery.contains(QUERY_FROM) || iQuery.contains(QUERY_TO)) {
+        // The new last seen time may not match the query anymore
+        return false;
+    }
+    const int n = rowCount();
+    for (int row = 0; row < n; row++) {
+        if (valueAt(row, FIELD_ID).toString() == aId) {
+            iScanCount.insert(aId, aScanCount);
+            iLastSeen.insert(aId, aLastSeen);
+            QVector<int> roles;
+            roles.append(ScanCountRole);
+            roles.append(LastSeenRole);
+            roles.append(ImageRole);
+            roles.append(HasImageRole);
+            const QModelIndex modelIndex(index(row, 0));
+            Q_EMIT dataChanged(modelIndex, modelIndex, roles);
+            return true;
+        }
+    }
+    return false;
+}
+
+void HistoryModel::Private::updateImageFlags(QVariantList aImageIds)
+{
+    // Rows stored by older versions don't know whether they have
+    // an image. Now that we have looked at the files, we do.
+    QSqlDatabase db = database();
+    QSqlQuery query(db);
+    if (query.exec("SELECT 1 FROM " HISTORY_TABLE " WHERE "
+        HISTORY_FIELD_IMAGE " IS NULL LIMIT 1") && query.next()) {
+        HDEBUG(aImageIds.count() << "image(s) found");
+        HVERIFY(db.transaction());
+        bool ok = true;
+        if (!aImageIds.isEmpty()) {
+            query.prepare("UPDATE " HISTORY_TABLE " SET " HISTORY_FIELD_IMAGE
+                " = 1 WHERE " HISTORY_FIELD_ID " = ? AND "
+                HISTORY_FIELD_IMAGE " IS NULL");
+            query.addBindValue(aImageIds);
+            ok = query.execBatch();
+        }
+        if (ok) {
+            ok = query.exec("UPDATE " HISTORY_TABLE " SET "
+                HISTORY_FIELD_IMAGE " = 0 WHERE " HISTORY_FIELD_IMAGE
+                " IS NULL");
+        }
+        if (ok) {
+            HVERIFY(db.commit());
+        } else {
+            HWARN(query.lastError());
+            HVERIFY(db.rollback());
+        }
+    }
+}
+
+// The stored timestamps are local time without the offset, which
+// compares correctly as a string. Anything that QML can pass as a
+// date (or an ISO 8601 string) is accepted.
+QString HistoryModel::Private::timeCondition(QVariant aTime,
+    const char* aOperator)
+{
+    QDateTime time;
+    if (aTime.type() == QVariant::Date) {
+        time = QDateTime(aTime.toDate());
+    } else if (aTime.type() == QVariant::DateTime) {
+        time = aTime.toDateTime();
+    } else {
+        const QString str(aTime.toString());
+        time = QDateTime::fromString(str, Qt::ISODate);
+        if (!time.isValid()) {
+            time = QDateTime(QDate::fromString(str, Qt::ISODate));
+        }
+    }
+    if (time.isValid()) {
+        return QString(HISTORY_FIELD_LAST_SEEN " %1 '%2'").
+            arg(QLatin1String(aOperator)).
+            arg(time.toLocalTime().toString(Qt::ISODate));
+    } else {
+        HWARN("Invalid time" << aTime);
+        return QString();
+    }
+}
+
+// Compiles the query into the WHERE clause. Only the values that can't
+// break the SQL get there, so there's nothing to escape.
+QString HistoryModel::Private::filterFor(QVariantMap aQuery)
+{
+    QStringList conditions;
+    if (aQuery.contains(QUERY_FORMATS)) {
+        static const QRegExp formatName("[A-Z0-9_]+");
+        const QStringList formats(aQuery.value(QUERY_FORMATS).toStringList());
+        QStringList quoted;
+        for (int i = 0; i < formats.count(); i++) {
+            const QString format(formats.at(i));
+            if (formatName.exactMatch(format)) {
+                quoted.append(QChar('\'') + format + QChar('\''));
+            } else {
+                HWARN("Invalid format" << format);
+            }
+        }
+        // An empty list matches nothing
+        conditions.append(quoted.isEmpty() ? QString("0") :
+            QString(HISTORY_FIELD_FORMAT " IN (%1)").arg(quoted.join(",")));
+    }
+    if (aQuery.contains(QUERY_TYPES)) {
+        const QVariantList types(aQuery.value(QUERY_TYPES).toList());
+        QStringList numbers;
+        for (int i = 0; i < types.count(); i++) {
+            bool ok;
+            const int type = types.at(i).toInt(&ok);
+            if (ok) {
+                numbers.append(QString::number(type));
+            }
+        }
+        conditions.append(numbers.isEmpty() ? QString("0") :
+            QString(HISTORY_FIELD_TYPE " IN (%1)").arg(numbers.join(",")));
+    }
+    if (aQuery.contains(QUERY_FROM)) {
+        // Inclusive
+        const QString from(timeCondition(aQuery.value(QUERY_FROM), ">="));
+        if (!from.isEmpty()) {
+            conditions.append(from);
+        }
+    }
+    if (aQuery.contains(QUERY_TO)) {
+        // Exclusive, so that [today, tomorrow) selects today's scans
+        const QString to(timeCondition(aQuery.value(QUERY_TO), "<"));
+        if (!to.isEmpty()) {
+            conditions.append(to);
+        }
+    }
+    if (aQuery.contains(QUERY_HAS_IMAGE)) {
+        conditions.append(aQuery.value(QUERY_HAS_IMAGE).toBool() ?
+            QString(HISTORY_FIELD_IMAGE " = 1") :
+            QString(HISTORY_FIELD_IMAGE " IS NOT 1"));
+    }
+    return conditions.join(" AND ");
+}
+
 void HistoryModel::Private::cleanupFiles()
 {
     QSqlQuery query(database());
@@ -380,6 +996,74 @@ void HistoryModel::Private::cleanupFiles()
     }
 }
 
+bool HistoryModel::Private::selectUnclassified(QVariantList* aIds,
+    QStringList* aValues, QStringList* aFormats)
+{
+    QSqlQuery query(database());
+    query.prepare("SELECT " HISTORY_FIELD_ID ", " HISTORY_FIELD_VALUE ", "
+        HISTORY_FIELD_FORMAT " FROM " HISTORY_TABLE " WHERE "
+        HISTORY_FIELD_TYPE " IS NULL");
+    if (query.exec()) {
+        while (query.next()) {
+            aIds->append(query.value(0));
+            aValues->append(query.value(1).toString());
+            aFormats->append(query.value(2).toString());
+        }
+        return !aIds->isEmpty();
+    } else {
+        HWARN(query.lastError());
+        return false;
+    }
+}
+
+void HistoryModel::Private::storeTypes(QVariantList aIds, QVariantList aTypes)
+{
+    QSqlDatabase db = database();
+    QSqlQuery query(db);
+    query.prepare("UPDATE " HISTORY_TABLE " SET " HISTORY_FIELD_TYPE
+        " = ? WHERE " HISTORY_FIELD_ID " = ?");
+    query.addBindValue(aTypes);
+    query.addBindValue(aIds);
+    HVERIFY(db.transaction());
+    if (query.execBatch()) {
+        HDEBUG("updated" << aIds.count() << "row(s)");
+        HVERIFY(db.commit());
+    } else {
+        HWARN(query.lastError());
+        HVERIFY(db.rollback());
+    }
+}
+
+void HistoryModel::Private::classifyRows()
+{
+    QVariantList ids;
+    QStringList values, formats;
+    if (selectUnclassified(&ids, &values, &formats)) {
+        HDEBUG(ids.count() << "row(s) to classify");
+        (new ClassifyTask(iThreadPool, ids, values, formats))->
+            submit(this, SLOT(onClassifyDone()));
+    }
+}
+
+// Filtering by type can't wait for ClassifyTask, the rows which
+// haven't been classified yet would be missing from the results
+void HistoryModel::Private::classifyNow()
+{
+    QVariantList ids;
+    QStringList values, formats;
+    if (selectUnclassified(&ids, &values, &formats)) {
+        const int n = ids.count();
+        QVariantList types;
+        types.reserve(n);
+        for (int i = 0; i < n; i++) {
+            types.append(BarcodeUtils::contentType(values.at(i),
+                formats.at(i)));
+        }
+        HDEBUG("classified" << n << "row(s)");
+        storeTypes(ids, types);
+    }
+}
+
 void HistoryModel::Private::onSaveDone()
 {
     SaveTask* task = qobject_cast<SaveTask*>(sender());
@@ -388,6 +1072,20 @@ void HistoryModel::Private::onSaveDone()
         if (HistoryImageProvider::instance()) {
             HistoryImageProvider::instance()->dropFromCache(task->iId);
         }
+        // The row is only known to have an image once it's been saved.
+        // If saving has been turned off in the meantime, it's gone.
+        if (task->iSaved && iSaveImages) {
+            QSqlQuery query(database());
+            query.prepare("UPDATE " HISTORY_TABLE " SET " HISTORY_FIELD_IMAGE
+                " = 1 WHERE " HISTORY_FIELD_ID " = ?");
+            query.addBindValue(task->iId);
+            if (!query.exec()) {
+                HWARN(query.lastError());
+            } else if (iLoaded && iQuery.contains(QUERY_HAS_IMAGE)) {
+                commitChanges();
+                select();
+            }
+        }
         task->release();
     }
 }
@@ -406,6 +1104,23 @@ void HistoryModel::Private::onCleanupDone()
                 iHaveImages = No;
             }
         }
+        updateImageFlags(task->iImageIds);
+        task->release();
+    }
+}
+
+void HistoryModel::Private::onClassifyDone()
+{
+    ClassifyTask* task = qobject_cast<ClassifyTask*>(sender());
+    HASSERT(task);
+    if (task) {
+        // Rows already loaded into the model keep NULL in their cached
+        // records, data() picks up their types from iTypes
+        storeTypes(task->iIds, task->iTypes);
+        const int n = task->iIds.count();
+        for (int i = 0; i < n; i++) {
+            iTypes.insert(task->iIds.at(i).toString(), task->iTypes.at(i));
+        }
         task->release();
     }
 }
@@ -419,15 +1134,45 @@ HistoryModel::HistoryModel(QObject* aParent) :
     iPrivate(new Private(this))
 {
     setSourceModel(iPrivate);
+    // Same order as selected, but a row updated in place by a repeated
+    // scan moves to the top without selecting everything again
+    setSortRole(Private::LastSeenRole);
+    sort(0, Qt::DescendingOrder);
     setDynamicSortFilter(true);
-    if (iPrivate->removeExtraRows()) {
-        invalidateFilter();
-        commitChanges();
-    }
-    iPrivate->iLastKnownCount = rowCount();
+    iPrivate->iLastKnownCount = count();
     connect(this, SIGNAL(rowsInserted(QModelIndex,int,int)), SLOT(checkCount()));
     connect(this, SIGNAL(rowsRemoved(QModelIndex,int,int)), SLOT(checkCount()));
     connect(this, SIGNAL(modelReset()), SLOT(checkCount()));
+    // At startup we assume that images are being saved. The cleanup
+    // is not urgent, let the camera and the scanner start first.
+    QTimer::singleShot(CLEANUP_DELAY_MS, iPrivate, SLOT(cleanupFiles()));
+    QTimer::singleShot(CLASSIFY_DELAY_MS, iPrivate, SLOT(classifyRows()));
+}
+
+void HistoryModel::load()
+{
+    if (!iPrivate->iLoaded) {
+        HDEBUG("loading history");
+        iPrivate->iLoaded = true;
+        iPrivate->select();
+        if (iPrivate->removeExtraRows()) {
+            invalidateFilter();
+            commitChanges();
+        }
+        checkCount();
+    }
+}
+
+int HistoryModel::count() const
+{
+    if (iPrivate->iLoaded) {
+        return rowCount();
+    } else {
+        // Not loaded yet, report what's going to be there
+        const int max = iPrivate->iMaxCount;
+        const int stored = iPrivate->iStoredCount;
+        return (max > 0) ? qMin(stored, max) : stored;
+    }
 }
 
 // Callback for qmlRegisterSingletonType<HistoryModel>
@@ -443,10 +1188,10 @@ bool HistoryModel::filterAcceptsRow(int aRow, const QModelIndex& aParent) const
 
 void HistoryModel::checkCount()
 {
-    const int count = rowCount();
-    if (iPrivate->iLastKnownCount != count) {
-        HDEBUG(iPrivate->iLastKnownCount << "=>" << count);
-        iPrivate->iLastKnownCount = count;
+    const int n = count();
+    if (iPrivate->iLastKnownCount != n) {
+        HDEBUG(iPrivate->iLastKnownCount << "=>" << n);
+        iPrivate->iLastKnownCount = n;
         Q_EMIT countChanged();
     }
 }
@@ -461,10 +1206,15 @@ void HistoryModel::setMaxCount(int aValue)
     if (iPrivate->iMaxCount != aValue) {
         iPrivate->iMaxCount = aValue;
         HDEBUG(aValue);
-        if (iPrivate->removeExtraRows()) {
-            invalidateFilter();
-            commitChanges();
-            iPrivate->cleanupFiles();
+        if (iPrivate->iLoaded) {
+            if (iPrivate->removeExtraRows()) {
+                invalidateFilter();
+                commitChanges();
+                iPrivate->cleanupFiles();
+            }
+        } else {
+            // Extra rows will be removed by load()
+            checkCount();
         }
         Q_EMIT maxCountChanged();
     }
@@ -516,6 +1266,16 @@ void HistoryModel::setSaveImages(bool aValue)
 
             // Actually delete all files on a separate thread
             iPrivate->iThreadPool->start(new PurgeTask);
+            QSqlQuery query(iPrivate->database());
+            if (!query.exec("UPDATE " HISTORY_TABLE " SET "
+                HISTORY_FIELD_IMAGE " = 0")) {
+                HWARN(query.lastError());
+            }
+            if (iPrivate->iLoaded &&
+                iPrivate->iQuery.contains(Private::QUERY_HAS_IMAGE)) {
+                iPrivate->commitChanges();
+                iPrivate->select();
+            }
             // And assume that we don't have images anymore
             if (iPrivate->iHaveImages != Private::No) {
                 iPrivate->iHaveImages = Private::No;
@@ -528,8 +1288,80 @@ void HistoryModel::setSaveImages(bool aValue)
     }
 }
 
+bool HistoryModel::dedupe() const
+{
+    return iPrivate->iDedupe;
+}
+
+void HistoryModel::setDedupe(bool aValue)
+{
+    if (iPrivate->iDedupe != aValue) {
+        HDEBUG(aValue);
+        iPrivate->commitChanges();
+        if (aValue) {
+            if (iPrivate->createDedupeIndex()) {
+                iPrivate->iDedupe = true;
+                // Duplicates are gone, and so are their images
+                iPrivate->iStoredCount = iPrivate->storedCount();
+                if (iPrivate->iLoaded) {
+                    iPrivate->select();
+                } else {
+                    checkCount();
+                }
+                if (iPrivate->iSaveImages) {
+                    iPrivate->cleanupFiles();
+                }
+                Q_EMIT dedupeChanged();
+            }
+        } else if (iPrivate->dropDedupeIndex()) {
+            iPrivate->iDedupe = false;
+            Q_EMIT dedupeChanged();
+        }
+    }
+}
+
+QVariantMap HistoryModel::query() const
+{
+    return iPrivate->iQuery;
+}
+
+// The query is a map with any combination of these:
+//
+//   formats:  list of format names, e.g. [ "EAN_13", "UPC_A" ]
+//   types:    list of BarcodeUtils.ContentType values
+//   from:     date or time of the earliest scan (inclusive)
+//   to:       date or time of the latest scan (exclusive)
+//   hasImage: true or false
+//
+// An empty map selects the whole history. The matching rows are read
+// from a single cursor in batches as the view scrolls (see fetchMore),
+// there's no separate paging. Changing the query resets the model.
+void HistoryModel::setQuery(QVariantMap aQuery)
+{
+    if (iPrivate->iQuery != aQuery) {
+        iPrivate->iQuery = aQuery;
+        const QString where(Private::filterFor(aQuery));
+        HDEBUG(aQuery << where);
+        if (iPrivate->filter() != where) {
+            if (aQuery.contains(Private::QUERY_TYPES)) {
+                iPrivate->classifyNow();
+            }
+            // Pending changes would be lost by select()
+            iPrivate->commitChanges();
+            // setFilter() re-selects the rows if they have been selected
+            const bool selected = iPrivate->QSqlTableModel::query().isActive();
+            iPrivate->setFilter(where);
+            if (iPrivate->iLoaded && !selected) {
+                iPrivate->select();
+            }
+        }
+        Q_EMIT queryChanged();
+    }
+}
+
 QVariantMap HistoryModel::get(int aRow)
 {
+    load();
     QString id;
     QVariantMap map;
     QModelIndex modelIndex = index(aRow, 0);
@@ -549,45 +1381,87 @@ QVariantMap HistoryModel::get(int aRow)
 
 QString HistoryModel::getValue(int aRow)
 {
-    return data(index(aRow, Private::FIELD_VALUE)).toString();
+    load();
+    return data(index(aRow, 0), Private::ValueRole).toString();
 }
 
 QString HistoryModel::insert(QImage aImage, QString aText, QString aFormat)
 {
     QString id;
-    QString timestamp(QDateTime::currentDateTime().toString(Qt::ISODate));
+    const QDateTime now(QDateTime::currentDateTime());
+    QString timestamp(now.toString(Qt::ISODate));
     HDEBUG(aText << aFormat << timestamp << aImage);
-    QSqlRecord record(iPrivate->database().record(Private::DB_TABLE));
-    record.setValue(Private::DB_FIELD_VALUE, aText);
-    record.setValue(Private::DB_FIELD_TIMESTAMP, timestamp);
-    record.setValue(Private::DB_FIELD_FORMAT, aFormat);
-    if (iPrivate->removeExtraRows(1)) {
-        invalidateFilter();
-        commitChanges();
-    }
-    const int row = 0;
-    if (iPrivate->insertRecord(row, record)) {
-        invalidateFilter();
-        // Just commit the changes, no need for cleanup:
+    // Statistics count every scan, whatever happens to the history
+    ScanStats::scanned(aText, aFormat, now);
+    if (!iPrivate->iLoaded) {
+        // Nothing has been selected yet, write straight to the table
+        // and leave the rows for load() to pick up
+        int scanCount = 1;
+        id = iPrivate->iDedupe ?
+            iPrivate->upsert(aText, aFormat, timestamp, &scanCount) :
+            iPrivate->appendRow(aText, aFormat, timestamp);
+        if (!id.isEmpty() && scanCount == 1) {
+            iPrivate->rowAppended();
+            checkCount();
+        }
+    } else if (iPrivate->iDedupe) {
+        int scanCount = 0;
+        // Pending removals would be lost by select()
         iPrivate->commitChanges();
-        id = iPrivate->valueAt(row, Private::FIELD_ID).toString();
-        HDEBUG(id << iPrivate->record(row));
-        if (iPrivate->iSaveImages) {
-            // Save the image on a separate thread. While we are saving
-            // it, the image will remain cached by HistoryImageProvider.
-            // It will be removed from the cache by Private::onSaveDone()
-            HistoryImageProvider* ip = HistoryImageProvider::instance();
-            if (ip && ip->cacheImage(id, aImage)) {
-                (new SaveTask(iPrivate->iThreadPool, aImage, id))->
-                    submit(iPrivate, SLOT(onSaveDone()));
-            }
-            // Assume that we do have images now
-            const bool hadImages = hasImages();
-            iPrivate->iHaveImages = Private::Yes;
-            if (!hadImages) {
-                Q_EMIT hasImagesChanged();
+        id = iPrivate->upsert(aText, aFormat, timestamp, &scanCount);
+        if (!id.isEmpty()) {
+            if (scanCount > 1 && iPrivate->updateRow(id, scanCount, timestamp)) {
+                HDEBUG("updated row" << id);
+            } else {
+                // Pick up the new row (or the one which wasn't there)
+                iPrivate->select();
+                if (scanCount == 1 && iPrivate->removeExtraRows()) {
+                    invalidateFilter();
+                    commitChanges();
+                }
             }
         }
+    } else {
+        QSqlRecord record(iPrivate->database().record(Private::DB_TABLE));
+        record.setValue(Private::DB_FIELD_VALUE, aText);
+        record.setValue(Private::DB_FIELD_TIMESTAMP, timestamp);
+        record.setValue(Private::DB_FIELD_FORMAT, aFormat);
+        record.setValue(Private::DB_FIELD_TYPE,
+            BarcodeUtils::contentType(aText, aFormat));
+        record.setValue(Private::DB_FIELD_PREVIEW, Private::preview(aText));
+        record.setValue(Private::DB_FIELD_SCAN_COUNT, 1);
+        record.setValue(Private::DB_FIELD_LAST_SEEN, timestamp);
+        // Set by Private::onSaveDone() once the image has been saved
+        record.setValue(Private::DB_FIELD_IMAGE, 0);
+        if (iPrivate->removeExtraRows(1)) {
+            invalidateFilter();
+            commitChanges();
+        }
+        const int row = 0;
+        if (iPrivate->insertRecord(row, record)) {
+            invalidateFilter();
+            // Just commit the changes, no need for cleanup:
+            iPrivate->commitChanges();
+            id = iPrivate->valueAt(row, Private::FIELD_ID).toString();
+            HDEBUG(id << iPrivate->record(row));
+        }
+    }
+    if (!id.isEmpty() && iPrivate->iSaveImages) {
+        // Save the image on a separate thread. While we are saving
+        // it, the image will remain cached by HistoryImageProvider.
+        // It will be removed from the cache by Private::onSaveDone()
+        // A repeated scan replaces the image of the existing row.
+        HistoryImageProvider* ip = HistoryImageProvider::instance();
+        if (ip && ip->cacheImage(id, aImage)) {
+            (new SaveTask(iPrivate->iThreadPool, aImage, id))->
+                submit(iPrivate, SLOT(onSaveDone()));
+        }
+        // Assume that we do have images now
+        const bool hadImages = hasImages();
+        iPrivate->iHaveImages = Private::Yes;
+        if (!hadImages) {
+            Q_EMIT hasImagesChanged();
+        }
     }
     return id;
 }
@@ -617,6 +1491,7 @@ void HistoryModel::remove(int aRow)
 void HistoryModel::removeAll()
 {
     HDEBUG("clearing history");
+    load();
     const int n = rowCount();
     if (n > 0) {
         removeRows(0, n);
@@ -34,17 +34,29 @@ THE SOFTWARE.
 #define HISTORY_FIELD_VALUE     "value"
 #define HISTORY_FIELD_TIMESTAMP "timestamp"
 #define HISTORY_FIELD_FORMAT    "format"
+#define HISTORY_FIELD_TYPE      "type"
+#define HISTORY_FIELD_PREVIEW   "preview"
+#define HISTORY_FIELD_SCAN_COUNT "scan_count"
+#define HISTORY_FIELD_LAST_SEEN "last_seen"
+#define HISTORY_FIELD_IMAGE     "image"
+
+// Number of characters stored in the preview column
+#define HISTORY_PREVIEW_LENGTH  (128)
 
 class HistoryModel: public QSortFilterProxyModel {
     Q_OBJECT
-    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
     Q_PROPERTY(int maxCount READ maxCount WRITE setMaxCount NOTIFY maxCountChanged)
     Q_PROPERTY(bool saveImages READ saveImages WRITE setSaveImages NOTIFY saveImagesChanged)
     Q_PROPERTY(bool hasImages READ hasImages NOTIFY hasImagesChanged)
+    Q_PROPERTY(bool dedupe READ dedupe WRITE setDedupe NOTIFY dedupeChanged)
+    Q_PROPERTY(QVariantMap query READ query WRITE setQuery NOTIFY queryChanged)
 
 public:
     HistoryModel(QObject* aParent = NULL);
 
+    int count() const;
+
     int maxCount() const;
     void setMaxCount(int aValue);
 
@@ -52,6 +64,13 @@ public:
     bool saveImages() const;
     void setSaveImages(bool aValue);
 
+    bool dedupe() const;
+    void setDedupe(bool aValue);
+
+    QVariantMap query() const;
+    void setQuery(QVariantMap aQuery);
+
+    Q_INVOKABLE void load();
     Q_INVOKABLE QVariantMap get(int row);
     Q_INVOKABLE QString getValue(int row);
     Q_INVOKABLE QString insert(QImage image, QString value, QString format);
@@ -78,11 +97,14 @@ Q_SIGNALS:
     void maxCountChanged();
     void hasImagesChanged();
     void saveImagesChanged();
+    void dedupeChanged();
+    void queryChanged();
 
 private:
     class Private;
     class SaveTask;
     class CleanupTask;
+    class ClassifyTask;
     class PurgeTask;
     Private* iPrivate;
 };
@@ -76,6 +76,7 @@ public:
     };
 
     static ParsedCode parseCode(QString aCode);
+    static bool isReceipt(const ParsedCode& aParsed);
 
     OfdReceiptFetcher* owner() const;
     void queueSignal(Signal aSignal);
@@ -199,6 +200,23 @@ OfdReceiptFetcher::Private::ParsedCode OfdReceiptFetcher::Private::parseCode(QSt
     return table;
 }
 
+bool OfdReceiptFetcher::Private::isReceipt(const ParsedCode& aParsed)
+{
+    if (aParsed.size() >= 6 &&
+        aParsed.contains(TotalSumTag) &&
+        aParsed.contains(FnNumberTag) &&
+        aParsed.contains(OperationTypeTag) &&
+        aParsed.contains(DocNumberTag) &&
+        aParsed.contains(DocFiscalSignTag)) {
+        const QString t(aParsed.value(DocDateTimeTag));
+        const QString s(aParsed.value(TotalSumTag));
+        // Accept both "20190622T1855" and "20190622T185500"
+        return (t.length() == 15 || t.length() == 13) && t.at(8) == 'T' &&
+            s.length() >= 3 && s.at(s.length() - 3) == '.';
+    }
+    return false;
+}
+
 void OfdReceiptFetcher::Private::setCode(QString aCode)
 {
     if (iCode != aCode) {
@@ -206,22 +224,11 @@ void OfdReceiptFetcher::Private::setCode(QString aCode)
         queueSignal(SignalCodeChanged);
         cancel();
         const ParsedCode parsed = parseCode(aCode);
-        if (parsed.size() >= 6 &&
-            parsed.contains(TotalSumTag) &&
-            parsed.contains(FnNumberTag) &&
-            parsed.contains(OperationTypeTag) &&
-            parsed.contains(DocNumberTag) &&
-            parsed.contains(DocFiscalSignTag)) {
-            const QString t(parsed.value(DocDateTimeTag));
-            const QString s(parsed.value(TotalSumTag));
-            // Accept both "20190622T1855" and "20190622T185500"
-            if ((t.length() == 15 || t.length() == 13) && t.at(8) == 'T' &&
-                 s.length() >= 3 && s.at(s.length() - 3) == '.') {
-                HDEBUG(iCode << "looks like a Russian receipt code");
-                iParsedCode = parsed;
-                setState(StateReady);
-                return;
-            }
+        if (isReceipt(parsed)) {
+            HDEBUG(iCode << "looks like a Russian receipt code");
+            iParsedCode = parsed;
+            setState(StateReady);
+            return;
         }
         HDEBUG(iCode << "is not a Russian receipt code");
         iParsedCode = ParsedCode();
@@ -345,6 +352,11 @@ OfdReceiptFetcher::OfdReceiptFetcher(QObject* aParent) :
 {
 }
 
+bool OfdReceiptFetcher::isReceiptCode(QString aCode)
+{
+    return Private::isReceipt(Private::parseCode(aCode));
+}
+
 OfdReceiptFetcher::State OfdReceiptFetcher::state() const
 {
     return iPrivate->iState;
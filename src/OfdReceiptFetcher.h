@@ -54,6 +54,8 @@ public:
 
     OfdReceiptFetcher(QObject* aParent = Q_NULLPTR);
 
+    static bool isReceiptCode(QString aCode);
+
     Q_INVOKABLE void fetch();
     Q_INVOKABLE void cancel();
 
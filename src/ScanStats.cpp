@@ -0,0 +1,295 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "ScanStats.h"
+#include "Database.h"
+
+#include "HarbourDebug.h"
+
+#include <QCryptographicHash>
+#include <QSqlError>
+#include <QSqlQuery>
+
+// ==========================================================================
+// ScanStats::Private
+// ==========================================================================
+
+class ScanStats::Private {
+public:
+    static const QString DAY;
+    static const QString FORMAT;
+    static const QString SCANS;
+    static const QString NEW_CODES;
+
+    static ScanStats* gInstance;
+
+    Private();
+
+    static QString firstDay(int aDays);
+    static QByteArray codeKey(QString aValue, QString aFormat);
+    static int sum(const char* aField);
+
+public:
+    mutable int iTotalScans;
+    mutable int iDistinctCodes;
+};
+
+const QString ScanStats::Private::DAY("day");
+const QString ScanStats::Private::FORMAT("format");
+const QString ScanStats::Private::SCANS("scans");
+const QString ScanStats::Private::NEW_CODES("newCodes");
+
+ScanStats* ScanStats::Private::gInstance = Q_NULLPTR;
+
+ScanStats::Private::Private() :
+    iTotalScans(-1),
+    iDistinctCodes(-1)
+{
+}
+
+// Days are stored as yyyy-MM-dd and compare as strings. Zero (or
+// negative) number of days selects everything.
+QString ScanStats::Private::firstDay(int aDays)
+{
+    return (aDays > 0) ? QDate::currentDate().addDays(1 - aDays).
+        toString(Qt::ISODate) : QString("");
+}
+
+// There's no need to store the values themselves, they may be long
+QByteArray ScanStats::Private::codeKey(QString aValue, QString aFormat)
+{
+    QCryptographicHash md5(QCryptographicHash::Md5);
+    md5.addData(aFormat.toUtf8());
+    md5.addData("", 1);
+    md5.addData(aValue.toUtf8());
+    return md5.result();
+}
+
+int ScanStats::Private::sum(const char* aField)
+{
+    QSqlQuery query(Database::database());
+    if (query.exec(QString("SELECT COALESCE(SUM(%1), 0) FROM " STATS_TABLE).
+        arg(QLatin1String(aField))) && query.next()) {
+        return query.value(0).toInt();
+    } else {
+        HWARN(query.lastError());
+        return 0;
+    }
+}
+
+// ==========================================================================
+// ScanStats
+// ==========================================================================
+
+ScanStats::ScanStats(QObject* aParent) :
+    QObject(aParent),
+    iPrivate(new Private)
+{
+    if (!Private::gInstance) {
+        Private::gInstance = this;
+    }
+}
+
+ScanStats::~ScanStats()
+{
+    delete iPrivate;
+    if (Private::gInstance == this) {
+        Private::gInstance = Q_NULLPTR;
+    }
+}
+
+// Callback for qmlRegisterSingletonType<ScanStats>
+QObject* ScanStats::createSingleton(QQmlEngine*, QJSEngine*)
+{
+    return new ScanStats();
+}
+
+int ScanStats::totalScans() const
+{
+    if (iPrivate->iTotalScans < 0) {
+        iPrivate->iTotalScans = Private::sum(STATS_FIELD_SCANS);
+    }
+    return iPrivate->iTotalScans;
+}
+
+int ScanStats::distinctCodes() const
+{
+    if (iPrivate->iDistinctCodes < 0) {
+        iPrivate->iDistinctCodes = Private::sum(STATS_FIELD_NEW_CODES);
+    }
+    return iPrivate->iDistinctCodes;
+}
+
+// Newest day first, the days without scans are skipped
+QVariantList ScanStats::daily(int aDays) const
+{
+    QVariantList list;
+    QSqlQuery query(Database::database());
+    query.prepare("SELECT " STATS_FIELD_DAY ", SUM(" STATS_FIELD_SCANS "), "
+        "SUM(" STATS_FIELD_NEW_CODES ") FROM " STATS_TABLE " WHERE "
+        STATS_FIELD_DAY " >= ? GROUP BY " STATS_FIELD_DAY " ORDER BY "
+        STATS_FIELD_DAY " DESC");
+    query.addBindValue(Private::firstDay(aDays));
+    if (query.exec()) {
+        while (query.next()) {
+            QVariantMap map;
+            map.insert(Private::DAY, query.value(0));
+            map.insert(Private::SCANS, query.value(1));
+            map.insert(Private::NEW_CODES, query.value(2));
+            list.append(map);
+        }
+    } else {
+        HWARN(query.lastError());
+    }
+    HDEBUG(aDays << list);
+    return list;
+}
+
+// The most frequently scanned format first
+QVariantList ScanStats::formats(int aDays) const
+{
+    QVariantList list;
+    QSqlQuery query(Database::database());
+    query.prepare("SELECT " STATS_FIELD_FORMAT ", SUM(" STATS_FIELD_SCANS
+        ") AS n FROM " STATS_TABLE " WHERE " STATS_FIELD_DAY " >= ? "
+        "GROUP BY " STATS_FIELD_FORMAT " ORDER BY n DESC");
+    query.addBindValue(Private::firstDay(aDays));
+    if (query.exec()) {
+        while (query.next()) {
+            QVariantMap map;
+            map.insert(Private::FORMAT, query.value(0));
+            map.insert(Private::SCANS, query.value(1));
+            list.append(map);
+        }
+    } else {
+        HWARN(query.lastError());
+    }
+    HDEBUG(aDays << list);
+    return list;
+}
+
+// Always 24 numbers, scans per hour of the day
+QVariantList ScanStats::hourly(int aDays) const
+{
+    QVariantList list;
+    for (int i = 0; i < 24; i++) {
+        list.append(0);
+    }
+    QSqlQuery query(Database::database());
+    query.prepare("SELECT " STATS_FIELD_HOUR ", SUM(" STATS_FIELD_SCANS
+        ") FROM " STATS_TABLE " WHERE " STATS_FIELD_DAY " >= ? "
+        "GROUP BY " STATS_FIELD_HOUR);
+    query.addBindValue(Private::firstDay(aDays));
+    if (query.exec()) {
+        while (query.next()) {
+            const int hour = query.value(0).toInt();
+            if (hour >= 0 && hour < 24) {
+                list[hour] = query.value(1);
+            }
+        }
+    } else {
+        HWARN(query.lastError());
+    }
+    HDEBUG(aDays << list);
+    return list;
+}
+
+void ScanStats::reset()
+{
+    HDEBUG("resetting stats");
+    QSqlDatabase db = Database::database();
+    HVERIFY(db.transaction());
+    if (QSqlQuery(db).exec("DELETE FROM " STATS_TABLE) &&
+        QSqlQuery(db).exec("DELETE FROM " STATS_CODES_TABLE)) {
+        HVERIFY(db.commit());
+    } else {
+        HWARN(db.lastError());
+        HVERIFY(db.rollback());
+    }
+    iPrivate->iTotalScans = iPrivate->iDistinctCodes = -1;
+    Q_EMIT changed();
+}
+
+void ScanStats::scanned(QString aValue, QString aFormat, QDateTime aTime)
+{
+    QSqlDatabase db = Database::database();
+    HVERIFY(db.transaction());
+    if (addScan(db, aValue, aFormat, aTime)) {
+        HVERIFY(db.commit());
+        ScanStats* self = Private::gInstance;
+        if (self) {
+            self->iPrivate->iTotalScans = self->iPrivate->iDistinctCodes = -1;
+            Q_EMIT self->changed();
+        }
+    } else {
+        HVERIFY(db.rollback());
+    }
+}
+
+bool ScanStats::addScan(QSqlDatabase aDb, QString aValue, QString aFormat,
+    QDateTime aTime, int aCount)
+{
+    const QString day(aTime.date().toString(Qt::ISODate));
+    const int hour = aTime.time().hour();
+    QSqlQuery query(aDb);
+    // Only the first scan of a code ever makes it into the table
+    query.prepare("INSERT OR IGNORE INTO " STATS_CODES_TABLE " ("
+        STATS_CODES_FIELD_CODE ", " STATS_CODES_FIELD_DAY ") VALUES (?, ?)");
+    query.addBindValue(Private::codeKey(aValue, aFormat));
+    query.addBindValue(day);
+    if (!query.exec()) {
+        HWARN(query.lastError());
+        return false;
+    }
+    const int newCodes = query.numRowsAffected();
+    // Not using upsert, it requires SQLite 3.24 or later
+    query.prepare("UPDATE " STATS_TABLE " SET " STATS_FIELD_SCANS " = "
+        STATS_FIELD_SCANS " + ?, " STATS_FIELD_NEW_CODES " = "
+        STATS_FIELD_NEW_CODES " + ? WHERE " STATS_FIELD_DAY " = ? AND "
+        STATS_FIELD_HOUR " = ? AND " STATS_FIELD_FORMAT " = ?");
+    query.addBindValue(aCount);
+    query.addBindValue(newCodes);
+    query.addBindValue(day);
+    query.addBindValue(hour);
+    query.addBindValue(aFormat);
+    if (!query.exec()) {
+        HWARN(query.lastError());
+        return false;
+    }
+    if (query.numRowsAffected() < 1) {
+        query.prepare("INSERT INTO " STATS_TABLE " (" STATS_FIELD_DAY ", "
+            STATS_FIELD_HOUR ", " STATS_FIELD_FORMAT ", " STATS_FIELD_SCANS
+            ", " STATS_FIELD_NEW_CODES ") VALUES (?, ?, ?, ?, ?)");
+        query.addBindValue(day);
+        query.addBindValue(hour);
+        query.addBindValue(aFormat);
+        query.addBindValue(aCount);
+        query.addBindValue(newCodes);
+        if (!query.exec()) {
+            HWARN(query.lastError());
+            return false;
+        }
+    }
+    return true;
+}
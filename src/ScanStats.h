@@ -0,0 +1,86 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef BARCODE_SCAN_STATS_H
+#define BARCODE_SCAN_STATS_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QVariant>
+
+// Number of scans per day, hour and format
+#define STATS_TABLE             "stats"
+#define STATS_FIELD_DAY         "day"
+#define STATS_FIELD_HOUR        "hour"
+#define STATS_FIELD_FORMAT      "format"
+#define STATS_FIELD_SCANS       "scans"
+#define STATS_FIELD_NEW_CODES   "new_codes"
+
+// Every code ever scanned (hashed) and the day it was first seen
+#define STATS_CODES_TABLE       "stats_codes"
+#define STATS_CODES_FIELD_CODE  "code"
+#define STATS_CODES_FIELD_DAY   "day"
+
+class QQmlEngine;
+class QJSEngine;
+
+class ScanStats : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int totalScans READ totalScans NOTIFY changed)
+    Q_PROPERTY(int distinctCodes READ distinctCodes NOTIFY changed)
+
+public:
+    ScanStats(QObject* aParent = Q_NULLPTR);
+    ~ScanStats();
+
+    int totalScans() const;
+    int distinctCodes() const;
+
+    // Each of these reads no more than the last aDays days of aggregates
+    Q_INVOKABLE QVariantList daily(int aDays) const;
+    Q_INVOKABLE QVariantList formats(int aDays) const;
+    Q_INVOKABLE QVariantList hourly(int aDays) const;
+    Q_INVOKABLE void reset();
+
+    // Updates the aggregates, called by HistoryModel for every scan
+    static void scanned(QString aValue, QString aFormat, QDateTime aTime);
+
+    // Doesn't start a transaction, used by Database when seeding the stats.
+    // Returns false on failure, the transaction should be rolled back then.
+    static bool addScan(QSqlDatabase aDb, QString aValue, QString aFormat,
+        QDateTime aTime, int aCount = 1);
+
+    // Callback for qmlRegisterSingletonType<ScanStats>
+    static QObject* createSingleton(QQmlEngine* aEngine, QJSEngine* aScript);
+
+Q_SIGNALS:
+    void changed();
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // BARCODE_SCAN_STATS_H
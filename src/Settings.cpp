@@ -31,9 +31,12 @@ THE SOFTWARE.
 // New keys (the ones that have only been in dconf)
 #define KEY_BUZZ_ON_SCAN               "buzz_on_scan"
 #define KEY_SAVE_IMAGES                "save_images"
+#define KEY_HISTORY_DEDUPE             "history_dedupe"
 #define KEY_WIDE_MODE                  "wide_mode"
 #define KEY_ORIENTATION                "orientation"
 #define KEY_MAX_DIGITAL_ZOOM           "max_digital_zoom"
+#define KEY_DECODING_PRIORITY          "decoding_priority"
+#define KEY_DECODING_CPUS              "decoding_cpus"
 
 #define DEFAULT_SOUND                   false
 #define DEFAULT_BUZZ_ON_SCAN            true
@@ -45,8 +48,11 @@ THE SOFTWARE.
 #define DEFAULT_HISTORY_SIZE            50
 #define DEFAULT_SCAN_ON_START           false
 #define DEFAULT_SAVE_IMAGES             true
+#define DEFAULT_HISTORY_DEDUPE          false
 #define DEFAULT_WIDE_MODE               false
 #define DEFAULT_ORIENTATION             (Settings::OrientationAny)
+#define DEFAULT_DECODING_PRIORITY       5  // nice value
+#define DEFAULT_DECODING_CPUS           "" // all CPUs
 
 // ==========================================================================
 // Settings::Private
@@ -69,8 +75,11 @@ public:
     MGConfItem* iHistorySize;
     MGConfItem* iScanOnStart;
     MGConfItem* iSaveImages;
+    MGConfItem* iHistoryDedupe;
     MGConfItem* iWideMode;
     MGConfItem* iOrientation;
+    MGConfItem* iDecodingPriority;
+    MGConfItem* iDecodingCpus;
 };
 
 const QString Settings::Private::HINTS_ROOT(DCONF_PATH "hints/");
@@ -86,8 +95,11 @@ Settings::Private::Private(Settings* aSettings) :
     iHistorySize(new MGConfItem(DCONF_PATH KEY_HISTORY_SIZE, aSettings)),
     iScanOnStart(new MGConfItem(DCONF_PATH KEY_SCAN_ON_START, aSettings)),
     iSaveImages(new MGConfItem(DCONF_PATH KEY_SAVE_IMAGES, aSettings)),
+    iHistoryDedupe(new MGConfItem(DCONF_PATH KEY_HISTORY_DEDUPE, aSettings)),
     iWideMode(new MGConfItem(DCONF_PATH KEY_WIDE_MODE, aSettings)),
-    iOrientation(new MGConfItem(DCONF_PATH KEY_ORIENTATION, aSettings))
+    iOrientation(new MGConfItem(DCONF_PATH KEY_ORIENTATION, aSettings)),
+    iDecodingPriority(new MGConfItem(DCONF_PATH KEY_DECODING_PRIORITY, aSettings)),
+    iDecodingCpus(new MGConfItem(DCONF_PATH KEY_DECODING_CPUS, aSettings))
 {
     connect(iSound, SIGNAL(valueChanged()), aSettings, SIGNAL(soundChanged()));
     connect(iBuzzOnScan, SIGNAL(valueChanged()), aSettings, SIGNAL(buzzOnScanChanged()));
@@ -99,8 +111,11 @@ Settings::Private::Private(Settings* aSettings) :
     connect(iHistorySize, SIGNAL(valueChanged()), aSettings, SIGNAL(historySizeChanged()));
     connect(iScanOnStart, SIGNAL(valueChanged()), aSettings, SIGNAL(scanOnStartChanged()));
     connect(iSaveImages, SIGNAL(valueChanged()), aSettings, SIGNAL(saveImagesChanged()));
+    connect(iHistoryDedupe, SIGNAL(valueChanged()), aSettings, SIGNAL(historyDedupeChanged()));
     connect(iWideMode, SIGNAL(valueChanged()), aSettings, SIGNAL(wideModeChanged()));
     connect(iOrientation, SIGNAL(valueChanged()), aSettings, SIGNAL(orientationChanged()));
+    connect(iDecodingPriority, SIGNAL(valueChanged()), aSettings, SIGNAL(decodingPriorityChanged()));
+    connect(iDecodingCpus, SIGNAL(valueChanged()), aSettings, SIGNAL(decodingCpusChanged()));
 }
 
 // ==========================================================================
@@ -223,6 +238,16 @@ void Settings::setSaveImages(bool aValue)
     iPrivate->iSaveImages->set(aValue);
 }
 
+bool Settings::historyDedupe() const
+{
+    return iPrivate->iHistoryDedupe->value(DEFAULT_HISTORY_DEDUPE).toBool();
+}
+
+void Settings::setHistoryDedupe(bool aValue)
+{
+    iPrivate->iHistoryDedupe->set(aValue);
+}
+
 bool Settings::wideMode() const
 {
     return iPrivate->iWideMode->value(DEFAULT_WIDE_MODE).toBool();
@@ -242,3 +267,23 @@ void Settings::setOrientation(Orientation aValue)
 {
     iPrivate->iOrientation->set((int)aValue);
 }
+
+int Settings::decodingPriority() const
+{
+    return iPrivate->iDecodingPriority->value(DEFAULT_DECODING_PRIORITY).toInt();
+}
+
+void Settings::setDecodingPriority(int aValue)
+{
+    iPrivate->iDecodingPriority->set(aValue);
+}
+
+QString Settings::decodingCpus() const
+{
+    return iPrivate->iDecodingCpus->value(DEFAULT_DECODING_CPUS).toString();
+}
+
+void Settings::setDecodingCpus(QString aValue)
+{
+    iPrivate->iDecodingCpus->set(aValue);
+}
@@ -52,8 +52,11 @@ class Settings : public QObject {
     Q_PROPERTY(int historySize READ historySize WRITE setHistorySize NOTIFY historySizeChanged)
     Q_PROPERTY(bool scanOnStart READ scanOnStart WRITE setScanOnStart NOTIFY scanOnStartChanged)
     Q_PROPERTY(bool saveImages READ saveImages WRITE setSaveImages NOTIFY saveImagesChanged)
+    Q_PROPERTY(bool historyDedupe READ historyDedupe WRITE setHistoryDedupe NOTIFY historyDedupeChanged)
     Q_PROPERTY(bool wideMode READ wideMode WRITE setWideMode NOTIFY wideModeChanged)
     Q_PROPERTY(Orientation orientation READ orientation WRITE setOrientation NOTIFY orientationChanged)
+    Q_PROPERTY(int decodingPriority READ decodingPriority WRITE setDecodingPriority NOTIFY decodingPriorityChanged)
+    Q_PROPERTY(QString decodingCpus READ decodingCpus WRITE setDecodingCpus NOTIFY decodingCpusChanged)
     Q_ENUMS(Orientation)
     Q_ENUMS(Constants)
 
@@ -106,12 +109,21 @@ public:
     bool saveImages() const;
     void setSaveImages(bool aValue);
 
+    bool historyDedupe() const;
+    void setHistoryDedupe(bool aValue);
+
     bool wideMode() const;
     void setWideMode(bool aValue);
 
     Orientation orientation() const;
     void setOrientation(Orientation aValue);
 
+    int decodingPriority() const;
+    void setDecodingPriority(int aValue);
+
+    QString decodingCpus() const;
+    void setDecodingCpus(QString aValue);
+
 Q_SIGNALS:
     void soundChanged();
     void buzzOnScanChanged();
@@ -123,8 +135,11 @@ Q_SIGNALS:
     void historySizeChanged();
     void scanOnStartChanged();
     void saveImagesChanged();
+    void historyDedupeChanged();
     void wideModeChanged();
     void orientationChanged();
+    void decodingPriorityChanged();
+    void decodingCpusChanged();
 
 private:
     class Private;
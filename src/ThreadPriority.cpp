@@ -0,0 +1,136 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "ThreadPriority.h"
+
+#include "HarbourDebug.h"
+
+#include <QStringList>
+
+#include <sched.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+static pid_t threadId()
+{
+    return (pid_t)syscall(SYS_gettid);
+}
+
+bool ThreadPriority::setNice(int aNice)
+{
+    const pid_t tid = threadId();
+    errno = 0;
+    const int current = getpriority(PRIO_PROCESS, tid);
+    if (errno == 0 && current == aNice) {
+        return true;
+    } else if (setpriority(PRIO_PROCESS, tid, aNice) == 0) {
+        HDEBUG("thread" << tid << "nice" << current << "=>" << aNice);
+        return true;
+    } else {
+        HWARN("Failed to set nice" << aNice << "for thread" << tid <<
+            strerror(errno));
+        return false;
+    }
+}
+
+int ThreadPriority::nice()
+{
+    return getpriority(PRIO_PROCESS, threadId());
+}
+
+bool ThreadPriority::setCpus(QString aCpus)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    const int ncpu = (int)sysconf(_SC_NPROCESSORS_CONF);
+    const QStringList ranges(aCpus.split(',', QString::SkipEmptyParts));
+    if (ranges.isEmpty()) {
+        for (int i = 0; i < ncpu && i < CPU_SETSIZE; i++) {
+            CPU_SET(i, &set);
+        }
+    } else {
+        for (int i = 0; i < ranges.count(); i++) {
+            const QStringList range(ranges.at(i).split('-'));
+            bool ok1 = false, ok2 = false;
+            const int first = range.at(0).trimmed().toInt(&ok1);
+            const int last = (range.count() == 2) ?
+                range.at(1).trimmed().toInt(&ok2) : first;
+            if (ok1 && (range.count() == 1 || ok2) && range.count() <= 2 &&
+                first >= 0 && first <= last) {
+                for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+                    CPU_SET(cpu, &set);
+                }
+            } else {
+                HWARN("Invalid CPU list" << aCpus);
+                return false;
+            }
+        }
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) == 0) {
+        HDEBUG("thread" << threadId() << "cpus" << qPrintable(cpus()));
+        return true;
+    } else {
+        HWARN("Failed to set CPU affinity" << aCpus << strerror(errno));
+        return false;
+    }
+}
+
+QString ThreadPriority::cpus()
+{
+    QStringList list;
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                int last = cpu;
+                while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &set)) {
+                    last++;
+                }
+                list.append((last > cpu) ? QString("%1-%2").arg(cpu).arg(last) :
+                    QString::number(cpu));
+                cpu = last;
+            }
+        }
+    }
+    return list.join(',');
+}
+
+int ThreadPriority::currentCpu()
+{
+    return sched_getcpu();
+}
+
+qint64 ThreadPriority::cpuTimeMs()
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return ((qint64)ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+    return 0;
+}
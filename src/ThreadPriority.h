@@ -0,0 +1,52 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#ifndef THREAD_PRIORITY_H
+#define THREAD_PRIORITY_H
+
+#include <QString>
+
+// Per-thread scheduling knobs. Qt thread priorities are ignored for
+// SCHED_OTHER threads on Linux, so these go straight to the kernel.
+// Everything applies to the calling thread only.
+class ThreadPriority {
+public:
+    // Sets the nice value of the calling thread. Unprivileged threads
+    // can only increase it, so the threads this is called on shouldn't
+    // be shared with code that expects the default priority.
+    static bool setNice(int aNice);
+    static int nice();
+
+    // Pins the calling thread to the CPUs listed in aCpus, e.g. "4-7"
+    // or "0,2-3". Empty string means all CPUs.
+    static bool setCpus(QString aCpus);
+    static QString cpus();
+
+    // For statistics
+    static int currentCpu();
+    static qint64 cpuTimeMs();
+};
+
+#endif // THREAD_PRIORITY_H
@@ -32,6 +32,10 @@ THE SOFTWARE.
 
 #include <MGConfItem>
 
+#if HARBOUR_DEBUG
+#include <QElapsedTimer>
+#endif
+
 #include "scanner/BarcodeScanner.h"
 
 #include "HarbourDebug.h"
@@ -47,6 +51,7 @@ THE SOFTWARE.
 #include "HistoryModel.h"
 #include "MeCardConverter.h"
 #include "OfdReceiptFetcher.h"
+#include "ScanStats.h"
 #include "Settings.h"
 
 #ifndef APP_VERSION
@@ -68,6 +73,7 @@ static void register_types(QQmlEngine* engine, const char* uri, int v1, int v2)
     qmlRegisterUncreatableType<Settings>(uri, v1, v2, "Settings", "Use AppSettings context property");
     qmlRegisterSingletonType<HistoryModel>(uri, v1, v2, "HistoryModel", HistoryModel::createSingleton);
     qmlRegisterSingletonType<BarcodeUtils>(uri, v1, v2, "BarcodeUtils", BarcodeUtils::createSingleton);
+    qmlRegisterSingletonType<ScanStats>(uri, v1, v2, "ScanStats", ScanStats::createSingleton);
 }
 
 static QSize toSize(QVariant var)
@@ -144,7 +150,14 @@ int main(int argc, char *argv[])
     engine->addImageProvider("scanner", new HistoryImageProvider);
 
     Settings* settings = new Settings(app.data());
+#if HARBOUR_DEBUG
+    QElapsedTimer timer;
+    timer.start();
+#endif
     Database::initialize(engine, settings);
+#if HARBOUR_DEBUG
+    HDEBUG("database initialized in" << timer.restart() << "ms");
+#endif
 
     QQmlContext* root = view->rootContext();
     root->setContextProperty("AppVersion", APP_VERSION);
@@ -158,6 +171,9 @@ int main(int argc, char *argv[])
     }
 
     view->setSource(SailfishApp::pathTo("qml/harbour-barcode.qml"));
+#if HARBOUR_DEBUG
+    HDEBUG("QML loaded in" << timer.elapsed() << "ms");
+#endif
     view->setTitle("CodeReader");
     view->showFullScreen();
     return app->exec();
@@ -26,17 +26,36 @@ THE SOFTWARE.
 #include "BarcodeScanner.h"
 #include "ImageSource.h"
 #include "Decoder.h"
+#include "DecodingScheduler.h"
+#include "FrameAccumulator.h"
+
+#include "ThreadPriority.h"
 
 #include "HarbourDebug.h"
 
-#include <QtConcurrent>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QTime>
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QQuickWindow>
 #include <QQuickItem>
 #include <QPainter>
 #include <QBrush>
 
-#ifdef HARBOUR_DEBUG
+#if HARBOUR_DEBUG
+#include <QDateTime>
+#include <QDir>
 #include <QStandardPaths>
+// Initialized when the process is being loaded, close enough to the
+// actual start time to measure how long it takes to get the first
+// frame processed and the first barcode decoded.
+static const qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+static bool firstFrameProcessed = false;
+static qint64 firstDecodeTime = 0;
 static const QDir debugImageDir(QStandardPaths::writableLocation(QStandardPaths::PicturesLocation) + "/codereader");
 static void saveDebugImage(const QImage& aImage, const QString& aFileName)
 {
@@ -57,6 +76,8 @@ static void saveDebugImage(const QImage& aImage, const QString& aFileName)
 
 class BarcodeScanner::Private : public QObject {
     Q_OBJECT
+    class DecodingTask;
+
 public:
     Private(BarcodeScanner* aParent);
     ~Private();
@@ -67,6 +88,9 @@ public:
     bool setViewFinderItem(QObject* aValue);
     bool setMarkerColor(QString aValue);
     bool setRotation(int aDegrees);
+    bool setDecodingPriority(int aNice);
+    bool setDecodingCpus(QString aCpus);
+    bool setFormatOptions(QVariantMap aOptions);
     void startScanning(int aTimeout);
     void stopScanning();
     void decodingThread();
@@ -75,10 +99,12 @@ public:
 Q_SIGNALS:
     void needImage();
     void decodingDone(QImage image, Decoder::Result result);
+    void decodingStats(QVariantMap stats);
 
 public Q_SLOTS:
     void onScanningTimeout();
     void onDecodingDone(QImage aImage, Decoder::Result aResult);
+    void onDecodingStats(QVariantMap aStats);
     void onGrabImage();
 
 public:
@@ -87,6 +113,10 @@ public:
     bool iAbortScan;
     bool iTimedOut;
     int iRotation;
+    int iDecodingPriority;
+    QString iDecodingCpus;
+    QVariantMap iFormatOptions;
+    QVariantMap iDecodingStats;
     ScanState iLastKnownState;
 
     QImage iCaptureImage;
@@ -95,12 +125,26 @@ public:
 
     QMutex iDecodingMutex;
     QWaitCondition iDecodingEvent;
-    QFuture<void> iDecodingFuture;
+    // Decoding is CPU intensive and shouldn't compete with the render
+    // thread. It runs on its own thread (nice value can't be lowered
+    // back once raised, so it can't be a shared pool thread) and holds
+    // iDecodingMutex only for as long as it takes to swap the images,
+    // so a low priority decoder can't keep the UI thread waiting.
+    QThreadPool* iDecodingPool;
 
     QRect iViewFinderRect;
     QColor iMarkerColor;
 };
 
+class BarcodeScanner::Private::DecodingTask : public QRunnable {
+public:
+    DecodingTask(Private* aScanner) : iScanner(aScanner) {}
+    void run() Q_DECL_OVERRIDE { iScanner->decodingThread(); }
+
+private:
+    Private* iScanner;
+};
+
 BarcodeScanner::Private::Private(BarcodeScanner* aParent) :
     QObject(aParent),
     iGrabbing(false),
@@ -108,11 +152,14 @@ BarcodeScanner::Private::Private(BarcodeScanner* aParent) :
     iAbortScan(false),
     iTimedOut(false),
     iRotation(0),
+    iDecodingPriority(0),
     iLastKnownState(Idle),
     iViewFinderItem(NULL),
     iScanTimeout(new QTimer(this)),
+    iDecodingPool(new QThreadPool(this)),
     iMarkerColor(QColor(0, 255, 0)) // default green
 {
+    iDecodingPool->setMaxThreadCount(1);
     iScanTimeout->setSingleShot(true);
     connect(iScanTimeout, SIGNAL(timeout()), SLOT(onScanningTimeout()));
 
@@ -121,6 +168,9 @@ BarcodeScanner::Private::Private(BarcodeScanner* aParent) :
     connect(this, SIGNAL(decodingDone(QImage,Decoder::Result)),
         SLOT(onDecodingDone(QImage,Decoder::Result)),
         Qt::QueuedConnection);
+    connect(this, SIGNAL(decodingStats(QVariantMap)),
+        SLOT(onDecodingStats(QVariantMap)),
+        Qt::QueuedConnection);
 
     // Forward needImage emitted by the decoding thread
     connect(this, SIGNAL(needImage()), SLOT(onGrabImage()),
@@ -130,7 +180,7 @@ BarcodeScanner::Private::Private(BarcodeScanner* aParent) :
 BarcodeScanner::Private::~Private()
 {
     stopScanning();
-    iDecodingFuture.waitForFinished();
+    iDecodingPool->waitForDone();
 }
 
 inline BarcodeScanner* BarcodeScanner::Private::scanner()
@@ -183,6 +233,41 @@ bool BarcodeScanner::Private::setRotation(int aDegrees)
     return false;
 }
 
+bool BarcodeScanner::Private::setDecodingPriority(int aNice)
+{
+    if (iDecodingPriority != aNice) {
+        // Picked up by the next decodingThread() call
+        iDecodingMutex.lock();
+        iDecodingPriority = aNice;
+        iDecodingMutex.unlock();
+        return true;
+    }
+    return false;
+}
+
+bool BarcodeScanner::Private::setDecodingCpus(QString aCpus)
+{
+    if (iDecodingCpus != aCpus) {
+        iDecodingMutex.lock();
+        iDecodingCpus = aCpus;
+        iDecodingMutex.unlock();
+        return true;
+    }
+    return false;
+}
+
+bool BarcodeScanner::Private::setFormatOptions(QVariantMap aOptions)
+{
+    if (iFormatOptions != aOptions) {
+        // Picked up by the next decodingThread() call
+        iDecodingMutex.lock();
+        iFormatOptions = aOptions;
+        iDecodingMutex.unlock();
+        return true;
+    }
+    return false;
+}
+
 void BarcodeScanner::Private::startScanning(int aTimeout)
 {
     if (!iScanning) {
@@ -191,7 +276,7 @@ void BarcodeScanner::Private::startScanning(int aTimeout)
         iTimedOut = false;
         iScanTimeout->start(aTimeout);
         iCaptureImage = QImage();
-        iDecodingFuture = QtConcurrent::run(this, &Private::decodingThread);
+        iDecodingPool->start(new DecodingTask(this));
         updateScanState();
     }
 }
@@ -235,14 +320,28 @@ void BarcodeScanner::Private::decodingThread()
 {
     HDEBUG("decodingThread() is called from " << QThread::currentThread());
 
+    iDecodingMutex.lock();
+    const int nice = iDecodingPriority;
+    const QString cpus(iDecodingCpus);
+    const QVariantMap formatOptions(iFormatOptions);
+    iDecodingMutex.unlock();
+
+    ThreadPriority::setNice(nice);
+    ThreadPriority::setCpus(cpus);
+
+    const int maxSize = 800;
+    const int frameBudget = 200; // ms
+
     Decoder decoder;
+    decoder.setFormatOptions(formatOptions);
+    DecodingScheduler scheduler(frameBudget);
+    FrameAccumulator accumulator;
     Decoder::Result result;
     QImage image;
     qreal scale = 1;
-    bool rotated = false;
-    int scaledWidth = 0;
-
-    const int maxSize = 800;
+    int frames = 0;
+    qint64 wallMs = 0;
+    qint64 cpuMs = 0;
 
     iDecodingMutex.lock();
     while (!iAbortScan && !result.isValid()) {
@@ -263,9 +362,9 @@ void BarcodeScanner::Private::decodingThread()
         iDecodingMutex.unlock();
 
         if (!image.isNull()) {
-#if HARBOUR_DEBUG
-            QTime time(QTime::currentTime());
-#endif
+            QElapsedTimer time;
+            time.start();
+            const qint64 cpuTime = ThreadPriority::cpuTimeMs();
             saveDebugImage(image, "debug_screenshot.bmp");
 
             // Crop the image - we only need the viewfinder area
@@ -357,38 +456,85 @@ void BarcodeScanner::Private::decodingThread()
                 scale = 1;
             }
 
-            // Ref takes ownership of ImageSource:
-            ImageSource* source = new ImageSource(scaledImage);
-            zxing::Ref<zxing::LuminanceSource> sourceRef(source);
-
 #if HARBOUR_DEBUG
             // These are expensive, check if directory exists before
             // generating debug images (esp. the black & white one,
             // which is purely for debugging)
             if (debugImageDir.exists()) {
+                // Ref takes ownership of ImageSource:
+                ImageSource* source = new ImageSource(scaledImage);
+                zxing::Ref<zxing::LuminanceSource> sourceRef(source);
                 saveDebugImage(source->grayscaleImage(), "debug_grayscale.bmp");
                 saveDebugImage(source->bwImage(), "debug_bw.bmp");
             }
 #endif // HARBOUR_DEBUG
 
-            HDEBUG("decoding screenshot ...");
-            result = decoder.decode(sourceRef);
+            // Cheap tactics on every frame, expensive ones take turns
+            const QList<Decoder::Tactic> tactics(scheduler.plan(scaledImage));
+            QElapsedTimer frameTimer;
+            frameTimer.start();
+            for (int i = 0; i < tactics.count() && !result.isValid(); i++) {
+                // The estimates may be off, don't go too far over budget
+                if (i > 0 && frameTimer.elapsed() > frameBudget) {
+                    HDEBUG("out of time after" << i << "tactic(s)");
+                    break;
+                }
+                const Decoder::Tactic tactic = tactics.at(i);
+                QElapsedTimer timer;
+                timer.start();
+                HDEBUG("decoding screenshot," << Decoder::tacticName(tactic) << "tactic ...");
+                result = decoder.decode(scaledImage, tactic);
+                scheduler.done(tactic, (int)timer.elapsed(), result.isValid());
+            }
 
+            // In poor light, try the average of the last few frames
             if (!result.isValid()) {
-                // try the other orientation for 1D bar code
-                QTransform transform;
-                transform.rotate(90);
-                scaledImage = scaledImage.transformed(transform);
-                saveDebugImage(scaledImage, "debug_rotated.bmp");
-                HDEBUG("decoding rotated screenshot ...");
-                result = decoder.decode(scaledImage);
-                // We need scaled width for rotating the points back
-                scaledWidth = scaledImage.width();
-                rotated = true;
-            } else {
-                rotated = false;
+                const QImage denoised(accumulator.add(scaledImage));
+                if (!denoised.isNull()) {
+                    HDEBUG("decoding denoised image ...");
+                    saveDebugImage(denoised, "debug_denoised.bmp");
+                    result = decoder.decode(denoised);
+                }
             }
-            HDEBUG("decoding took" << time.elapsed() << "ms");
+#if HARBOUR_DEBUG
+            if (!firstFrameProcessed) {
+                firstFrameProcessed = true;
+                HDEBUG("first frame processed" << (QDateTime::currentMSecsSinceEpoch() -
+                    startTime) << "ms after startup");
+            }
+            if (!firstDecodeTime && result.isValid()) {
+                firstDecodeTime = QDateTime::currentMSecsSinceEpoch();
+                HDEBUG("first barcode decoded" << (firstDecodeTime -
+                    startTime) << "ms after startup");
+            }
+#endif
+
+            // Statistics, picked up by the main thread
+            const qint64 frameMs = time.elapsed();
+            const qint64 frameCpuMs = ThreadPriority::cpuTimeMs() - cpuTime;
+            QVariantMap cost;
+            for (int i = 0; i < Decoder::TacticCount; i++) {
+                const Decoder::Tactic tactic = (Decoder::Tactic)i;
+                const int ms = scheduler.cost(tactic);
+                if (ms) {
+                    cost.insert(Decoder::tacticName(tactic), ms);
+                }
+            }
+            const int frameNice = ThreadPriority::nice();
+            const int frameCpu = ThreadPriority::currentCpu();
+            const QString frameCpus(ThreadPriority::cpus());
+            QVariantMap stats;
+            stats.insert("frames", ++frames);
+            stats.insert("wallMs", wallMs += frameMs);
+            stats.insert("cpuMs", cpuMs += frameCpuMs);
+            stats.insert("nice", frameNice);
+            stats.insert("cpu", frameCpu);
+            stats.insert("cpus", frameCpus);
+            stats.insert("cost", cost);
+            Q_EMIT decodingStats(stats);
+            HDEBUG("decoding took" << frameMs << "ms, cpu" << frameCpuMs <<
+                "ms, nice" << frameNice << "cpu" << frameCpu << "of" <<
+                qPrintable(frameCpus));
         }
         iDecodingMutex.lock();
     }
@@ -396,18 +542,13 @@ void BarcodeScanner::Private::decodingThread()
 
     if (result.isValid()) {
         HDEBUG("decoding succeeded:" << result.getText() << result.getPoints());
-        if (scale > 1 || rotated) {
-            // The image could be a) scaled and b) rotated. Convert
-            // points to the original coordinate system
+        if (scale > 1) {
+            // The image could be scaled. Decoder has already taken care
+            // of rotation. Convert points to the original coordinate system
             QList<QPointF> points = result.getPoints();
             const int n = points.size();
             for (int i = 0; i < n; i++) {
                 QPointF p(points.at(i));
-                if (rotated) {
-                    const qreal x = p.rx();
-                    p.setX(p.ry());
-                    p.setY(scaledWidth - x);
-                }
                 p *= scale;
                 HDEBUG(points[i] << "=>" << p);
                 points[i] = p;
@@ -459,6 +600,12 @@ void BarcodeScanner::Private::onDecodingDone(QImage aImage, Decoder::Result aRes
     updateScanState();
 }
 
+void BarcodeScanner::Private::onDecodingStats(QVariantMap aStats)
+{
+    iDecodingStats = aStats;
+    Q_EMIT scanner()->decodingStatsChanged();
+}
+
 void BarcodeScanner::Private::onScanningTimeout()
 {
     iDecodingMutex.lock();
@@ -563,6 +710,50 @@ BarcodeScanner::ScanState BarcodeScanner::scanState() const
     return iPrivate->iLastKnownState;
 }
 
+int BarcodeScanner::decodingPriority() const
+{
+    return iPrivate->iDecodingPriority;
+}
+
+void BarcodeScanner::setDecodingPriority(int aNice)
+{
+    if (iPrivate->setDecodingPriority(aNice)) {
+        HDEBUG(aNice);
+        Q_EMIT decodingPriorityChanged();
+    }
+}
+
+QString BarcodeScanner::decodingCpus() const
+{
+    return iPrivate->iDecodingCpus;
+}
+
+void BarcodeScanner::setDecodingCpus(QString aCpus)
+{
+    if (iPrivate->setDecodingCpus(aCpus)) {
+        HDEBUG(aCpus);
+        Q_EMIT decodingCpusChanged();
+    }
+}
+
+QVariantMap BarcodeScanner::formatOptions() const
+{
+    return iPrivate->iFormatOptions;
+}
+
+void BarcodeScanner::setFormatOptions(QVariantMap aOptions)
+{
+    if (iPrivate->setFormatOptions(aOptions)) {
+        HDEBUG(aOptions);
+        Q_EMIT formatOptionsChanged();
+    }
+}
+
+QVariantMap BarcodeScanner::decodingStats() const
+{
+    return iPrivate->iDecodingStats;
+}
+
 bool BarcodeScanner::grabbing() const
 {
     return iPrivate->iGrabbing;
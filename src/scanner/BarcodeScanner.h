@@ -40,6 +40,10 @@ class BarcodeScanner : public QObject {
     Q_PROPERTY(int rotation READ rotation WRITE setRotation NOTIFY rotationChanged)
     Q_PROPERTY(ScanState scanState READ scanState NOTIFY scanStateChanged)
     Q_PROPERTY(bool grabbing READ grabbing NOTIFY grabbingChanged)
+    Q_PROPERTY(int decodingPriority READ decodingPriority WRITE setDecodingPriority NOTIFY decodingPriorityChanged)
+    Q_PROPERTY(QString decodingCpus READ decodingCpus WRITE setDecodingCpus NOTIFY decodingCpusChanged)
+    Q_PROPERTY(QVariantMap formatOptions READ formatOptions WRITE setFormatOptions NOTIFY formatOptionsChanged)
+    Q_PROPERTY(QVariantMap decodingStats READ decodingStats NOTIFY decodingStatsChanged)
     Q_ENUMS(ScanState)
 
     class Private;
@@ -74,6 +78,27 @@ public:
 
     bool grabbing() const;
 
+    int decodingPriority() const;
+    void setDecodingPriority(int aNice);
+
+    QString decodingCpus() const;
+    void setDecodingCpus(QString aCpus);
+
+    // See Decoder::setFormatOptions()
+    QVariantMap formatOptions() const;
+    void setFormatOptions(QVariantMap aOptions);
+
+    // Counters of the current (or last) scan, updated after each frame:
+    //
+    //   frames: number of frames processed
+    //   wallMs: total decoding time
+    //   cpuMs:  total CPU time of the decoding thread
+    //   nice:   nice value of the decoding thread
+    //   cpu:    CPU which has processed the last frame
+    //   cpus:   CPUs the decoding thread is allowed to run on
+    //   cost:   map of tactic names to average time (ms) per frame
+    QVariantMap decodingStats() const;
+
 Q_SIGNALS:
     void decodingFinished(QImage image, QVariantMap result);
     void viewFinderItemChanged();
@@ -82,6 +107,10 @@ Q_SIGNALS:
     void rotationChanged();
     void scanStateChanged();
     void grabbingChanged();
+    void decodingPriorityChanged();
+    void decodingCpusChanged();
+    void formatOptionsChanged();
+    void decodingStatsChanged();
 
 private:
     Private* iPrivate;
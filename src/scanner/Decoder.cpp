@@ -28,12 +28,26 @@ THE SOFTWARE.
 #include "HarbourDebug.h"
 
 #include <QAtomicInt>
+#include <QPainter>
+#include <QTransform>
+
+#if HARBOUR_DEBUG
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QMultiMap>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QThreadPool>
+#endif // HARBOUR_DEBUG
 
 #include <zxing/DecodeHints.h>
 #include <zxing/MultiFormatReader.h>
 #include <zxing/Binarizer.h>
 #include <zxing/BinaryBitmap.h>
 #include <zxing/common/GlobalHistogramBinarizer.h>
+#include <zxing/common/HybridBinarizer.h>
+#include <zxing/common/AdaptiveBinarizer.h>
 
 // ==========================================================================
 // Decoder::Result::Private
@@ -127,6 +141,52 @@ QString Decoder::Result::getFormatName() const
     return iPrivate ? iPrivate->iFormatName : QString();
 }
 
+#if HARBOUR_DEBUG
+
+// ==========================================================================
+// Decoder::SaveTask
+//
+// Writes a slow input to disk (and removes the ones it pushed out of the
+// list) on a pool thread, so that the decoding thread never waits for
+// the file system and the next frame gets timed fairly.
+// ==========================================================================
+
+class Decoder::SaveTask : public QRunnable {
+public:
+    SaveTask(QImage aImage, QDir aDir, QString aFile, QStringList aObsolete);
+    void run() Q_DECL_OVERRIDE;
+
+public:
+    QImage iImage;
+    QDir iDir;
+    QString iFile;
+    QStringList iObsolete;
+};
+
+Decoder::SaveTask::SaveTask(QImage aImage, QDir aDir, QString aFile,
+    QStringList aObsolete) :
+    iImage(aImage),
+    iDir(aDir),
+    iFile(aFile),
+    iObsolete(aObsolete)
+{
+}
+
+void Decoder::SaveTask::run()
+{
+    if (iImage.save(iDir.filePath(iFile), "PGM")) {
+        HDEBUG("saved" << qPrintable(iFile));
+    } else {
+        HWARN("Failed to save" << qPrintable(iFile));
+    }
+    for (int i = 0; i < iObsolete.count(); i++) {
+        HDEBUG("removing" << qPrintable(iObsolete.at(i)));
+        iDir.remove(iObsolete.at(i));
+    }
+}
+
+#endif // HARBOUR_DEBUG
+
 // ==========================================================================
 // Decoder::Private
 // ==========================================================================
@@ -136,31 +196,256 @@ public:
     Private();
     ~Private();
 
-    zxing::Ref<zxing::Result> decode(zxing::Ref<zxing::LuminanceSource> aSource);
+    zxing::Ref<zxing::LuminanceSource> source(QImage aImage);
+    zxing::Ref<zxing::Result> decode(zxing::Ref<zxing::LuminanceSource> aSource, Tactic aTactic);
+    Result decode(zxing::Ref<zxing::LuminanceSource> aSource, Tactic aTactic, const QTransform& aTransform);
+    static QImage rotate(QImage aImage, int aDegrees, QTransform* aTransform);
+    static void applyFormatOptions(zxing::DecodeHints* aHints, QVariantMap aOptions);
+
+#if HARBOUR_DEBUG
+    void recordTime(zxing::Ref<zxing::LuminanceSource> aSource, int aMillis);
+    static QImage toImage(zxing::Ref<zxing::LuminanceSource> aSource);
+#endif // HARBOUR_DEBUG
 
 public:
     zxing::MultiFormatReader* iReader;
     zxing::DecodeHints iHints;
+    // Separate reader so that the two don't keep resetting each other
+    zxing::MultiFormatReader* iTryHarderReader;
+    zxing::DecodeHints iTryHarderHints;
+    // Gray rows of the last image, shared by the tactics applied to it
+    qint64 iSourceKey;
+    zxing::Ref<zxing::LuminanceSource> iSource;
+
+#if HARBOUR_DEBUG
+    // In debug build, the slowest inputs are saved as PGM files to
+    // ~/Pictures/codereader/slow if such directory exists. Files are
+    // named after the decoding time and survive restarts, so the worst
+    // cases keep accumulating while the app is being used. Any of them
+    // can be copied to ~/Pictures/codereader/debug_input.bmp to have it
+    // decoded again (see BarcodeScanner).
+    static const int MaxSlowInputs = 16;
+    QDir iSlowDir;
+    QMultiMap<int,QString> iSlowInputs; // Decoding time => file name
+    QThreadPool iSaveThreadPool; // One thread, to keep saves and removals in order
+    qint64 iTotalTime;
+    int iMaxTime;
+    int iCount;
+#endif // HARBOUR_DEBUG
 };
 
 Decoder::Private::Private() :
     iReader(new zxing::MultiFormatReader),
-    iHints(zxing::DecodeHints::DEFAULT_HINT)
+    iHints(zxing::DecodeHints::DEFAULT_HINT),
+    iTryHarderReader(new zxing::MultiFormatReader),
+    iTryHarderHints(zxing::DecodeHints::DEFAULT_HINT),
+    iSourceKey(0)
+#if HARBOUR_DEBUG
+   ,iSlowDir(QStandardPaths::writableLocation(QStandardPaths::PicturesLocation) +
+        "/codereader/slow"),
+    iTotalTime(0),
+    iMaxTime(0),
+    iCount(0)
+#endif // HARBOUR_DEBUG
 {
+    // Deconvolution only kicks in for rows that look like a smeared 1D
+    // barcode, so it costs next to nothing for anything else
+    iHints.setMotionDeblur(true);
+    iTryHarderHints.setMotionDeblur(true);
+    iTryHarderHints.setTryHarder(true);
+#if HARBOUR_DEBUG
+    iSaveThreadPool.setMaxThreadCount(1);
+    if (iSlowDir.exists()) {
+        const QStringList files(iSlowDir.entryList(QStringList("slow_*.pgm"), QDir::Files));
+        for (int i = 0; i < files.count(); i++) {
+            // slow_<ms>ms_<timestamp>.pgm
+            const QString& file(files.at(i));
+            bool ok = false;
+            const int ms = file.section('_', 1, 1).remove("ms").toInt(&ok);
+            if (ok) {
+                iSlowInputs.insert(ms, file);
+            }
+        }
+        HDEBUG(iSlowInputs.count() << "slow input(s) in" << qPrintable(iSlowDir.path()));
+    }
+#endif // HARBOUR_DEBUG
 }
 
 Decoder::Private::~Private()
 {
     delete iReader;
+    delete iTryHarderReader;
 }
 
-zxing::Ref<zxing::Result> Decoder::Private::decode(zxing::Ref<zxing::LuminanceSource> aSource)
+zxing::Ref<zxing::LuminanceSource> Decoder::Private::source(QImage aImage)
 {
-    zxing::Ref<zxing::Binarizer> binarizer(new zxing::GlobalHistogramBinarizer(aSource));
+    const qint64 key = aImage.cacheKey();
+    if (!iSource || iSourceKey != key) {
+        iSource = new ImageSource(aImage);
+        iSourceKey = key;
+    }
+    return iSource;
+}
+
+zxing::Ref<zxing::Result> Decoder::Private::decode(zxing::Ref<zxing::LuminanceSource> aSource,
+    Tactic aTactic)
+{
+    zxing::Ref<zxing::Binarizer> binarizer;
+    switch (aTactic) {
+    case TacticInverted:
+        binarizer = new zxing::GlobalHistogramBinarizer(aSource->invert());
+        break;
+    case TacticHybrid:
+    case TacticTryHarder:
+        binarizer = new zxing::HybridBinarizer(aSource);
+        break;
+    case TacticAdaptive:
+        binarizer = new zxing::AdaptiveBinarizer(aSource);
+        break;
+    default:
+        binarizer = new zxing::GlobalHistogramBinarizer(aSource);
+        break;
+    }
     zxing::Ref<zxing::BinaryBitmap> bitmap(new zxing::BinaryBitmap(binarizer));
-    return iReader->decode(bitmap, iHints);
+    if (aTactic == TacticTryHarder) {
+        return iTryHarderReader->decode(bitmap, iTryHarderHints);
+    } else {
+        return iReader->decode(bitmap, iHints);
+    }
+}
+
+Decoder::Result Decoder::Private::decode(zxing::Ref<zxing::LuminanceSource> aSource,
+    Tactic aTactic, const QTransform& aTransform)
+{
+#if HARBOUR_DEBUG
+    QElapsedTimer timer;
+    timer.start();
+#endif // HARBOUR_DEBUG
+    zxing::Ref<zxing::Result> result;
+    try {
+        result = decode(aSource, aTactic);
+    } catch (zxing::Exception& e) {
+        HDEBUG("Exception:" << e.what());
+    }
+#if HARBOUR_DEBUG
+    recordTime(aSource, (int)timer.elapsed());
+#endif // HARBOUR_DEBUG
+
+    if (result) {
+        QList<QPointF> points;
+        zxing::ArrayRef<zxing::Ref<zxing::ResultPoint> > found(result->getResultPoints());
+        for (int i = 0; i < found->size(); i++) {
+            const zxing::ResultPoint& point(*(found[i]));
+            points.append(aTransform.map(QPointF(point.getX(), point.getY())));
+        }
+
+        const std::string& text = result->getText()->getText();
+        return Result(QString::fromUtf8(text.c_str(), text.length()), points,
+            result->getBarcodeFormat());
+    } else {
+        return Result();
+    }
+}
+
+// Rotates the image around its center onto a white canvas large enough
+// to hold it. Returns the transformation from aImage coordinates to the
+// rotated image coordinates.
+QImage Decoder::Private::rotate(QImage aImage, int aDegrees, QTransform* aTransform)
+{
+    QTransform rotation;
+    rotation.rotate(aDegrees);
+    const QRect rect(rotation.mapRect(QRectF(aImage.rect())).toAlignedRect());
+    const QTransform transform(rotation * QTransform::fromTranslate(-rect.x(), -rect.y()));
+    QImage rotated(rect.size(), QImage::Format_RGB32);
+    rotated.fill(Qt::white);
+    QPainter painter(&rotated);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setTransform(transform);
+    painter.drawImage(0, 0, aImage);
+    painter.end();
+    *aTransform = transform;
+    return rotated;
+}
+
+void Decoder::Private::applyFormatOptions(zxing::DecodeHints* aHints,
+    QVariantMap aOptions)
+{
+    static const zxing::BarcodeFormat::Value formats[] = {
+        zxing::BarcodeFormat::ITF,
+        zxing::BarcodeFormat::CODE_39,
+        zxing::BarcodeFormat::CODABAR
+    };
+    for (uint i = 0; i < sizeof(formats)/sizeof(formats[0]); i++) {
+        const zxing::BarcodeFormat::Value format = formats[i];
+        const QString name(QLatin1String(zxing::BarcodeFormat::barcodeFormatNames[format]));
+        const QVariantMap options(aOptions.value(name).toMap());
+        const QVariantList list(options.value("lengths").toList());
+        std::vector<int> lengths;
+        for (int k = 0; k < list.count(); k++) {
+            bool ok = false;
+            const int length = list.at(k).toInt(&ok);
+            if (ok && length > 0) {
+                lengths.push_back(length);
+            }
+        }
+        aHints->setAllowedLengths(format, lengths);
+        if (format == zxing::BarcodeFormat::CODE_39) {
+            aHints->setAssumeCode39CheckDigit(options.value("checkDigit").toBool());
+        }
+    }
 }
 
+#if HARBOUR_DEBUG
+
+void Decoder::Private::recordTime(zxing::Ref<zxing::LuminanceSource> aSource, int aMillis)
+{
+    iCount++;
+    iTotalTime += aMillis;
+    if (iMaxTime < aMillis) {
+        iMaxTime = aMillis;
+    }
+    HDEBUG("decoding took" << aMillis << "ms, average" << (iTotalTime / iCount) <<
+        "ms, worst" << iMaxTime << "ms");
+
+    if (iSlowDir.exists() && (iSlowInputs.count() < MaxSlowInputs ||
+        aMillis > iSlowInputs.begin().key())) {
+        const QString file(QString("slow_%1ms_%2.pgm").arg(aMillis, 5, 10, QChar('0')).
+            arg(QDateTime::currentMSecsSinceEpoch()));
+        QStringList obsolete;
+        iSlowInputs.insert(aMillis, file);
+        while (iSlowInputs.count() > MaxSlowInputs) {
+            // Drop the fastest one
+            QMultiMap<int,QString>::iterator fastest(iSlowInputs.begin());
+            obsolete.append(fastest.value());
+            iSlowInputs.erase(fastest);
+        }
+        // The copy is cheap, writing it out is left to another thread
+        iSaveThreadPool.start(new SaveTask(toImage(aSource),
+            iSlowDir, file, obsolete));
+    }
+}
+
+QImage Decoder::Private::toImage(zxing::Ref<zxing::LuminanceSource> aSource)
+{
+    const int w = aSource->getWidth();
+    const int h = aSource->getHeight();
+    QImage image(w, h, QImage::Format_Indexed8);
+    QVector<QRgb> colors;
+    colors.reserve(256);
+    for (int i = 0; i < 256; i++) {
+        colors.append(qRgb(i, i, i));
+    }
+    image.setColorTable(colors);
+    zxing::ArrayRef<zxing::byte> row(w);
+    for (int y = 0; y < h; y++) {
+        row = aSource->getRow(y, row);
+        memcpy(image.scanLine(y), &row[0], w);
+    }
+    return image;
+}
+
+#endif // HARBOUR_DEBUG
+
 // ==========================================================================
 // Decoder
 // ==========================================================================
@@ -174,29 +459,46 @@ Decoder::~Decoder()
     delete iPrivate;
 }
 
-Decoder::Result Decoder::decode(QImage aImage)
+Decoder::Result Decoder::decode(QImage aImage, Tactic aTactic)
 {
-    zxing::Ref<zxing::LuminanceSource> source(new ImageSource(aImage));
-    return decode(source);
+    switch (aTactic) {
+    case TacticRotated:
+    case TacticRotated45:
+        {
+            QTransform transform;
+            QImage rotated(Private::rotate(aImage, (aTactic == TacticRotated) ?
+                90 : 45, &transform));
+            zxing::Ref<zxing::LuminanceSource> source(new ImageSource(rotated));
+            return iPrivate->decode(source, TacticDefault, transform.inverted());
+        }
+    default:
+        return iPrivate->decode(iPrivate->source(aImage), aTactic, QTransform());
+    }
 }
 
 Decoder::Result Decoder::decode(zxing::Ref<zxing::LuminanceSource> aSource)
 {
-    try {
-        zxing::Ref<zxing::Result> result(iPrivate->decode(aSource));
+    return iPrivate->decode(aSource, TacticDefault, QTransform());
+}
 
-        QList<QPointF> points;
-        zxing::ArrayRef<zxing::Ref<zxing::ResultPoint> > found(result->getResultPoints());
-        for (int i = 0; i < found->size(); i++) {
-            const zxing::ResultPoint& point(*(found[i]));
-            points.append(QPointF(point.getX(), point.getY()));
-        }
+void Decoder::setFormatOptions(QVariantMap aOptions)
+{
+    // Readers get recreated on the next decode() if anything has changed
+    Private::applyFormatOptions(&iPrivate->iHints, aOptions);
+    Private::applyFormatOptions(&iPrivate->iTryHarderHints, aOptions);
+}
 
-        const std::string& text = result->getText()->getText();
-        return Result(QString::fromUtf8(text.c_str(), text.length()), points,
-            result->getBarcodeFormat());
-    } catch (zxing::Exception& e) {
-        HDEBUG("Exception:" << e.what());
-        return Result();
+const char* Decoder::tacticName(Tactic aTactic)
+{
+    switch (aTactic) {
+    case TacticDefault: return "default";
+    case TacticRotated: return "rotated";
+    case TacticInverted: return "inverted";
+    case TacticHybrid: return "hybrid";
+    case TacticAdaptive: return "adaptive";
+    case TacticRotated45: return "rotated45";
+    case TacticTryHarder: return "tryharder";
+    case TacticCount: break;
     }
+    return "unknown";
 }
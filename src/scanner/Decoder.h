@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <QPoint>
 #include <QString>
 #include <QMetaType>
+#include <QVariantMap>
 
 #include <zxing/BarcodeFormat.h>
 #include <zxing/LuminanceSource.h>
@@ -40,14 +41,36 @@ class Decoder {
 public:
     class Result;
 
+    // Different ways of looking at the same image, cheapest first
+    enum Tactic {
+        TacticDefault,      // Global histogram binarizer
+        TacticRotated,      // Same, rotated by 90 degrees (1D codes)
+        TacticInverted,     // Light code on dark background
+        TacticHybrid,       // Local thresholds (uneven lighting)
+        TacticAdaptive,     // Per-pixel local mean (steep gradients)
+        TacticRotated45,    // Same as default, rotated by 45 degrees
+        TacticTryHarder,    // Hybrid binarizer, every row, all formats
+        TacticCount
+    };
+
     Decoder();
     ~Decoder();
 
-    Result decode(QImage aImage);
+    // Result points are in aImage coordinates, whatever the tactic
+    Result decode(QImage aImage, Tactic aTactic = TacticDefault);
     Result decode(zxing::Ref<zxing::LuminanceSource> aSource);
 
+    // Per-format options, keyed by format name:
+    // { "ITF": { "lengths": [ 14 ] }, "CODE_39": { "checkDigit": true } }
+    // Lengths apply to ITF, CODE_39 and CODABAR, and count the characters
+    // of the decoded text. Empty map removes all restrictions.
+    void setFormatOptions(QVariantMap aOptions);
+
+    static const char* tacticName(Tactic aTactic);
+
 private:
     class Private;
+    class SaveTask;
     Private* iPrivate;
 };
 
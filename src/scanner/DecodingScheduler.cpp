@@ -0,0 +1,198 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "DecodingScheduler.h"
+
+#include "HarbourDebug.h"
+
+#include <string.h>
+
+// ==========================================================================
+// DecodingScheduler::Private
+// ==========================================================================
+
+class DecodingScheduler::Private {
+public:
+    // Tactics other than the default and rotated ones, in the order
+    // of escalation
+    static const Decoder::Tactic Escalation[];
+    static const int EscalationCount;
+
+    // Expected cost relative to the default tactic, until measured
+    static const int RelativeCost[Decoder::TacticCount];
+
+    // Scene signature is the average brightness of SignatureSize^2
+    // blocks. If they differ on average by more than SceneChangeLimit
+    // between frames, something else is in front of the camera.
+    static const int SignatureSize = 16;
+    static const int SceneChangeLimit = 12;
+
+    Private(int aBudgetMs);
+
+    int cost(Decoder::Tactic aTactic) const;
+    bool sceneChanged(QImage aImage);
+
+public:
+    const int iBudget;
+    int iCost[Decoder::TacticCount]; // Running average, zero if unknown
+    int iNext;                       // Index in Escalation[]
+    QByteArray iSignature;
+};
+
+const Decoder::Tactic DecodingScheduler::Private::Escalation[] = {
+    Decoder::TacticInverted,
+    Decoder::TacticHybrid,
+    Decoder::TacticAdaptive,
+    Decoder::TacticRotated45,
+    Decoder::TacticTryHarder
+};
+
+const int DecodingScheduler::Private::EscalationCount =
+    sizeof(Escalation)/sizeof(Escalation[0]);
+
+const int DecodingScheduler::Private::RelativeCost[Decoder::TacticCount] = {
+    1,  // TacticDefault
+    1,  // TacticRotated
+    1,  // TacticInverted
+    2,  // TacticHybrid
+    3,  // TacticAdaptive
+    3,  // TacticRotated45
+    4   // TacticTryHarder
+};
+
+DecodingScheduler::Private::Private(int aBudgetMs) :
+    iBudget(aBudgetMs),
+    iNext(0)
+{
+    memset(iCost, 0, sizeof(iCost));
+}
+
+int DecodingScheduler::Private::cost(Decoder::Tactic aTactic) const
+{
+    if (iCost[aTactic]) {
+        return iCost[aTactic];
+    } else if (iCost[Decoder::TacticDefault]) {
+        return iCost[Decoder::TacticDefault] * RelativeCost[aTactic];
+    } else {
+        // Nothing is known yet
+        return RelativeCost[aTactic];
+    }
+}
+
+bool DecodingScheduler::Private::sceneChanged(QImage aImage)
+{
+    const QImage thumb(aImage.scaled(SignatureSize, SignatureSize,
+        Qt::IgnoreAspectRatio, Qt::SmoothTransformation).
+        convertToFormat(QImage::Format_RGB32));
+    QByteArray signature(SignatureSize * SignatureSize, 0);
+    uchar* ptr = (uchar*)signature.data();
+    for (int y = 0; y < SignatureSize; y++) {
+        const QRgb* pixels = (const QRgb*)thumb.constScanLine(y);
+        for (int x = 0; x < SignatureSize; x++) {
+            const QRgb rgb = *pixels++;
+            // Same as in ImageSource
+            *ptr++ = (uchar)((((rgb & 0x00ff0000) >> 16) +
+                ((rgb & 0x0000ff00) >> 8) + (rgb & 0xff))/3);
+        }
+    }
+
+    bool changed = false;
+    if (iSignature.size() == signature.size()) {
+        const uchar* prev = (const uchar*)iSignature.constData();
+        const uchar* next = (const uchar*)signature.constData();
+        const int n = signature.size();
+        int diff = 0;
+        for (int i = 0; i < n; i++) {
+            diff += qAbs((int)prev[i] - (int)next[i]);
+        }
+        changed = (diff > SceneChangeLimit * n);
+    }
+    iSignature = signature;
+    return changed;
+}
+
+// ==========================================================================
+// DecodingScheduler
+// ==========================================================================
+
+DecodingScheduler::DecodingScheduler(int aBudgetMs) :
+    iPrivate(new Private(aBudgetMs))
+{
+}
+
+DecodingScheduler::~DecodingScheduler()
+{
+    delete iPrivate;
+}
+
+int DecodingScheduler::budget() const
+{
+    return iPrivate->iBudget;
+}
+
+QList<Decoder::Tactic> DecodingScheduler::plan(QImage aImage)
+{
+    if (iPrivate->sceneChanged(aImage) && iPrivate->iNext) {
+        HDEBUG("scene changed, starting over");
+        iPrivate->iNext = 0;
+    }
+
+    // The default and rotated tactics are tried on every frame, as they
+    // always have been. Then at least one escalation and more as long
+    // as they fit.
+    QList<Decoder::Tactic> tactics;
+    tactics.append(Decoder::TacticDefault);
+    tactics.append(Decoder::TacticRotated);
+    int total = iPrivate->cost(Decoder::TacticDefault) +
+        iPrivate->cost(Decoder::TacticRotated);
+    const int n = Private::EscalationCount;
+    int i;
+    for (i = 0; i < n; i++) {
+        const Decoder::Tactic tactic = Private::Escalation[(iPrivate->iNext + i) % n];
+        const int cost = iPrivate->cost(tactic);
+        if (i > 0 && (total + cost) > iPrivate->iBudget) {
+            break;
+        }
+        tactics.append(tactic);
+        total += cost;
+    }
+    iPrivate->iNext = (iPrivate->iNext + i) % n;
+    return tactics;
+}
+
+void DecodingScheduler::done(Decoder::Tactic aTactic, int aMillis, bool aDecoded)
+{
+    int& cost = iPrivate->iCost[aTactic];
+    const int ms = qMax(aMillis, 1);
+    cost = cost ? ((3 * cost + ms) / 4) : ms;
+    if (aDecoded) {
+        HDEBUG("decoded with" << Decoder::tacticName(aTactic) << "tactic in" <<
+            aMillis << "ms");
+    }
+}
+
+int DecodingScheduler::cost(Decoder::Tactic aTactic) const
+{
+    return iPrivate->iCost[aTactic];
+}
@@ -0,0 +1,62 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef DECODING_SCHEDULER_H
+#define DECODING_SCHEDULER_H
+
+#include "Decoder.h"
+
+#include <QImage>
+#include <QList>
+
+// Decides which Decoder tactics to apply to each frame. The default
+// and rotated tactics are tried on every frame, the others take turns
+// on successive frames for as long as the camera keeps looking at the
+// same scene, as many per frame as fit into the time budget. When the
+// scene changes, it starts over with the cheap ones.
+class DecodingScheduler {
+    Q_DISABLE_COPY(DecodingScheduler)
+
+public:
+    DecodingScheduler(int aBudgetMs);
+    ~DecodingScheduler();
+
+    int budget() const;
+
+    // Tactics to try on this frame, in that order
+    QList<Decoder::Tactic> plan(QImage aImage);
+
+    // Reports how long the tactic took and whether it worked
+    void done(Decoder::Tactic aTactic, int aMillis, bool aDecoded);
+
+    // Measured running average in milliseconds, zero if the tactic
+    // hasn't been tried yet
+    int cost(Decoder::Tactic aTactic) const;
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // DECODING_SCHEDULER_H
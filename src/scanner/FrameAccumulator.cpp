@@ -0,0 +1,373 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "FrameAccumulator.h"
+
+#include "HarbourDebug.h"
+
+#include <zxing/common/GlobalHistogramBinarizer.h>
+#include <zxing/NotFoundException.h>
+
+#include <QVector>
+
+#include <limits.h>
+#include <string.h>
+
+// ==========================================================================
+// FrameAccumulator::Private
+// ==========================================================================
+
+class FrameAccumulator::Private {
+public:
+    // Registration first looks for the shift on the plane downscaled
+    // by this factor, within MaxShift pixels in each direction, then
+    // refines it at full resolution.
+    static const int Downscale = 4;
+    static const int MaxShift = 4;
+    static const int RefineShift = 2;
+    // Mean absolute difference after alignment, above which the frame
+    // is considered to show something else. Dim frames don't have much
+    // contrast to begin with.
+    static const int SceneChangeLimit = 8;
+    // The average is handed out after that many dim frames in a row
+    static const int MinDimFrames = 2;
+    // Fractional bits of the running average
+    static const int Precision = 4;
+
+    Private(int aMaxFrames);
+
+    static bool isDim(QImage aImage);
+    static void downscale(const uchar* aSrc, int aWidth, int aHeight, uchar* aDest);
+
+    void reset();
+    void toGray(QImage aImage);
+    bool align(int& aDx, int& aDy);
+    void shift(int aDx, int aDy);
+    void accumulate();
+    void update();
+    QImage image() const;
+
+public:
+    const int iMaxFrames;
+    int iWidth;
+    int iHeight;
+    int iFrames;        // Number of frames in the average
+    int iDimFrames;     // Dim frames in a row
+    QVector<uchar> iGray;       // The frame being added
+    QVector<uchar> iAverage;    // Rounded iSum
+    QVector<uchar> iPlane;      // iGray downscaled
+    QVector<uchar> iRefPlane;   // iAverage downscaled
+    QVector<quint16> iSum;      // Running average << Precision
+    QVector<quint16> iTmp;
+};
+
+FrameAccumulator::Private::Private(int aMaxFrames) :
+    iMaxFrames(qMax(aMaxFrames, 2)),
+    iWidth(0),
+    iHeight(0),
+    iFrames(0),
+    iDimFrames(0)
+{
+}
+
+void FrameAccumulator::Private::reset()
+{
+    iFrames = 0;
+    iDimFrames = 0;
+}
+
+// Runs a sparse sample of the frame through the same dynamic range
+// check that GlobalHistogramBinarizer applies to the whole thing
+bool FrameAccumulator::Private::isDim(QImage aImage)
+{
+    const int bits = zxing::GlobalHistogramBinarizer::LUMINANCE_SHIFT;
+    zxing::ArrayRef<int> buckets(zxing::GlobalHistogramBinarizer::LUMINANCE_BUCKETS);
+    const int w = aImage.width();
+    const int h = aImage.height();
+    for (int y = 0; y < h; y += Downscale) {
+        const QRgb* pixels = (const QRgb*)aImage.constScanLine(y);
+        for (int x = 0; x < w; x += Downscale) {
+            const QRgb rgb = pixels[x];
+            // Same as in ImageSource
+            const int gray = (((rgb & 0x00ff0000) >> 16) +
+                ((rgb & 0x0000ff00) >> 8) + (rgb & 0xff))/3;
+            buckets[gray >> bits]++;
+        }
+    }
+    try {
+        zxing::GlobalHistogramBinarizer::estimateBlackPoint(buckets);
+        return false;
+    } catch (zxing::NotFoundException&) {
+        return true;
+    }
+}
+
+void FrameAccumulator::Private::downscale(const uchar* aSrc, int aWidth,
+    int aHeight, uchar* aDest)
+{
+    const int w = aWidth / Downscale;
+    const int h = aHeight / Downscale;
+    for (int y = 0; y < h; y++) {
+        const uchar* src = aSrc + y * Downscale * aWidth;
+        for (int x = 0; x < w; x++) {
+            int sum = 0;
+            for (int i = 0; i < Downscale; i++) {
+                const uchar* row = src + i * aWidth + x * Downscale;
+                for (int j = 0; j < Downscale; j++) {
+                    sum += row[j];
+                }
+            }
+            *aDest++ = (uchar)(sum / (Downscale * Downscale));
+        }
+    }
+}
+
+void FrameAccumulator::Private::toGray(QImage aImage)
+{
+    if (iWidth != aImage.width() || iHeight != aImage.height()) {
+        iWidth = aImage.width();
+        iHeight = aImage.height();
+        const int n = iWidth * iHeight;
+        const int pn = (iWidth / Downscale) * (iHeight / Downscale);
+        iGray.resize(n);
+        iAverage.resize(n);
+        iSum.resize(n);
+        iTmp.resize(n);
+        iPlane.resize(pn);
+        iRefPlane.resize(pn);
+        reset();
+    }
+    uchar* gray = iGray.data();
+    for (int y = 0; y < iHeight; y++) {
+        const QRgb* pixels = (const QRgb*)aImage.constScanLine(y);
+        for (int x = 0; x < iWidth; x++) {
+            const QRgb rgb = *pixels++;
+            *gray++ = (uchar)((((rgb & 0x00ff0000) >> 16) +
+                ((rgb & 0x0000ff00) >> 8) + (rgb & 0xff))/3);
+        }
+    }
+}
+
+// Finds the shift such that the new frame at (x,y) shows what the
+// average has at (x + aDx, y + aDy). Returns false if there's no such
+// shift, i.e. the camera is looking at something else.
+bool FrameAccumulator::Private::align(int& aDx, int& aDy)
+{
+    const int pw = iWidth / Downscale;
+    const int ph = iHeight / Downscale;
+    if (pw <= 2 * MaxShift || ph <= 2 * MaxShift) {
+        return false;
+    }
+    downscale(iGray.constData(), iWidth, iHeight, iPlane.data());
+
+    const uchar* plane = iPlane.constData();
+    const uchar* ref = iRefPlane.constData();
+    int best = INT_MAX, bestX = 0, bestY = 0;
+    for (int dy = -MaxShift; dy <= MaxShift; dy++) {
+        for (int dx = -MaxShift; dx <= MaxShift; dx++) {
+            int sad = 0;
+            for (int y = MaxShift; y < ph - MaxShift && sad < best; y++) {
+                const uchar* p = plane + y * pw;
+                const uchar* r = ref + (y + dy) * pw + dx;
+                for (int x = MaxShift; x < pw - MaxShift; x++) {
+                    sad += qAbs((int)p[x] - (int)r[x]);
+                }
+            }
+            if (sad < best) {
+                best = sad;
+                bestX = dx;
+                bestY = dy;
+            }
+        }
+    }
+    const int count = (pw - 2 * MaxShift) * (ph - 2 * MaxShift);
+    if (best > SceneChangeLimit * count) {
+        HDEBUG("scene changed," << best / count << "per pixel");
+        return false;
+    }
+
+    // Refine at full resolution, in the middle of the frame where the
+    // code is most likely to be
+    const uchar* gray = iGray.constData();
+    const uchar* avg = iAverage.constData();
+    const int cx = bestX * Downscale;
+    const int cy = bestY * Downscale;
+    const int margin = MaxShift * Downscale + RefineShift;
+    const int x0 = qMax(iWidth / 4, margin), x1 = qMin(iWidth * 3 / 4, iWidth - margin);
+    const int y0 = qMax(iHeight / 4, margin), y1 = qMin(iHeight * 3 / 4, iHeight - margin);
+    best = INT_MAX;
+    aDx = cx;
+    aDy = cy;
+    for (int dy = cy - RefineShift; dy <= cy + RefineShift; dy++) {
+        for (int dx = cx - RefineShift; dx <= cx + RefineShift; dx++) {
+            int sad = 0;
+            for (int y = y0; y < y1 && sad < best; y++) {
+                const uchar* p = gray + y * iWidth;
+                const uchar* r = avg + (y + dy) * iWidth + dx;
+                for (int x = x0; x < x1; x++) {
+                    sad += qAbs((int)p[x] - (int)r[x]);
+                }
+            }
+            if (sad < best) {
+                best = sad;
+                aDx = dx;
+                aDy = dy;
+            }
+        }
+    }
+    return true;
+}
+
+// Moves the average into the coordinates of the new frame. Whatever
+// comes in from outside is taken from the new frame.
+void FrameAccumulator::Private::shift(int aDx, int aDy)
+{
+    if (aDx || aDy) {
+        const quint16* sum = iSum.constData();
+        const uchar* gray = iGray.constData();
+        quint16* dest = iTmp.data();
+        for (int y = 0; y < iHeight; y++) {
+            const int sy = y + aDy;
+            for (int x = 0; x < iWidth; x++) {
+                const int sx = x + aDx;
+                *dest++ = (sy >= 0 && sy < iHeight && sx >= 0 && sx < iWidth) ?
+                    sum[sy * iWidth + sx] : (quint16)(gray[y * iWidth + x] << Precision);
+            }
+        }
+        iSum.swap(iTmp);
+    }
+}
+
+// Running average over the last iMaxFrames frames (give or take).
+// Straight integer arithmetic which the compiler can vectorize.
+void FrameAccumulator::Private::accumulate()
+{
+    const int n = iWidth * iHeight;
+    const uchar* gray = iGray.constData();
+    quint16* sum = iSum.data();
+    if (!iFrames) {
+        for (int i = 0; i < n; i++) {
+            sum[i] = (quint16)(gray[i] << Precision);
+        }
+        iFrames = 1;
+    } else {
+        const quint32 k = qMin(iFrames, iMaxFrames - 1);
+        const quint32 scale = 0x10000 / (k + 1);
+        for (int i = 0; i < n; i++) {
+            sum[i] = (quint16)(((sum[i] * k + (gray[i] << Precision)) * scale) >> 16);
+        }
+        iFrames = k + 1;
+    }
+}
+
+void FrameAccumulator::Private::update()
+{
+    const int n = iWidth * iHeight;
+    const quint16* sum = iSum.constData();
+    uchar* avg = iAverage.data();
+    for (int i = 0; i < n; i++) {
+        avg[i] = (uchar)((sum[i] + (1 << (Precision - 1))) >> Precision);
+    }
+    if (iRefPlane.size()) {
+        downscale(avg, iWidth, iHeight, iRefPlane.data());
+    }
+}
+
+// The average, with contrast stretched to the full range. A handful
+// of outliers on either end are clipped.
+QImage FrameAccumulator::Private::image() const
+{
+    const int n = iWidth * iHeight;
+    const uchar* avg = iAverage.constData();
+    int histogram[256];
+    memset(histogram, 0, sizeof(histogram));
+    for (int i = 0; i < n; i++) {
+        histogram[avg[i]]++;
+    }
+    const int clip = n / 200;
+    int low = 0, high = 255;
+    for (int count = 0; low < 255 && (count += histogram[low]) <= clip; low++);
+    for (int count = 0; high > 0 && (count += histogram[high]) <= clip; high--);
+
+    uchar map[256];
+    const int range = qMax(high - low, 1);
+    for (int v = 0; v < 256; v++) {
+        map[v] = (uchar)qBound(0, (v - low) * 255 / range, 255);
+    }
+
+    QImage img(iWidth, iHeight, QImage::Format_RGB32);
+    for (int y = 0; y < iHeight; y++) {
+        QRgb* pixels = (QRgb*)img.scanLine(y);
+        for (int x = 0; x < iWidth; x++) {
+            const int v = map[*avg++];
+            *pixels++ = qRgb(v, v, v);
+        }
+    }
+    return img;
+}
+
+// ==========================================================================
+// FrameAccumulator
+// ==========================================================================
+
+FrameAccumulator::FrameAccumulator(int aMaxFrames) :
+    iPrivate(new Private(aMaxFrames))
+{
+}
+
+FrameAccumulator::~FrameAccumulator()
+{
+    delete iPrivate;
+}
+
+void FrameAccumulator::reset()
+{
+    iPrivate->reset();
+}
+
+QImage FrameAccumulator::add(QImage aImage)
+{
+    if (aImage.depth() != 32) {
+        aImage = aImage.convertToFormat(QImage::Format_RGB32);
+    }
+
+    // Well lit frames are decoded as they are
+    if (!Private::isDim(aImage)) {
+        iPrivate->reset();
+        return QImage();
+    }
+
+    iPrivate->iDimFrames++;
+    iPrivate->toGray(aImage);
+    int dx = 0, dy = 0;
+    if (iPrivate->iFrames && !iPrivate->align(dx, dy)) {
+        iPrivate->iFrames = 0;
+    }
+    iPrivate->shift(dx, dy);
+    iPrivate->accumulate();
+    iPrivate->update();
+    HDEBUG(iPrivate->iFrames << "frame(s), shift" << dx << dy);
+    return (iPrivate->iDimFrames >= Private::MinDimFrames &&
+        iPrivate->iFrames > 1) ? iPrivate->image() : QImage();
+}
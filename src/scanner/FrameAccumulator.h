@@ -0,0 +1,54 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#ifndef FRAME_ACCUMULATOR_H
+#define FRAME_ACCUMULATOR_H
+
+#include <QImage>
+
+// Averages consecutive frames to bring the signal out of the sensor
+// noise in poor light. Each frame is registered against the previous
+// one (integer shift, found on a downsampled plane) so that a slightly
+// shaking hand doesn't smear the picture. The average is only handed
+// out once single frames have repeatedly failed the binarizer's
+// dynamic range check, i.e. when they are too dim to be decoded as
+// they are.
+class FrameAccumulator {
+    Q_DISABLE_COPY(FrameAccumulator)
+
+public:
+    FrameAccumulator(int aMaxFrames = 8);
+    ~FrameAccumulator();
+
+    // Adds the frame to the average. Returns the average if it's worth
+    // decoding, null image otherwise.
+    QImage add(QImage aImage);
+    void reset();
+
+private:
+    class Private;
+    Private* iPrivate;
+};
+
+#endif // FRAME_ACCUMULATOR_H
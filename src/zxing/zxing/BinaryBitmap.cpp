@@ -22,6 +22,7 @@ using zxing::BitArray;
 using zxing::BitMatrix;
 using zxing::LuminanceSource;
 using zxing::BinaryBitmap;
+using zxing::RunLengthDetector;
 
 // VC++
 using zxing::Binarizer;
@@ -37,7 +38,18 @@ Ref<BitArray> BinaryBitmap::getBlackRow(int y, Ref<BitArray> row) {
 }
 
 Ref<BitMatrix> BinaryBitmap::getBlackMatrix() {
-    return binarizer_->getBlackMatrix();
+    // Readers don't modify the matrix, binarize the image only once
+    if (matrix_.empty()) {
+        matrix_ = binarizer_->getBlackMatrix();
+    }
+    return matrix_;
+}
+
+Ref<RunLengthDetector> BinaryBitmap::getRunLengthDetector() {
+    if (runLengthDetector_.empty()) {
+        runLengthDetector_ = new RunLengthDetector(getBlackMatrix());
+    }
+    return runLengthDetector_;
 }
 
 int BinaryBitmap::getWidth() const {
@@ -24,12 +24,15 @@
 #include <zxing/common/BitMatrix.h>
 #include <zxing/common/BitArray.h>
 #include <zxing/Binarizer.h>
+#include <zxing/common/detector/RunLengthDetector.h>
 
 namespace zxing {
 	
 	class BinaryBitmap : public Counted {
 	private:
 		Ref<Binarizer> binarizer_;
+		Ref<BitMatrix> matrix_;
+		Ref<RunLengthDetector> runLengthDetector_;
 		
 	public:
 		BinaryBitmap(Ref<Binarizer> binarizer);
@@ -37,6 +40,7 @@ namespace zxing {
 		
 		Ref<BitArray> getBlackRow(int y, Ref<BitArray> row);
 		Ref<BitMatrix> getBlackMatrix();
+		Ref<RunLengthDetector> getRunLengthDetector();
 		
 		Ref<LuminanceSource> getLuminanceSource() const;
 
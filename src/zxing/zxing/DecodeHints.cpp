@@ -49,6 +49,9 @@ const zxing::DecodeHintType DecodeHints::UPC_EAN_EXTENSION_HINT = 1 << BarcodeFo
 const zxing::DecodeHintType DecodeHints::ASSUME_GS1 = 1 << BarcodeFormat::ASSUME_GS1;
 const zxing::DecodeHintType DecodeHints::TRYHARDER_HINT = 1 << 31;
 const zxing::DecodeHintType DecodeHints::CHARACTER_SET = 1 << 30;
+const zxing::DecodeHintType DecodeHints::ALLOWED_LENGTHS = 1 << 29;
+const zxing::DecodeHintType DecodeHints::ASSUME_CODE_39_CHECK_DIGIT = 1 << 28;
+const zxing::DecodeHintType DecodeHints::MOTION_DEBLUR_HINT = 1 << 27;
 
 const zxing::DecodeHints DecodeHints::PRODUCT_HINT(
   DecodeHints::UPC_A_HINT |
@@ -86,6 +89,7 @@ DecodeHints::DecodeHints(const zxing::DecodeHintType &init) {
 DecodeHints::DecodeHints(const DecodeHints &other) {
     hints = other.hints;
     callback = other.callback;
+    allowedLengths = other.allowedLengths;
 }
 
 void DecodeHints::addFormat(BarcodeFormat toadd) {
@@ -150,6 +154,54 @@ bool DecodeHints::getTryHarder() const {
   return (hints & TRYHARDER_HINT) != 0;
 }
 
+void DecodeHints::setMotionDeblur(bool toset) {
+  if (toset) {
+    hints |= MOTION_DEBLUR_HINT;
+  } else {
+    hints &= ~MOTION_DEBLUR_HINT;
+  }
+}
+
+bool DecodeHints::getMotionDeblur() const {
+  return (hints & MOTION_DEBLUR_HINT) != 0;
+}
+
+void DecodeHints::setAssumeCode39CheckDigit(bool toset) {
+  if (toset) {
+    hints |= ASSUME_CODE_39_CHECK_DIGIT;
+  } else {
+    hints &= ~ASSUME_CODE_39_CHECK_DIGIT;
+  }
+}
+
+bool DecodeHints::getAssumeCode39CheckDigit() const {
+  return (hints & ASSUME_CODE_39_CHECK_DIGIT) != 0;
+}
+
+void DecodeHints::setAllowedLengths(BarcodeFormat format, std::vector<int> const& lengths) {
+  if (lengths.empty()) {
+    allowedLengths.erase(format);
+  } else {
+    allowedLengths[format] = lengths;
+  }
+  if (allowedLengths.empty()) {
+    hints &= ~ALLOWED_LENGTHS;
+  } else {
+    hints |= ALLOWED_LENGTHS;
+  }
+}
+
+std::vector<int> const& DecodeHints::getAllowedLengths(BarcodeFormat format) const {
+  static const std::vector<int> none;
+  if (hints & ALLOWED_LENGTHS) {
+    std::map<int, std::vector<int> >::const_iterator it = allowedLengths.find(format);
+    if (it != allowedLengths.end()) {
+      return it->second;
+    }
+  }
+  return none;
+}
+
 void DecodeHints::setResultPointCallback(Ref<ResultPointCallback> const& _callback) {
   callback = _callback;
 }
@@ -162,14 +214,24 @@ zxing::DecodeHints &zxing::DecodeHints::operator =(const zxing::DecodeHints &oth
 {
     hints = other.hints;
     callback = other.callback;
+    allowedLengths = other.allowedLengths;
     return *this;
 }
 
+bool zxing::DecodeHints::operator ==(const zxing::DecodeHints &other) const
+{
+    return hints == other.hints &&
+        (ResultPointCallback*)callback == (ResultPointCallback*)other.callback &&
+        allowedLengths == other.allowedLengths;
+}
+
 zxing::DecodeHints zxing::operator | (DecodeHints const& l, DecodeHints const& r) {
   DecodeHints result (l);
   result.hints |= r.hints;
   if (!result.callback) {
     result.callback = r.callback;
   }
+  // Lengths on the left side take precedence
+  result.allowedLengths.insert(r.allowedLengths.begin(), r.allowedLengths.end());
   return result;
 }
@@ -22,6 +22,8 @@
 
 #include <zxing/BarcodeFormat.h>
 #include <zxing/ResultPointCallback.h>
+#include <map>
+#include <vector>
 
 namespace zxing {
 
@@ -33,6 +35,7 @@ class DecodeHints {
  private:
   DecodeHintType hints;
   Ref<ResultPointCallback> callback;
+  std::map<int, std::vector<int> > allowedLengths;
 
  public:
   static const DecodeHintType AZTEC_HINT;
@@ -56,8 +59,9 @@ class DecodeHints {
 
   static const DecodeHintType TRYHARDER_HINT;
   static const DecodeHintType CHARACTER_SET;
-  // static const DecodeHintType ALLOWED_LENGTHS = 1 << 29;
-  // static const DecodeHintType ASSUME_CODE_39_CHECK_DIGIT = 1 << 28;
+  static const DecodeHintType MOTION_DEBLUR_HINT;
+  static const DecodeHintType ALLOWED_LENGTHS;
+  static const DecodeHintType ASSUME_CODE_39_CHECK_DIGIT;
   // static const DecodeHintType NEED_RESULT_POINT_CALLBACK = 1 << 26;
   
   static const DecodeHints PRODUCT_HINT;
@@ -74,11 +78,23 @@ class DecodeHints {
   void clear() {hints=0;}
   void setTryHarder(bool toset);
   bool getTryHarder() const;
+  void setMotionDeblur(bool toset);
+  bool getMotionDeblur() const;
+  void setAssumeCode39CheckDigit(bool toset);
+  bool getAssumeCode39CheckDigit() const;
+
+  // Number of characters in the decoded text (not counting the check
+  // digit or the start/stop characters). Empty means no restriction
+  // (or the reader's own defaults, in case of ITF).
+  void setAllowedLengths(BarcodeFormat format, std::vector<int> const& lengths);
+  std::vector<int> const& getAllowedLengths(BarcodeFormat format) const;
 
   void setResultPointCallback(Ref<ResultPointCallback> const&);
   Ref<ResultPointCallback> getResultPointCallback() const;
 
   DecodeHints& operator =(DecodeHints const &other);
+  bool operator ==(DecodeHints const &other) const;
+  bool operator !=(DecodeHints const &other) const { return !(*this == other); }
 
   friend DecodeHints operator| (DecodeHints const&, DecodeHints const&);
 };
@@ -54,6 +54,10 @@ Ref<Result> MultiFormatReader::decodeWithState(Ref<BinaryBitmap> image) {
 }
 
 void MultiFormatReader::setHints(DecodeHints hints) {
+  // Keep the readers (and whatever they have cached) if nothing changed
+  if (!readers_.empty() && hints == hints_) {
+    return;
+  }
   hints_ = hints;
   readers_.clear();
   bool tryHarder = hints.getTryHarder();
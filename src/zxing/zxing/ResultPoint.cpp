@@ -34,14 +34,6 @@ ResultPoint::ResultPoint(int x, int y) : posX_(float(x)), posY_(float(y)) {}
   
 ResultPoint::~ResultPoint() {}
 
-float ResultPoint::getX() const {
-  return posX_;
-}
-    
-float ResultPoint::getY() const {
-  return posY_;
-}
-
 bool ResultPoint::equals(Ref<ResultPoint> other) {
   return posX_ == other->getX() && posY_ == other->getY();
 }
@@ -37,8 +37,8 @@ public:
   ResultPoint(int x, int y);
   virtual ~ResultPoint();
 
-  virtual float getX() const;
-  virtual float getY() const;
+  float getX() const { return posX_; }
+  float getY() const { return posY_; }
 
   bool equals(Ref<ResultPoint> other);
 
@@ -38,7 +38,7 @@ AztecReader::AztecReader() : decoder_() {
 }
         
 Ref<Result> AztecReader::decode(Ref<zxing::BinaryBitmap> image) {
-  Detector detector(image->getBlackMatrix());
+  Detector detector(image->getRunLengthDetector());
             
   Ref<AztecDetectorResult> detectorResult(detector.detect());
             
@@ -20,9 +20,6 @@
  */
 
 #include <zxing/aztec/decoder/Decoder.h>
-#ifndef NO_ICONV
-#include <iconv.h>
-#endif
 #include <iostream>
 #include <zxing/FormatException.h>
 #include <zxing/common/reedsolomon/ReedSolomonDecoder.h>
@@ -30,40 +27,22 @@
 #include <zxing/common/reedsolomon/GenericGF.h>
 #include <zxing/common/IllegalArgumentException.h>
 #include <zxing/common/DecoderResult.h>
-
-#include <qglobal.h>
+#include <zxing/common/CharacterSetDecoder.h>
 
 using zxing::aztec::Decoder;
 using zxing::DecoderResult;
 using zxing::String;
 using zxing::BitArray;
 using zxing::BitMatrix;
+using zxing::common::CharacterSetDecoder;
 using zxing::Ref;
 
 using std::string;
 
 namespace {
   void add(string& result, char character) {
-#ifndef NO_ICONV
-    char character2 = character & 0xff;
-    char s[] =  {character2};
-    char* ss = s;
-    size_t sl = sizeof(s);
-    char d[4];
-    char* ds = d;
-    size_t dl = sizeof(d);
-    iconv_t ic = iconv_open("UTF-8", "ISO-8859-1");
-#if defined(Q_OS_SYMBIAN)
-    iconv(ic, (const char**)&ss, &sl, &ds, &dl);
-#else
-    iconv(ic, (char**)&ss, &sl, &ds, &dl);
-#endif
-    iconv_close(ic);
-    d[sizeof(d)-dl] = 0;
-    result.append(d);
-#else
+    // Converted to UTF-8 by getEncodedData()
     result.push_back(character);
-#endif
   }
 
   const int NB_BITS_COMPACT[] = {
@@ -283,7 +262,7 @@ Ref<String> Decoder::getEncodedData(Ref<zxing::BitArray> correctedBits) {
                 
   }
             
-  return Ref<String>(new String(result));
+  return Ref<String>(new String(CharacterSetDecoder::toUTF8(result)));
             
 }
         
@@ -38,6 +38,9 @@ using zxing::ArrayRef;
 using zxing::ResultPoint;
 using zxing::BitArray;
 using zxing::BitMatrix;
+using zxing::RunLengthDetector;
+using zxing::ReaderException;
+using zxing::NotFoundException;
 using zxing::common::detector::MathUtils;
 
 Detector::Detector(Ref<BitMatrix> image):
@@ -47,11 +50,41 @@ Detector::Detector(Ref<BitMatrix> image):
   nbCenterLayers_(0) {
         
 }
+
+Detector::Detector(Ref<RunLengthDetector> runs):
+  image_(runs->getImage()),
+  runs_(runs),
+  nbLayers_(0),
+  nbDataBlocks_(0),
+  nbCenterLayers_(0) {
+
+}
         
 Ref<AztecDetectorResult> Detector::detect() {
-  Ref<Point> pCenter = getMatrixCenter();
-            
-  std::vector<Ref<Point> > bullEyeCornerPoints = getBullEyeCornerPoints(pCenter);
+  if (!runs_.empty()) {
+    // Try the bull's eyes found by the run-length scan first. The scan
+    // may miss a damaged or badly lit one, but searching from the center
+    // of the image is only worth it if the rings matched at least across
+    // and down somewhere. Otherwise there's nothing to find.
+    const vector<RunLengthDetector::BullsEye>& bullsEyes = runs_->getBullsEyes();
+    for (size_t i = 0; i < bullsEyes.size(); i++) {
+      const RunLengthDetector::BullsEye& bullsEye = bullsEyes[i];
+      try {
+        return detect(Point(MathUtils::round(bullsEye.x),
+                            MathUtils::round(bullsEye.y)));
+      } catch (ReaderException const& e) {
+        (void)e;
+      }
+    }
+    if (!runs_->getPartialRingCount()) {
+      throw NotFoundException("No bull's eye");
+    }
+  }
+  return detect(getMatrixCenter());
+}
+
+Ref<AztecDetectorResult> Detector::detect(Point const& pCenter) {
+  std::vector<Point> bullEyeCornerPoints = getBullEyeCornerPoints(pCenter);
             
   extractParameters(bullEyeCornerPoints);
   
@@ -69,7 +102,7 @@ Ref<AztecDetectorResult> Detector::detect() {
   return Ref<AztecDetectorResult>(new AztecDetectorResult(bits, corners, compact_, nbDataBlocks_, nbLayers_));
 }
         
-void Detector::extractParameters(std::vector<Ref<Point> > bullEyeCornerPoints) {
+void Detector::extractParameters(std::vector<Point> const& bullEyeCornerPoints) {
   int twoCenterLayers = 2 * nbCenterLayers_;
   // get the bits around the bull's eye
   Ref<BitArray> resab = sampleLine(bullEyeCornerPoints[0], bullEyeCornerPoints[1], twoCenterLayers+1);
@@ -136,29 +169,29 @@ void Detector::extractParameters(std::vector<Ref<Point> > bullEyeCornerPoints) {
 }
         
 ArrayRef< Ref<ResultPoint> >
-Detector::getMatrixCornerPoints(std::vector<Ref<Point> > bullEyeCornerPoints) {
+Detector::getMatrixCornerPoints(std::vector<Point> const& bullEyeCornerPoints) {
   float ratio = (2 * nbLayers_ + (nbLayers_ > 4 ? 1 : 0) + (nbLayers_ - 4) / 8) / (2.0f * nbCenterLayers_);
             
-  int dx = bullEyeCornerPoints[0]->getX() - bullEyeCornerPoints[2]->getX();
+  int dx = bullEyeCornerPoints[0].getX() - bullEyeCornerPoints[2].getX();
   dx += dx > 0 ? 1 : -1;
-  int dy = bullEyeCornerPoints[0]->getY() - bullEyeCornerPoints[2]->getY();
+  int dy = bullEyeCornerPoints[0].getY() - bullEyeCornerPoints[2].getY();
   dy += dy > 0 ? 1 : -1;
             
-  int targetcx = MathUtils::round(bullEyeCornerPoints[2]->getX() - ratio * dx);
-  int targetcy = MathUtils::round(bullEyeCornerPoints[2]->getY() - ratio * dy);
+  int targetcx = MathUtils::round(bullEyeCornerPoints[2].getX() - ratio * dx);
+  int targetcy = MathUtils::round(bullEyeCornerPoints[2].getY() - ratio * dy);
             
-  int targetax = MathUtils::round(bullEyeCornerPoints[0]->getX() + ratio * dx);
-  int targetay = MathUtils::round(bullEyeCornerPoints[0]->getY() + ratio * dy);
+  int targetax = MathUtils::round(bullEyeCornerPoints[0].getX() + ratio * dx);
+  int targetay = MathUtils::round(bullEyeCornerPoints[0].getY() + ratio * dy);
             
-  dx = bullEyeCornerPoints[1]->getX() - bullEyeCornerPoints[3]->getX();
+  dx = bullEyeCornerPoints[1].getX() - bullEyeCornerPoints[3].getX();
   dx += dx > 0 ? 1 : -1;
-  dy = bullEyeCornerPoints[1]->getY() - bullEyeCornerPoints[3]->getY();
+  dy = bullEyeCornerPoints[1].getY() - bullEyeCornerPoints[3].getY();
   dy += dy > 0 ? 1 : -1;
             
-  int targetdx = MathUtils::round(bullEyeCornerPoints[3]->getX() - ratio * dx);
-  int targetdy = MathUtils::round(bullEyeCornerPoints[3]->getY() - ratio * dy);
-  int targetbx = MathUtils::round(bullEyeCornerPoints[1]->getX() + ratio * dx);
-  int targetby = MathUtils::round(bullEyeCornerPoints[1]->getY() + ratio * dy);
+  int targetdx = MathUtils::round(bullEyeCornerPoints[3].getX() - ratio * dx);
+  int targetdy = MathUtils::round(bullEyeCornerPoints[3].getY() - ratio * dy);
+  int targetbx = MathUtils::round(bullEyeCornerPoints[1].getX() + ratio * dx);
+  int targetby = MathUtils::round(bullEyeCornerPoints[1].getY() + ratio * dy);
             
   if (!isValid(targetax, targetay) ||
       !isValid(targetbx, targetby) ||
@@ -225,19 +258,19 @@ void Detector::correctParameterData(Ref<zxing::BitArray> parameterData, bool com
   }
 }
         
-std::vector<Ref<Point> > Detector::getBullEyeCornerPoints(Ref<zxing::aztec::Point> pCenter) {
-  Ref<Point> pina = pCenter;
-  Ref<Point> pinb = pCenter;
-  Ref<Point> pinc = pCenter;
-  Ref<Point> pind = pCenter;
+std::vector<Point> Detector::getBullEyeCornerPoints(Point const& pCenter) {
+  Point pina = pCenter;
+  Point pinb = pCenter;
+  Point pinc = pCenter;
+  Point pind = pCenter;
             
   bool color = true;
             
   for (nbCenterLayers_ = 1; nbCenterLayers_ < 9; nbCenterLayers_++) {
-    Ref<Point> pouta = getFirstDifferent(pina, color, 1, -1);
-    Ref<Point> poutb = getFirstDifferent(pinb, color, 1, 1);
-    Ref<Point> poutc = getFirstDifferent(pinc, color, -1, 1);
-    Ref<Point> poutd = getFirstDifferent(pind, color, -1, -1);
+    Point pouta = getFirstDifferent(pina, color, 1, -1);
+    Point poutb = getFirstDifferent(pinb, color, 1, 1);
+    Point poutc = getFirstDifferent(pinc, color, -1, 1);
+    Point poutd = getFirstDifferent(pind, color, -1, -1);
             
     //d    a
     //
@@ -268,21 +301,21 @@ std::vector<Ref<Point> > Detector::getBullEyeCornerPoints(Ref<zxing::aztec::Poin
             
   float ratio = 0.75f*2 / (2*nbCenterLayers_-3);
             
-  int dx = pina->getX() - pind->getX();
-  int dy = pina->getY() - pinc->getY();
+  int dx = pina.getX() - pind.getX();
+  int dy = pina.getY() - pinc.getY();
             
-  int targetcx = MathUtils::round(pinc->getX() - ratio * dx);
-  int targetcy = MathUtils::round(pinc->getY() - ratio * dy);
-  int targetax = MathUtils::round(pina->getX() + ratio * dx);
-  int targetay = MathUtils::round(pina->getY() + ratio * dy);
+  int targetcx = MathUtils::round(pinc.getX() - ratio * dx);
+  int targetcy = MathUtils::round(pinc.getY() - ratio * dy);
+  int targetax = MathUtils::round(pina.getX() + ratio * dx);
+  int targetay = MathUtils::round(pina.getY() + ratio * dy);
             
-  dx = pinb->getX() - pind->getX();
-  dy = pinb->getY() - pind->getY();
+  dx = pinb.getX() - pind.getX();
+  dy = pinb.getY() - pind.getY();
             
-  int targetdx = MathUtils::round(pind->getX() - ratio * dx);
-  int targetdy = MathUtils::round(pind->getY() - ratio * dy);
-  int targetbx = MathUtils::round(pinb->getX() + ratio * dx);
-  int targetby = MathUtils::round(pinb->getY() + ratio * dy);
+  int targetdx = MathUtils::round(pind.getX() - ratio * dx);
+  int targetdy = MathUtils::round(pind.getY() - ratio * dy);
+  int targetbx = MathUtils::round(pinb.getX() + ratio * dx);
+  int targetby = MathUtils::round(pinb.getY() + ratio * dy);
             
   if (!isValid(targetax, targetay) ||
       !isValid(targetbx, targetby) ||
@@ -291,17 +324,18 @@ std::vector<Ref<Point> > Detector::getBullEyeCornerPoints(Ref<zxing::aztec::Poin
     throw ReaderException("bullseye extends over image bounds");
   }
             
-  std::vector<Ref<Point> > returnValue;
-  returnValue.push_back(Ref<Point>(new Point(targetax, targetay)));
-  returnValue.push_back(Ref<Point>(new Point(targetbx, targetby)));
-  returnValue.push_back(Ref<Point>(new Point(targetcx, targetcy)));
-  returnValue.push_back(Ref<Point>(new Point(targetdx, targetdy)));
+  std::vector<Point> returnValue;
+  returnValue.reserve(4);
+  returnValue.push_back(Point(targetax, targetay));
+  returnValue.push_back(Point(targetbx, targetby));
+  returnValue.push_back(Point(targetcx, targetcy));
+  returnValue.push_back(Point(targetdx, targetdy));
             
   return returnValue;
             
 }
         
-Ref<Point> Detector::getMatrixCenter() {
+Point Detector::getMatrixCenter() {
   Ref<ResultPoint> pointA, pointB, pointC, pointD;
   try {
                 
@@ -317,10 +351,10 @@ Ref<Point> Detector::getMatrixCenter() {
     int cx = image_->getWidth() / 2;
     int cy = image_->getHeight() / 2;
                 
-    pointA = getFirstDifferent(Ref<Point>(new Point(cx+7, cy-7)), false,  1, -1)->toResultPoint();
-    pointB = getFirstDifferent(Ref<Point>(new Point(cx+7, cy+7)), false,  1,  1)->toResultPoint();
-    pointC = getFirstDifferent(Ref<Point>(new Point(cx-7, cy+7)), false, -1, -1)->toResultPoint();
-    pointD = getFirstDifferent(Ref<Point>(new Point(cx-7, cy-7)), false, -1, -1)->toResultPoint();
+    pointA = getFirstDifferent(Point(cx+7, cy-7), false,  1, -1).toResultPoint();
+    pointB = getFirstDifferent(Point(cx+7, cy+7), false,  1,  1).toResultPoint();
+    pointC = getFirstDifferent(Point(cx-7, cy+7), false, -1, -1).toResultPoint();
+    pointD = getFirstDifferent(Point(cx-7, cy-7), false, -1, -1).toResultPoint();
                                       
   }
             
@@ -338,17 +372,17 @@ Ref<Point> Detector::getMatrixCenter() {
   } catch (NotFoundException const& e) {
     (void)e;
                 
-    pointA = getFirstDifferent(Ref<Point>(new Point(cx+7, cy-7)), false,  1, -1)->toResultPoint();
-    pointB = getFirstDifferent(Ref<Point>(new Point(cx+7, cy+7)), false,  1,  1)->toResultPoint();
-    pointC = getFirstDifferent(Ref<Point>(new Point(cx-7, cy+7)), false, -1, 1)->toResultPoint();
-    pointD = getFirstDifferent(Ref<Point>(new Point(cx-7, cy-7)), false, -1, -1)->toResultPoint();
+    pointA = getFirstDifferent(Point(cx+7, cy-7), false,  1, -1).toResultPoint();
+    pointB = getFirstDifferent(Point(cx+7, cy+7), false,  1,  1).toResultPoint();
+    pointC = getFirstDifferent(Point(cx-7, cy+7), false, -1, 1).toResultPoint();
+    pointD = getFirstDifferent(Point(cx-7, cy-7), false, -1, -1).toResultPoint();
                 
   }
             
   cx = MathUtils::round((pointA->getX() + pointD->getX() + pointB->getX() + pointC->getX()) / 4.0f);
   cy = MathUtils::round((pointA->getY() + pointD->getY() + pointB->getY() + pointC->getY()) / 4.0f);
             
-  return Ref<Point>(new Point(cx, cy));
+  return Point(cx, cy);
             
 }
         
@@ -423,16 +457,16 @@ void Detector::getParameters(Ref<zxing::BitArray> parameterData) {
   nbDataBlocks_++;
 }
         
-Ref<BitArray> Detector::sampleLine(Ref<zxing::aztec::Point> p1, Ref<zxing::aztec::Point> p2, int size) {
+Ref<BitArray> Detector::sampleLine(Point const& p1, Point const& p2, int size) {
   Ref<BitArray> res(new BitArray(size));
             
   float d = distance(p1, p2);
   float moduleSize = d / (size-1);
-  float dx = moduleSize * float(p2->getX() - p1->getX())/d;
-  float dy = moduleSize * float(p2->getY() - p1->getY())/d;
+  float dx = moduleSize * float(p2.getX() - p1.getX())/d;
+  float dy = moduleSize * float(p2.getY() - p1.getY())/d;
   
-  float px = float(p1->getX());
-  float py = float(p1->getY());
+  float px = float(p1.getX());
+  float py = float(p1.getY());
             
   for (int i = 0; i < size; i++) {
     if (image_->get(MathUtils::round(px), MathUtils::round(py))) res->set(i);
@@ -443,16 +477,16 @@ Ref<BitArray> Detector::sampleLine(Ref<zxing::aztec::Point> p1, Ref<zxing::aztec
   return res;
 }
         
-bool Detector::isWhiteOrBlackRectangle(Ref<zxing::aztec::Point> p1,
-                                       Ref<zxing::aztec::Point> p2,
-                                       Ref<zxing::aztec::Point> p3,
-                                       Ref<zxing::aztec::Point> p4) {
+bool Detector::isWhiteOrBlackRectangle(Point p1,
+                                       Point p2,
+                                       Point p3,
+                                       Point p4) {
   int corr = 3;
             
-  p1 = new Point(p1->getX() - corr, p1->getY() + corr);
-  p2 = new Point(p2->getX() - corr, p2->getY() - corr);
-  p3 = new Point(p3->getX() + corr, p3->getY() - corr);
-  p4 = new Point(p4->getX() + corr, p4->getY() + corr);
+  p1 = Point(p1.getX() - corr, p1.getY() + corr);
+  p2 = Point(p2.getX() - corr, p2.getY() - corr);
+  p3 = Point(p3.getX() + corr, p3.getY() - corr);
+  p4 = Point(p4.getX() + corr, p4.getY() + corr);
             
   int cInit = getColor(p4, p1);
             
@@ -481,18 +515,18 @@ bool Detector::isWhiteOrBlackRectangle(Ref<zxing::aztec::Point> p1,
   return true;
 }
         
-int Detector::getColor(Ref<zxing::aztec::Point> p1, Ref<zxing::aztec::Point> p2) {
+int Detector::getColor(Point const& p1, Point const& p2) {
   float d = distance(p1, p2);
             
-  float dx = (p2->getX() - p1->getX()) / d;
-  float dy = (p2->getY() - p1->getY()) / d;
+  float dx = (p2.getX() - p1.getX()) / d;
+  float dy = (p2.getY() - p1.getY()) / d;
             
   int error = 0;
             
-  float px = float(p1->getX());
-  float py = float(p1->getY());
+  float px = float(p1.getX());
+  float py = float(p1.getY());
             
-  bool colorModel = image_->get(p1->getX(), p1->getY());
+  bool colorModel = image_->get(p1.getX(), p1.getY());
             
   for (int i = 0; i < d; i++) {
     px += dx;
@@ -512,9 +546,9 @@ int Detector::getColor(Ref<zxing::aztec::Point> p1, Ref<zxing::aztec::Point> p2)
   return (errRatio <= 0.1) == colorModel ? 1 : -1;
 }
         
-Ref<Point> Detector::getFirstDifferent(Ref<zxing::aztec::Point> init, bool color, int dx, int dy) {
-  int x = init->getX() + dx;
-  int y = init->getY() + dy;
+Point Detector::getFirstDifferent(Point const& init, bool color, int dx, int dy) {
+  int x = init.getX() + dx;
+  int y = init.getY() + dy;
             
   while (isValid(x, y) && image_->get(x, y) == color) {
     x += dx;
@@ -536,13 +570,13 @@ Ref<Point> Detector::getFirstDifferent(Ref<zxing::aztec::Point> init, bool color
             
   y -= dy;
             
-  return Ref<Point>(new Point(x, y));
+  return Point(x, y);
 }
 
 bool Detector::isValid(int x, int y) {
   return x >= 0 && x < (int)image_->getWidth() && y > 0 && y < (int)image_->getHeight();
 }
         
-float Detector::distance(Ref<zxing::aztec::Point> a, Ref<zxing::aztec::Point> b) {
-  return sqrtf((float)((a->getX() - b->getX()) * (a->getX() - b->getX()) + (a->getY() - b->getY()) * (a->getY() - b->getY())));
+float Detector::distance(Point const& a, Point const& b) {
+  return sqrtf((float)((a.getX() - b.getX()) * (a.getX() - b.getX()) + (a.getY() - b.getY()) * (a.getY() - b.getY())));
 }
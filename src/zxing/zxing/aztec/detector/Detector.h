@@ -27,19 +27,22 @@
 #include <zxing/common/BitArray.h>
 #include <zxing/ResultPoint.h>
 #include <zxing/common/BitMatrix.h>
+#include <zxing/common/detector/RunLengthDetector.h>
 #include <zxing/DecodeHints.h>
 #include <zxing/aztec/AztecDetectorResult.h>
 
 namespace zxing {
 namespace aztec {
 
-class Point : public Counted {
+// Plain value, the detector creates and drops lots of these while
+// walking the bull's eye. Only the final corners become ResultPoints.
+class Point {
  private:
-  const int x;
-  const int y;
+  int x;
+  int y;
             
  public:
-  Ref<ResultPoint> toResultPoint() { 
+  Ref<ResultPoint> toResultPoint() const {
     return Ref<ResultPoint>(new ResultPoint(float(x), float(y)));
   }
             
@@ -53,6 +56,7 @@ class Detector : public Counted {
             
  private:
   Ref<BitMatrix> image_;
+  Ref<RunLengthDetector> runs_;
             
   bool compact_;
   int nbLayers_;
@@ -60,29 +64,31 @@ class Detector : public Counted {
   int nbCenterLayers_;
   int shift_;
             
-  void extractParameters(std::vector<Ref<Point> > bullEyeCornerPoints);
-  ArrayRef< Ref<ResultPoint> > getMatrixCornerPoints(std::vector<Ref<Point> > bullEyeCornerPoints);
+  Ref<AztecDetectorResult> detect(Point const& pCenter);
+  void extractParameters(std::vector<Point> const& bullEyeCornerPoints);
+  ArrayRef< Ref<ResultPoint> > getMatrixCornerPoints(std::vector<Point> const& bullEyeCornerPoints);
   static void correctParameterData(Ref<BitArray> parameterData, bool compact);
-  std::vector<Ref<Point> > getBullEyeCornerPoints(Ref<Point> pCenter);
-  Ref<Point> getMatrixCenter();
+  std::vector<Point> getBullEyeCornerPoints(Point const& pCenter);
+  Point getMatrixCenter();
   Ref<BitMatrix> sampleGrid(Ref<BitMatrix> image,
                             Ref<ResultPoint> topLeft,
                             Ref<ResultPoint> bottomLeft,
                             Ref<ResultPoint> bottomRight,
                             Ref<ResultPoint> topRight);
   void getParameters(Ref<BitArray> parameterData);
-  Ref<BitArray> sampleLine(Ref<Point> p1, Ref<Point> p2, int size);
-  bool isWhiteOrBlackRectangle(Ref<Point> p1,
-                               Ref<Point> p2,
-                               Ref<Point> p3,
-                               Ref<Point> p4);
-  int getColor(Ref<Point> p1, Ref<Point> p2);
-  Ref<Point> getFirstDifferent(Ref<Point> init, bool color, int dx, int dy);
+  Ref<BitArray> sampleLine(Point const& p1, Point const& p2, int size);
+  bool isWhiteOrBlackRectangle(Point p1,
+                               Point p2,
+                               Point p3,
+                               Point p4);
+  int getColor(Point const& p1, Point const& p2);
+  Point getFirstDifferent(Point const& init, bool color, int dx, int dy);
   bool isValid(int x, int y);
-  static float distance(Ref<Point> a, Ref<Point> b);
+  static float distance(Point const& a, Point const& b);
             
  public:
   Detector(Ref<BitMatrix> image);
+  Detector(Ref<RunLengthDetector> runs);
   Ref<AztecDetectorResult> detect();
 };
 
@@ -0,0 +1,190 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  AdaptiveBinarizer.cpp
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/AdaptiveBinarizer.h>
+#include <zxing/common/GlareMask.h>
+
+#include <algorithm>
+#include <vector>
+#include <math.h>
+#include <stdint.h>
+
+using std::vector;
+using zxing::AdaptiveBinarizer;
+using zxing::ArrayRef;
+using zxing::BitArray;
+using zxing::BitMatrix;
+using zxing::Binarizer;
+using zxing::GlareMask;
+using zxing::LuminanceSource;
+using zxing::Ref;
+
+namespace {
+  // Smaller images go to GlobalHistogramBinarizer
+  const int MINIMUM_DIMENSION = 40;
+
+  // The window is this many modules wide, enough to include a few
+  // modules of each color even in the finder patterns
+  const int WINDOW_MODULES = 8;
+
+  // Without a module size hint, the window is 1/8 of the larger
+  // dimension of the image (the value suggested by Bradley and Roth)
+  const int WINDOW_FRACTION = 8;
+  const int MINIMUM_RADIUS = 4;
+
+  // Bradley: black if 15% darker than the local mean, i.e.
+  // pixel * BRADLEY_DENOMINATOR < mean * BRADLEY_NUMERATOR
+  const int BRADLEY_NUMERATOR = 17;
+  const int BRADLEY_DENOMINATOR = 20;
+
+  // Sauvola: threshold = mean * (1 + k * (deviation / R - 1))
+  const float SAUVOLA_K = 0.2f;
+  const float SAUVOLA_R = 128.0f;
+
+  // Integral image with an extra row and column of zeros, so that
+  // sum[y * (width + 1) + x] is the sum of all pixels above and to the
+  // left of (x,y) and the window sums don't need any special cases.
+  template<typename T, bool SQUARE>
+  void integrate(const zxing::byte* luminances, int width, int height,
+    vector<T>& sum) {
+    const int stride = width + 1;
+    sum.assign(stride * (height + 1), 0);
+    for (int y = 0; y < height; y++) {
+      const zxing::byte* src = luminances + y * width;
+      const T* above = &sum[y * stride];
+      T* dest = &sum[(y + 1) * stride];
+      T rowSum = 0;
+      for (int x = 0; x < width; x++) {
+        const T value = src[x];
+        rowSum += SQUARE ? (value * value) : value;
+        dest[x + 1] = above[x + 1] + rowSum;
+      }
+    }
+  }
+
+  template<typename T>
+  inline T windowSum(const vector<T>& sum, int stride,
+    int x0, int y0, int x1, int y1) {
+    return sum[y1 * stride + x1] - sum[y0 * stride + x1] -
+      sum[y1 * stride + x0] + sum[y0 * stride + x0];
+  }
+}
+
+AdaptiveBinarizer::AdaptiveBinarizer(Ref<LuminanceSource> source,
+  Method method, int moduleSize) :
+  GlobalHistogramBinarizer(source), method_(method), moduleSize_(moduleSize) {
+}
+
+AdaptiveBinarizer::~AdaptiveBinarizer() {
+}
+
+Ref<Binarizer> AdaptiveBinarizer::createBinarizer(Ref<LuminanceSource> source) {
+  return Ref<Binarizer>(new AdaptiveBinarizer(source, method_, moduleSize_));
+}
+
+Ref<BitArray> AdaptiveBinarizer::getBlackRow(int y, Ref<BitArray> row) {
+  // The whole matrix costs a few operations per pixel, and 1D readers
+  // benefit from local thresholds as much as 2D ones
+  return getBlackMatrix()->getRow(y, row);
+}
+
+Ref<BitMatrix> AdaptiveBinarizer::getBlackMatrix() {
+  if (matrix_) {
+    return matrix_;
+  }
+  LuminanceSource& source = *getLuminanceSource();
+  const int width = source.getWidth();
+  const int height = source.getHeight();
+  if (width >= MINIMUM_DIMENSION && height >= MINIMUM_DIMENSION) {
+    ArrayRef<byte> luminances = source.getMatrix();
+    Ref<BitMatrix> newMatrix(new BitMatrix(width, height));
+    const int radius = windowRadius(width, height);
+    if (method_ == SAUVOLA) {
+      thresholdSauvola(luminances, width, height, radius, newMatrix);
+    } else {
+      thresholdBradley(luminances, width, height, radius, newMatrix);
+    }
+    GlareMask::apply(luminances, width, height, newMatrix);
+    matrix_ = newMatrix;
+  } else {
+    matrix_ = GlobalHistogramBinarizer::getBlackMatrix();
+  }
+  return matrix_;
+}
+
+int AdaptiveBinarizer::windowRadius(int width, int height) const {
+  const int radius = (moduleSize_ > 0) ?
+    (moduleSize_ * WINDOW_MODULES / 2) :
+    (std::max(width, height) / WINDOW_FRACTION / 2);
+  return std::max(radius, MINIMUM_RADIUS);
+}
+
+void AdaptiveBinarizer::thresholdBradley(ArrayRef<byte> luminances,
+  int width, int height, int radius, Ref<BitMatrix> const& matrix) const {
+  // 255 * 2^24 still fits, that's more than any camera frame
+  vector<uint32_t> sum;
+  integrate<uint32_t,false>(&luminances[0], width, height, sum);
+  const int stride = width + 1;
+  for (int y = 0; y < height; y++) {
+    const int y0 = std::max(y - radius, 0);
+    const int y1 = std::min(y + radius + 1, height);
+    const byte* src = &luminances[y * width];
+    int* bits = matrix->getRowBits(y);
+    for (int x = 0; x < width; x++) {
+      const int x0 = std::max(x - radius, 0);
+      const int x1 = std::min(x + radius + 1, width);
+      const int64_t count = (x1 - x0) * (y1 - y0);
+      const int64_t total = windowSum(sum, stride, x0, y0, x1, y1);
+      if (src[x] * count * BRADLEY_DENOMINATOR <=
+          total * BRADLEY_NUMERATOR) {
+        bits[x >> 5] |= 1 << (x & 0x1f);
+      }
+    }
+  }
+}
+
+void AdaptiveBinarizer::thresholdSauvola(ArrayRef<byte> luminances,
+  int width, int height, int radius, Ref<BitMatrix> const& matrix) const {
+  vector<uint32_t> sum;
+  vector<uint64_t> sum2;
+  integrate<uint32_t,false>(&luminances[0], width, height, sum);
+  integrate<uint64_t,true>(&luminances[0], width, height, sum2);
+  const int stride = width + 1;
+  for (int y = 0; y < height; y++) {
+    const int y0 = std::max(y - radius, 0);
+    const int y1 = std::min(y + radius + 1, height);
+    const byte* src = &luminances[y * width];
+    int* bits = matrix->getRowBits(y);
+    for (int x = 0; x < width; x++) {
+      const int x0 = std::max(x - radius, 0);
+      const int x1 = std::min(x + radius + 1, width);
+      const float count = (float)((x1 - x0) * (y1 - y0));
+      const float mean = windowSum(sum, stride, x0, y0, x1, y1) / count;
+      const float variance = windowSum(sum2, stride, x0, y0, x1, y1) /
+        count - mean * mean;
+      const float deviation = (variance > 0) ? sqrtf(variance) : 0;
+      const float threshold = mean *
+        (1 + SAUVOLA_K * (deviation / SAUVOLA_R - 1));
+      if (src[x] <= threshold) {
+        bits[x >> 5] |= 1 << (x & 0x1f);
+      }
+    }
+  }
+}
@@ -0,0 +1,69 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __ADAPTIVEBINARIZER_H__
+#define __ADAPTIVEBINARIZER_H__
+/*
+ *  AdaptiveBinarizer.h
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/GlobalHistogramBinarizer.h>
+#include <zxing/common/BitArray.h>
+#include <zxing/common/BitMatrix.h>
+
+namespace zxing {
+
+/**
+ * Thresholds each pixel against the statistics of a square window
+ * centered at it. The window sums come from an integral image, so the
+ * cost per pixel doesn't depend on the window size, and the window can
+ * be made large enough to always contain both light and dark modules.
+ * Unlike HybridBinarizer, there are no block boundaries, which makes
+ * steep illumination gradients much less of a problem.
+ */
+class AdaptiveBinarizer : public GlobalHistogramBinarizer {
+public:
+  enum Method {
+    BRADLEY,    // Fixed percentage below the local mean
+    SAUVOLA     // Local mean adjusted by local standard deviation
+  };
+
+  // Module size (in pixels) determines the window size. Zero means
+  // that it's unknown, and the window is derived from the image size.
+  AdaptiveBinarizer(Ref<LuminanceSource> source, Method method = BRADLEY,
+    int moduleSize = 0);
+  virtual ~AdaptiveBinarizer();
+
+  virtual Ref<BitArray> getBlackRow(int y, Ref<BitArray> row);
+  virtual Ref<BitMatrix> getBlackMatrix();
+  Ref<Binarizer> createBinarizer(Ref<LuminanceSource> source);
+
+private:
+  int windowRadius(int width, int height) const;
+  void thresholdBradley(ArrayRef<byte> luminances, int width, int height,
+    int radius, Ref<BitMatrix> const& matrix) const;
+  void thresholdSauvola(ArrayRef<byte> luminances, int width, int height,
+    int radius, Ref<BitMatrix> const& matrix) const;
+
+private:
+  Method method_;
+  int moduleSize_;
+  Ref<BitMatrix> matrix_;
+};
+
+}
+
+#endif // __ADAPTIVEBINARIZER_H__
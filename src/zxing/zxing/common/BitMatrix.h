@@ -62,6 +62,11 @@ public:
   int getWidth() const;
   int getHeight() const;
 
+  // Raw access to the packed rows, rowSize 32-bit words per row
+  int getRowSize() const { return rowSize; }
+  const int* getRowBits(int y) const { return bits + y * rowSize; }
+  int* getRowBits(int y) { return bits + y * rowSize; }
+
   ArrayRef<int> getTopLeftOnBit() const;
   ArrayRef<int> getBottomRightOnBit() const;
   ArrayRef<int> getEnclosingRectangle() const;
@@ -20,57 +20,23 @@
  */
 
 #include <zxing/common/BitSource.h>
-#include <sstream>
 #include <zxing/common/IllegalArgumentException.h>
 
 namespace zxing {
 
-int BitSource::readBits(int numBits) {
-  if (numBits < 0 || numBits > 32 || numBits > available()) {
-    std::ostringstream oss;
-    oss << numBits;
-    throw IllegalArgumentException(oss.str().c_str());
-  }
-
-  int result = 0;
-
-  // First, read remainder from current byte
-  if (bitOffset_ > 0) {
-    int bitsLeft = 8 - bitOffset_;
-    int toRead = numBits < bitsLeft ? numBits : bitsLeft;
-    int bitsToNotRead = bitsLeft - toRead;
-    int mask = (0xFF >> (8 - toRead)) << bitsToNotRead;
-    result = (bytes_[byteOffset_] & mask) >> bitsToNotRead;
-    numBits -= toRead;
-    bitOffset_ += toRead;
-    if (bitOffset_ == 8) {
-      bitOffset_ = 0;
-      byteOffset_++;
-    }
+void BitSource::refill() {
+  int size = bytes_->size();
+  while (cacheBits_ <= 56 && byteOffset_ < size) {
+    cache_ |= (uint64_t)(bytes_[byteOffset_++] & 0xFF) << (56 - cacheBits_);
+    cacheBits_ += 8;
   }
+}
 
-  // Next read whole bytes
-  if (numBits > 0) {
-    while (numBits >= 8) {
-      result = (result << 8) | (bytes_[byteOffset_] & 0xFF);
-      byteOffset_++;
-      numBits -= 8;
-    }
-
-
-    // Finally read a partial byte
-    if (numBits > 0) {
-      int bitsToNotRead = 8 - numBits;
-      int mask = (0xFF >> bitsToNotRead) << bitsToNotRead;
-      result = (result << numBits) | ((bytes_[byteOffset_] & mask) >> bitsToNotRead);
-      bitOffset_ += numBits;
-    }
+int BitSource::readBits(int numBits) {
+  int result;
+  if (!readBits(numBits, result)) {
+    throw IllegalArgumentException("BitSource::readBits: not enough bits");
   }
-
   return result;
 }
-
-int BitSource::available() {
-  return 8 * (bytes_->size() - byteOffset_) - bitOffset_;
-}
 }
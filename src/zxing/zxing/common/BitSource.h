@@ -22,6 +22,7 @@
 
 #include <zxing/common/Array.h>
 #include <zxing/common/Types.h>
+#include <stdint.h>
 
 namespace zxing {
 /**
@@ -36,37 +37,93 @@ namespace zxing {
 class BitSource : public Counted {
 private:
   ArrayRef<byte> bytes_;
+  // Next byte of bytes_ to be loaded into the cache
   int byteOffset_;
-  int bitOffset_;
+  // Unread bits, left-aligned so the next bit to read is the most significant
+  uint64_t cache_;
+  int cacheBits_;
+
+  void refill();
+
 public:
   /**
    * @param bytes bytes from which this will read bits. Bits will be read from the first byte first.
    * Bits are read within a byte from most-significant to least-significant bit.
    */
   BitSource(ArrayRef<byte> &bytes) :
-      bytes_(bytes), byteOffset_(0), bitOffset_(0) {
+      bytes_(bytes), byteOffset_(0), cache_(0), cacheBits_(0) {
   }
 
   int getBitOffset() {
-    return bitOffset_;
+    return (8 * byteOffset_ - cacheBits_) & 7;
   }
 
   int getByteOffset() {
-    return byteOffset_;
+    return (8 * byteOffset_ - cacheBits_) >> 3;
+  }
+
+  /**
+   * Reads numBits bits without consuming them.
+   *
+   * @return false if numBits isn't in [0,32] or fewer bits are available
+   */
+  bool peekBits(int numBits, int& value) {
+    if ((unsigned)numBits > 32) {
+      return false;
+    }
+    if (cacheBits_ < numBits) {
+      refill();
+      if (cacheBits_ < numBits) {
+        return false;
+      }
+    }
+    // Two shifts so that numBits == 0 doesn't shift by 64
+    value = (int)((cache_ >> 1) >> (63 - numBits));
+    return true;
+  }
+
+  /**
+   * @return false if numBits isn't in [0,32] or fewer bits are available
+   */
+  bool skipBits(int numBits) {
+    int ignored;
+    if (!peekBits(numBits, ignored)) {
+      return false;
+    }
+    cache_ <<= numBits;
+    cacheBits_ -= numBits;
+    return true;
+  }
+
+  /**
+   * Same as readBits(int) but reports failure through its return value.
+   *
+   * @return false if numBits isn't in [0,32] or fewer bits are available, in which
+   *         case nothing is consumed
+   */
+  bool readBits(int numBits, int& value) {
+    if (!peekBits(numBits, value)) {
+      return false;
+    }
+    cache_ <<= numBits;
+    cacheBits_ -= numBits;
+    return true;
   }
 
   /**
    * @param numBits number of bits to read
    * @return int representing the bits read. The bits will appear as the least-significant
    *         bits of the int
-   * @throws IllegalArgumentException if numBits isn't in [1,32]
+   * @throws IllegalArgumentException if numBits isn't in [0,32] or more than available()
    */
   int readBits(int numBits);
 
   /**
    * @return number of bits that can be read successfully
    */
-  int available();
+  int available() {
+    return 8 * (bytes_->size() - byteOffset_) + cacheBits_;
+  }
 };
 
 }
@@ -0,0 +1,53 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __CHARACTER_SET_DECODER_H__
+#define __CHARACTER_SET_DECODER_H__
+
+/*
+ *  CharacterSetDecoder.h
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <zxing/common/Types.h>
+
+namespace zxing {
+namespace common {
+
+/**
+ * Converts the character sets known to CharacterSetECI (plus the names
+ * used by StringUtils) to UTF-8 with built-in mapping tables, so that
+ * the bitstream parsers don't need iconv. Unmapped characters become
+ * U+FFFD, unknown character sets are copied as is.
+ */
+class CharacterSetDecoder {
+private:
+  CharacterSetDecoder() {}
+
+public:
+  // Appends length bytes encoded in the given character set to result
+  static void append(std::string& result, const byte* bytes, size_t length,
+                     char const* encoding);
+
+  // Guesses the character set (see StringUtils::guessEncoding) and
+  // converts the whole thing to UTF-8
+  static std::string toUTF8(std::string const& bytes);
+};
+
+}
+}
+
+#endif
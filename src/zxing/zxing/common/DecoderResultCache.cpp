@@ -0,0 +1,80 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  DecoderResultCache.cpp
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/DecoderResultCache.h>
+#include <cstring>
+
+using std::vector;
+using zxing::ArrayRef;
+using zxing::Ref;
+using zxing::DecoderResult;
+using zxing::DecoderResultCache;
+
+DecoderResultCache::DecoderResultCache(size_t capacity) : capacity_(capacity) {
+  entries_.reserve(capacity);
+}
+
+// FNV-1a
+unsigned int DecoderResultCache::hash(ArrayRef<byte> const& codewords, int tag) {
+  unsigned int h = 2166136261U ^ (unsigned int)tag;
+  vector<byte> const& bytes = codewords->values();
+  for (size_t i = 0; i < bytes.size(); i++) {
+    h = (h ^ bytes[i]) * 16777619U;
+  }
+  return h;
+}
+
+Ref<DecoderResult> DecoderResultCache::find(ArrayRef<byte> const& codewords, int tag) {
+  const unsigned int h = hash(codewords, tag);
+  const size_t n = codewords->size();
+  for (size_t i = 0; i < entries_.size(); i++) {
+    const Entry& entry = entries_[i];
+    if (entry.hash == h && entry.tag == tag && entry.codewords.size() == n &&
+        (!n || !memcmp(&entry.codewords[0], &codewords[0], n))) {
+      Ref<DecoderResult> result(entry.result);
+      if (i > 0) {
+        // Move it to the front
+        Entry found(entry);
+        entries_.erase(entries_.begin() + i);
+        entries_.insert(entries_.begin(), found);
+      }
+      return result;
+    }
+  }
+  return Ref<DecoderResult>();
+}
+
+void DecoderResultCache::add(ArrayRef<byte> const& codewords, int tag, Ref<DecoderResult> result) {
+  if (capacity_ > 0) {
+    if (entries_.size() >= capacity_) {
+      entries_.pop_back();
+    }
+    Entry entry;
+    entry.hash = hash(codewords, tag);
+    entry.tag = tag;
+    entry.codewords = codewords->values();
+    entry.result = result;
+    entries_.insert(entries_.begin(), entry);
+  }
+}
+
+void DecoderResultCache::clear() {
+  entries_.clear();
+}
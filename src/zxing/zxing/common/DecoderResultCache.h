@@ -0,0 +1,62 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __DECODER_RESULT_CACHE_H__
+#define __DECODER_RESULT_CACHE_H__
+
+/*
+ *  DecoderResultCache.h
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include <zxing/common/Array.h>
+#include <zxing/common/DecoderResult.h>
+
+namespace zxing {
+
+/**
+ * Remembers the last few symbols decoded by a decoder, keyed by the
+ * raw codewords read from the grid (before error correction) and a tag
+ * describing how to interpret them (version, error correction level).
+ * When the camera keeps looking at the same symbol, the codewords come
+ * out the same and error correction and bitstream parsing can be
+ * skipped. Any difference in the codewords is a miss.
+ */
+class DecoderResultCache {
+private:
+  struct Entry {
+    unsigned int hash;
+    int tag;
+    std::vector<byte> codewords;
+    Ref<DecoderResult> result;
+  };
+
+  std::vector<Entry> entries_;  // Most recently used first
+  size_t capacity_;
+
+  static unsigned int hash(ArrayRef<byte> const& codewords, int tag);
+
+public:
+  DecoderResultCache(size_t capacity = 4);
+
+  Ref<DecoderResult> find(ArrayRef<byte> const& codewords, int tag);
+  void add(ArrayRef<byte> const& codewords, int tag, Ref<DecoderResult> result);
+  void clear();
+};
+
+}
+
+#endif // __DECODER_RESULT_CACHE_H__
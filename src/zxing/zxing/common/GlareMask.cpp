@@ -0,0 +1,155 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  GlareMask.cpp
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/GlareMask.h>
+#include <zxing/common/GlobalHistogramBinarizer.h>
+
+using zxing::ArrayRef;
+using zxing::BitArray;
+using zxing::BitMatrix;
+using zxing::GlareMask;
+using zxing::GlobalHistogramBinarizer;
+using zxing::Ref;
+
+namespace {
+  const int BUCKETS = GlobalHistogramBinarizer::LUMINANCE_BUCKETS;
+  const int SHIFT = GlobalHistogramBinarizer::LUMINANCE_SHIFT;
+
+  // The paper peak must be at least this many buckets below saturation
+  const int MIN_GAP_BUCKETS = 3;
+
+  // And at least 1/PAPER_RATIO as tall as the saturated bucket
+  const int PAPER_RATIO = 4;
+
+  // Highlights can be small, the whole frame is sampled on a grid
+  const int SAMPLE_STEP = 4;
+
+  // At least 1/ROW_FRACTION of the row must be saturated
+  const int ROW_FRACTION = 32;
+
+  // Sets bits [from,to) to value
+  template<class T>
+  inline void fillBits(T& bits, int from, int to, bool value) {
+    for (int x = from; x < to; x++) {
+      if (bits.get(x) != value) {
+        bits.flip(x);
+      }
+    }
+  }
+
+  // Adapts BitMatrix row to the same interface as BitArray
+  class MatrixRow {
+  public:
+    MatrixRow(BitMatrix& matrix, int y) : matrix_(matrix), y_(y) {}
+    bool get(int x) const { return matrix_.get(x, y_); }
+    void flip(int x) { matrix_.flip(x, y_); }
+  private:
+    BitMatrix& matrix_;
+    int y_;
+  };
+
+  template<class T>
+  void fillRow(const zxing::byte* luminances, int width, T& bits) {
+    int x = 0;
+    while (x < width) {
+      if (luminances[x] < GlareMask::SATURATED) {
+        x++;
+      } else {
+        int start = x;
+        while (x < width && luminances[x] >= GlareMask::SATURATED) {
+          x++;
+        }
+        // The halo keeps getting darker until it reaches whatever
+        // is underneath, be it the paper or a dark module
+        while (x < width && luminances[x] < luminances[x - 1]) {
+          x++;
+        }
+        while (start > 0 && luminances[start - 1] < luminances[start]) {
+          start--;
+        }
+        if (start > 0 || x < width) {
+          // Whatever is on the other side if the run touches the edge
+          const bool left = bits.get((start > 0) ? (start - 1) : x);
+          const bool right = bits.get((x < width) ? x : (start - 1));
+          const int middle = (start + x) / 2;
+          fillBits(bits, start, middle, left);
+          fillBits(bits, middle, x, right);
+        }
+      }
+    }
+  }
+}
+
+bool GlareMask::detect(ArrayRef<int> const& buckets) {
+  const int top = BUCKETS - 1;
+  const int saturated = buckets[top];
+  if (saturated > 0) {
+    int paper = -1;
+    int paperCount = 0;
+    for (int i = BUCKETS / 2; i < top; i++) {
+      if (buckets[i] > paperCount) {
+        paper = i;
+        paperCount = buckets[i];
+      }
+    }
+    return paper >= 0 && paper <= top - MIN_GAP_BUCKETS &&
+      paperCount * PAPER_RATIO >= saturated;
+  }
+  return false;
+}
+
+bool GlareMask::detect(const byte* luminances, int width, int height) {
+  ArrayRef<int> buckets(BUCKETS);
+  for (int y = SAMPLE_STEP / 2; y < height; y += SAMPLE_STEP) {
+    const byte* row = luminances + width * y;
+    for (int x = SAMPLE_STEP / 2; x < width; x += SAMPLE_STEP) {
+      buckets[row[x] >> SHIFT]++;
+    }
+  }
+  return detect(buckets);
+}
+
+bool GlareMask::detectInRow(const byte* luminances, int width) {
+  ArrayRef<int> buckets(BUCKETS);
+  for (int x = 0; x < width; x++) {
+    buckets[luminances[x] >> SHIFT]++;
+  }
+  return buckets[BUCKETS - 1] * ROW_FRACTION >= width && detect(buckets);
+}
+
+void GlareMask::fill(const byte* luminances, int width, Ref<BitArray> row) {
+  fillRow(luminances, width, *row);
+}
+
+void GlareMask::fill(const byte* luminances, int width, int height,
+  Ref<BitMatrix> matrix) {
+  for (int y = 0; y < height; y++) {
+    MatrixRow row(*matrix, y);
+    fillRow(luminances + y * width, width, row);
+  }
+}
+
+void GlareMask::apply(ArrayRef<byte> luminances, int width, int height,
+  Ref<BitMatrix> matrix) {
+  const byte* pixels = &luminances[0];
+  if (detect(pixels, width, height)) {
+    fill(pixels, width, height, matrix);
+  }
+}
@@ -0,0 +1,67 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __GLAREMASK_H__
+#define __GLAREMASK_H__
+/*
+ *  GlareMask.h
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/ZXing.h>
+#include <zxing/common/Array.h>
+#include <zxing/common/BitArray.h>
+#include <zxing/common/BitMatrix.h>
+
+namespace zxing {
+
+/**
+ * Specular highlights on glossy labels are blown out to the top of the
+ * luminance range, well above the paper around them. What's under such
+ * a highlight is unknown rather than white, and treating it as white
+ * creates false spaces and skews the histogram.
+ *
+ * Saturated pixels are only considered glare if the histogram has a
+ * distinct paper peak below them. Otherwise the whole picture is just
+ * overexposed, and the saturated pixels are the paper.
+ */
+class GlareMask {
+public:
+  // Lower bound of the top bucket of GlobalHistogramBinarizer
+  static const int SATURATED = 248;
+
+  // Takes the histogram built by GlobalHistogramBinarizer
+  static bool detect(ArrayRef<int> const& buckets);
+
+  // Samples the whole picture
+  static bool detect(const byte* luminances, int width, int height);
+
+  // Requires a noticeable share of the row to be covered by glare
+  static bool detectInRow(const byte* luminances, int width);
+
+  // Extends the bits on both sides of each highlight (saturated pixels
+  // and the halo fading out of them) halfway into it
+  static void fill(const byte* luminances, int width, Ref<BitArray> row);
+  static void fill(const byte* luminances, int width, int height,
+    Ref<BitMatrix> matrix);
+
+  // Detects glare and, if there is any, fills it in
+  static void apply(ArrayRef<byte> luminances, int width, int height,
+    Ref<BitMatrix> matrix);
+};
+
+}
+
+#endif // __GLAREMASK_H__
@@ -19,6 +19,7 @@
  */
 
 #include <zxing/common/GlobalHistogramBinarizer.h>
+#include <zxing/common/GlareMask.h>
 #include <zxing/NotFoundException.h>
 #include <zxing/common/Array.h>
 
@@ -33,9 +34,6 @@ using zxing::LuminanceSource;
 
 namespace zxing {
 
-const int LUMINANCE_BITS = 5;
-const int LUMINANCE_SHIFT = 8 - LUMINANCE_BITS;
-const int LUMINANCE_BUCKETS = 1 << LUMINANCE_BITS;
 const ArrayRef<byte> EMPTY (0);
 
 GlobalHistogramBinarizer::GlobalHistogramBinarizer(Ref<LuminanceSource> source) 
@@ -81,20 +79,31 @@ Ref<BitArray> GlobalHistogramBinarizer::getBlackRow(int y, Ref<BitArray> row) {
         int pixel = localLuminances[x] & 0xff;
         localBuckets[pixel >> LUMINANCE_SHIFT]++;
     }
+    // Highlights would otherwise pass for the light peak
+    const bool glare = GlareMask::detect(_localBuckets);
+    if (glare) {
+        localBuckets[LUMINANCE_BUCKETS - 1] = 0;
+    }
     int blackPoint = estimateBlackPoint(_localBuckets);
     // std::cerr << "gbr bp " << y << " " << blackPoint << std::endl;
 
-    int left = localLuminances[0] & 0xff;
-    int center = localLuminances[1] & 0xff;
-    for (int x = 1; x < width - 1; x++) {
-        int right = localLuminances[x + 1] & 0xff;
-        // A simple -1 4 -1 box filter with a weight of 2.
-        int luminance = ((center << 2) - left - right) >> 1;
-        if (luminance < blackPoint) {
-            row->set(x);
+    // Bits are collected into whole words rather than set one by one
+    // through BitArray::set(), that keeps the loop free of stores to
+    // memory and lets the compiler unroll it.
+    for (int x0 = 0; x0 < width - 1; x0 += 32) {
+        const int start = (x0 > 0) ? x0 : 1;
+        const int end = (x0 + 32 < width - 1) ? (x0 + 32) : (width - 1);
+        unsigned int bits = 0;
+        for (int x = start; x < end; x++) {
+            // A simple -1 4 -1 box filter with a weight of 2.
+            const int luminance = ((localLuminances[x] << 2) -
+                localLuminances[x - 1] - localLuminances[x + 1]) >> 1;
+            bits |= (unsigned int)(luminance < blackPoint) << (x & 0x1f);
         }
-        left = center;
-        center = right;
+        row->setBulk(x0, (int)bits);
+    }
+    if (glare) {
+        GlareMask::fill(localLuminances, width, row);
     }
     return row;
 }
@@ -126,6 +135,11 @@ Ref<BitMatrix> GlobalHistogramBinarizer::getBlackMatrix() {
         }
     }
 
+    // The rows above may well miss a highlight
+    const bool glare = GlareMask::detect(localLuminances, width, height);
+    if (glare) {
+        localBuckets[LUMINANCE_BUCKETS - 1] = 0;
+    }
     int blackPoint = estimateBlackPoint(_localBuckets);
 
     for (int y = 0; y < height; y++) {
@@ -137,6 +151,9 @@ Ref<BitMatrix> GlobalHistogramBinarizer::getBlackMatrix() {
             }
         }
     }
+    if (glare) {
+        GlareMask::fill(localLuminances, width, height, matrix);
+    }
 
     return matrix;
 }
@@ -32,6 +32,10 @@ private:
   ArrayRef<byte> luminances;
   ArrayRef<int> buckets;
 public:
+  static const int LUMINANCE_BITS = 5;
+  static const int LUMINANCE_SHIFT = 8 - LUMINANCE_BITS;
+  static const int LUMINANCE_BUCKETS = 1 << LUMINANCE_BITS;
+
   GlobalHistogramBinarizer(Ref<LuminanceSource> source);
   virtual ~GlobalHistogramBinarizer();
 		
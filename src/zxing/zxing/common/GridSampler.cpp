@@ -74,6 +74,28 @@ Ref<BitMatrix> GridSampler::sampleGrid(Ref<BitMatrix> image, int dimensionX, int
   return bits;
 }
 
+// Samples modules [left, right) x [top, bottom) into the existing matrix,
+// for grids which are mapped piece by piece.
+void GridSampler::sampleGrid(Ref<BitMatrix> image, Ref<BitMatrix> bits, int left, int top, int right, int bottom,
+                             Ref<PerspectiveTransform> transform) {
+  vector<float> points((right - left) << 1, 0.0f);
+  for (int y = top; y < bottom; y++) {
+    int max = points.size();
+    float yValue = (float)y + 0.5f;
+    for (int x = 0; x < max; x += 2) {
+      points[x] = (float)(left + (x >> 1)) + 0.5f;
+      points[x + 1] = yValue;
+    }
+    transform->transformPoints(points);
+    checkAndNudgePoints(image, points);
+    for (int x = 0; x < max; x += 2) {
+      if (image->get((int)points[x], (int)points[x + 1])) {
+        bits->set(left + (x >> 1), y);
+      }
+    }
+  }
+}
+
 Ref<BitMatrix> GridSampler::sampleGrid(Ref<BitMatrix> image, int dimension, float p1ToX, float p1ToY, float p2ToX,
                                        float p2ToY, float p3ToX, float p3ToY, float p4ToX, float p4ToY, float p1FromX, float p1FromY, float p2FromX,
                                        float p2FromY, float p3FromX, float p3FromY, float p4FromX, float p4FromY) {
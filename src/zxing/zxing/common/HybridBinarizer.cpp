@@ -21,6 +21,7 @@
 #include <zxing/common/HybridBinarizer.h>
 
 #include <zxing/common/IllegalArgumentException.h>
+#include <zxing/common/GlareMask.h>
 
 using namespace std;
 using namespace zxing;
@@ -79,6 +80,7 @@ Ref<BitMatrix> HybridBinarizer::getBlackMatrix() {
                                height,
                                blackPoints,
                                newMatrix);
+    GlareMask::apply(luminances, width, height, newMatrix);
     matrix_ = newMatrix;
   } else {
     // If the image is too small, fall back to the global histogram approach.
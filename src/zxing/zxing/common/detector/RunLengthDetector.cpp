@@ -0,0 +1,517 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  RunLengthDetector.cpp
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/common/detector/RunLengthDetector.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+using std::vector;
+using zxing::Ref;
+using zxing::BitMatrix;
+using zxing::RunLengthDetector;
+
+namespace {
+
+// Smaller modules can't be reliably sampled anyway
+const int MIN_MODULE_SIZE = 2;
+// Shortest arm of the Data Matrix "L" we care about (10 modules)
+const int MIN_ARM_LENGTH = 10 * MIN_MODULE_SIZE;
+// How far apart the ends of two runs forming a corner may be
+const int CORNER_TOLERANCE = 2;
+// The rest is most likely noise
+const size_t MAX_CANDIDATES = 8;
+// Rows with shorter runs on average are noise, not worth looking at
+// run by run. A row crossing a symbol made of the smallest modules
+// averages closer to two modules per run.
+const int MIN_AVERAGE_RUN = MIN_MODULE_SIZE + 1;
+
+inline int bitCount(unsigned int i) {
+#if defined(__clang__) || defined(__GNUC__)
+  return __builtin_popcount(i);
+#else
+  int n = 0;
+  for (; i; i &= i - 1) {
+    n++;
+  }
+  return n;
+#endif
+}
+
+inline int numberOfTrailingZeros(unsigned int i) {
+#if defined(__clang__) || defined(__GNUC__)
+  return __builtin_ctz(i);
+#else
+  int n = 0;
+  while (!(i & 1)) {
+    i >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+struct BullsEyeCountComparator {
+  bool operator()(const RunLengthDetector::BullsEye& a,
+                  const RunLengthDetector::BullsEye& b) const {
+    return a.count > b.count;
+  }
+};
+
+struct LShapeScoreComparator {
+  bool operator()(const RunLengthDetector::LShape& a,
+                  const RunLengthDetector::LShape& b) const {
+    return a.score > b.score;
+  }
+};
+
+inline int sign(int value) {
+  return (value < 0) ? -1 : 1;
+}
+
+}
+
+RunLengthDetector::RunLengthDetector(Ref<BitMatrix> image) :
+  image_(image), edgeCount_(0), partialRings_(0), cornerCount_(0) {
+  scan();
+}
+
+void RunLengthDetector::scan() {
+  const int width = image_->getWidth();
+  const int height = image_->getHeight();
+  const int rowSize = image_->getRowSize();
+  vector<int> edges, above, found;
+  vector<unsigned int> diffs(rowSize);
+  vector<int> vstart(rowSize << 5, 0);
+  vector<Run> hruns, vruns;
+  const unsigned int* prev = NULL;
+
+  edges.reserve(width + 1);
+  for (int y = 0; y < height; y++) {
+    const unsigned int* row = (const unsigned int*)image_->getRowBits(y);
+
+    // Bit n of diff is set if pixel n differs from the one on its left.
+    // Bits past the width are always zero, so every black run is closed
+    // except the one touching the right edge of a word-aligned row.
+    // Counting them first is cheap and lets us skip noisy rows.
+    unsigned int carry = 0;
+    int count = 0;
+    for (int i = 0; i < rowSize; i++) {
+      const unsigned int word = row[i];
+      diffs[i] = word ^ ((word << 1) | carry);
+      carry = word >> 31;
+      count += bitCount(diffs[i]);
+    }
+    edgeCount_ += count;
+
+    if (count * MIN_AVERAGE_RUN <= width) {
+      edges.clear();
+      for (int i = 0; i < rowSize; i++) {
+        unsigned int diff = diffs[i];
+        while (diff) {
+          edges.push_back((i << 5) + numberOfTrailingZeros(diff));
+          diff &= diff - 1;
+        }
+      }
+      if (edges.size() & 1) {
+        edges.push_back(width);
+      }
+
+      // Even edges start black runs, odd ones end them
+      for (size_t k = 0; k < edges.size(); k += 2) {
+        if (edges[k + 1] - edges[k] >= MIN_ARM_LENGTH) {
+          Run run = { y, edges[k], edges[k + 1] - 1 };
+          hruns.push_back(run);
+        }
+      }
+      findBullsEyes(y, edges, above, found);
+    } else {
+      found.clear();
+    }
+    above.swap(found);
+
+    // Vertical runs start where black appears below white and end
+    // where black is followed by white
+    for (int i = 0; i < rowSize; i++) {
+      const unsigned int above = prev ? prev[i] : 0;
+      unsigned int started = row[i] & ~above;
+      unsigned int ended = above & ~row[i];
+      while (started) {
+        vstart[(i << 5) + numberOfTrailingZeros(started)] = y;
+        started &= started - 1;
+      }
+      while (ended) {
+        const int x = (i << 5) + numberOfTrailingZeros(ended);
+        if (y - vstart[x] >= MIN_ARM_LENGTH) {
+          Run run = { x, vstart[x], y - 1 };
+          vruns.push_back(run);
+        }
+        ended &= ended - 1;
+      }
+    }
+    prev = row;
+  }
+
+  // Close the runs touching the bottom edge
+  for (int i = 0; prev && i < rowSize; i++) {
+    unsigned int open = prev[i];
+    while (open) {
+      const int x = (i << 5) + numberOfTrailingZeros(open);
+      if (height - vstart[x] >= MIN_ARM_LENGTH) {
+        Run run = { x, vstart[x], height - 1 };
+        vruns.push_back(run);
+      }
+      open &= open - 1;
+    }
+  }
+
+  std::stable_sort(bullsEyes_.begin(), bullsEyes_.end(), BullsEyeCountComparator());
+  if (bullsEyes_.size() > MAX_CANDIDATES) {
+    bullsEyes_.resize(MAX_CANDIDATES);
+  }
+  findLShapes(hruns, vruns);
+}
+
+void RunLengthDetector::findBullsEyes(int y, const vector<int>& edges,
+                                      const vector<int>& above, vector<int>& found) {
+  // Black run k spans [edges[2k], edges[2k+1]). Nine runs starting and
+  // ending with black (B W B W B W B W B) cut through the bull's eye of
+  // a compact symbol or through the inner rings of a full range one.
+  // The center module is at least two pixels high, so the same runs
+  // show up in the row above. Cross-checking only those skips most of
+  // the texture that happens to match in a single row.
+  const int n = (int)edges.size();
+  int counts[9];
+  found.clear();
+  for (int k = 0; k + 9 < n; k += 2) {
+    // Too short or the center run is off, no need to look at the rest
+    const int total = edges[k + 8] - edges[k + 1];
+    const int center = edges[k + 5] - edges[k + 4];
+    if (total < 7 * MIN_MODULE_SIZE || std::abs(14 * center - 2 * total) > total + 7) {
+      continue;
+    }
+    for (int i = 0; i < 9; i++) {
+      counts[i] = edges[k + i + 1] - edges[k + i];
+    }
+    if (checkRingRatios(counts, total)) {
+      const int centerX = (edges[k + 4] + edges[k + 5]) / 2;
+      const int maxShift = total / 14 + 1;
+      found.push_back(centerX);
+      for (size_t i = 0; i < above.size(); i++) {
+        if (std::abs(above[i] - centerX) <= maxShift) {
+          const float centerY = crossCheck(centerX, y, true, total);
+          if (centerY >= 0) {
+            partialRings_++;
+            const float refinedX = crossCheck(centerX, (int)centerY, false, total);
+            if (refinedX >= 0) {
+              addBullsEye(refinedX, centerY, total / 7.0f);
+            }
+          }
+          break;
+        }
+      }
+    }
+  }
+}
+
+void RunLengthDetector::addBullsEye(float x, float y, float moduleSize) {
+  for (size_t i = 0; i < bullsEyes_.size(); i++) {
+    BullsEye& known = bullsEyes_[i];
+    const float maxDistance = known.moduleSize * 2;
+    if (std::abs(known.x - x) <= maxDistance &&
+        std::abs(known.y - y) <= maxDistance) {
+      const int n = known.count;
+      known.x = (known.x * n + x) / (n + 1);
+      known.y = (known.y * n + y) / (n + 1);
+      known.moduleSize = (known.moduleSize * n + moduleSize) / (n + 1);
+      known.count++;
+      return;
+    }
+  }
+  BullsEye bullsEye = { x, y, moduleSize, 1 };
+  bullsEyes_.push_back(bullsEye);
+}
+
+/**
+ * Walks through (x,y) vertically or horizontally looking for the same
+ * nine runs found in the row, total being the length of the inner seven.
+ * Returns the center of the middle run or -1 if the ratios don't match.
+ */
+float RunLengthDetector::crossCheck(int x, int y, bool vertical, int total) const {
+  const int dx = vertical ? 0 : 1;
+  const int dy = vertical ? 1 : 0;
+  const int limit = vertical ? image_->getHeight() : image_->getWidth();
+  const int start = vertical ? y : x;
+  // Allow some perspective, but not too much. No need to walk any
+  // further than the longest run that can still pass, the outer runs
+  // are cut short.
+  const int maxCount = (3 * total) / 7 + 2;
+  int counts[9] = { 0 };
+
+  // Up/left from the center
+  int i = start;
+  while (i >= 0 && image_->get(x + (i - start) * dx, y + (i - start) * dy) &&
+         counts[4] <= maxCount) {
+    counts[4]++;
+    i--;
+  }
+  const int centerStart = i + 1;
+  for (int k = 3; k >= 0; k--) {
+    const bool black = !(k & 1);
+    while (i >= 0 && image_->get(x + (i - start) * dx, y + (i - start) * dy) == black &&
+           counts[k] <= maxCount) {
+      counts[k]++;
+      i--;
+    }
+    if (!counts[k] || (counts[k] > maxCount && k > 0)) {
+      return -1;
+    }
+  }
+
+  // Down/right from the center
+  i = start + 1;
+  while (i < limit && image_->get(x + (i - start) * dx, y + (i - start) * dy) &&
+         counts[4] <= maxCount) {
+    counts[4]++;
+    i++;
+  }
+  const int centerEnd = i;
+  for (int k = 5; k < 9; k++) {
+    const bool black = !(k & 1);
+    while (i < limit && image_->get(x + (i - start) * dx, y + (i - start) * dy) == black &&
+           counts[k] <= maxCount) {
+      counts[k]++;
+      i++;
+    }
+    if (!counts[k] || (counts[k] > maxCount && k < 8)) {
+      return -1;
+    }
+  }
+
+  int crossTotal = 0;
+  for (int k = 1; k < 8; k++) {
+    crossTotal += counts[k];
+  }
+  if (crossTotal * 2 < total || crossTotal > total * 2 ||
+      !checkRingRatios(counts, crossTotal)) {
+    return -1;
+  }
+  return (centerStart + centerEnd) / 2.0f;
+}
+
+/**
+ * Each of the seven inner runs has to be within half a module (plus a
+ * pixel of binarization jitter) from the average, the outer two only
+ * need to be there. Integer math, this gets called for every run.
+ */
+bool RunLengthDetector::checkRingRatios(const int* counts, int total) {
+  if (total < 7 * MIN_MODULE_SIZE) {
+    return false;
+  }
+  // |c - total/7| <= total/14 + 1/2
+  const int maxVariance = total + 7;
+  for (int i = 1; i < 8; i++) {
+    if (std::abs(14 * counts[i] - 2 * total) > maxVariance) {
+      return false;
+    }
+  }
+  return 14 * counts[0] >= total && 14 * counts[8] >= total;
+}
+
+void RunLengthDetector::findLShapes(const vector<Run>& hruns, const vector<Run>& vruns) {
+  // Horizontal runs are naturally sorted by row, vertical ones by the
+  // row where they end, we need them by column. Counting sort keeps
+  // them sorted by row within each column and gives the column ranges.
+  const int width = image_->getWidth();
+  vector<int> column(width + 1, 0);
+  for (size_t v = 0; v < vruns.size(); v++) {
+    column[vruns[v].pos + 1]++;
+  }
+  for (int x = 0; x < width; x++) {
+    column[x + 1] += column[x];
+  }
+  vector<Run> sorted(vruns.size());
+  vector<int> next(column.begin(), column.end() - 1);
+  for (size_t v = 0; v < vruns.size(); v++) {
+    sorted[next[vruns[v].pos]++] = vruns[v];
+  }
+  // Rows only go down, and so do the first runs worth looking at
+  vector<int> cursor(column.begin(), column.end() - 1);
+
+  // Corners formed by a horizontal and a vertical run sharing an end.
+  // Both runs of a solid border end at the same corner within a couple
+  // of pixels, which is what makes the lookup cheap.
+  vector<LShape> corners;
+  for (size_t h = 0; h < hruns.size(); h++) {
+    const Run& hrun = hruns[h];
+    for (int side = 0; side < 2; side++) {
+      const int cornerX = side ? hrun.end : hrun.start;
+      const int endX = side ? hrun.start : hrun.end;
+      const int fromX = std::max(cornerX - CORNER_TOLERANCE, 0);
+      const int toX = std::min(cornerX + CORNER_TOLERANCE, width - 1);
+      for (int x = fromX; x <= toX; x++) {
+        // Runs in the same column don't overlap, the ones ending above
+        // the row can't be sharing the corner and neither can those
+        // starting below it
+        const int last = column[x + 1];
+        while (cursor[x] < last && sorted[cursor[x]].end < hrun.pos - CORNER_TOLERANCE) {
+          cursor[x]++;
+        }
+        for (int i = cursor[x]; i < last && sorted[i].start <= hrun.pos + CORNER_TOLERANCE; i++) {
+          const Run* v = &sorted[i];
+          int endY;
+          if (std::abs(v->end - hrun.pos) <= CORNER_TOLERANCE) {
+            endY = v->start;
+          } else if (std::abs(v->start - hrun.pos) <= CORNER_TOLERANCE) {
+            endY = v->end;
+          } else {
+            continue;
+          }
+          const int lengthX = std::abs(endX - cornerX) + 1;
+          const int lengthY = std::abs(endY - hrun.pos) + 1;
+          if (lengthX * 4 < lengthY || lengthY * 4 < lengthX) {
+            continue;
+          }
+          LShape corner = { cornerX, hrun.pos, endX, endY, 0, 0 };
+          corners.push_back(corner);
+        }
+      }
+    }
+  }
+
+  cornerCount_ = (int)corners.size();
+
+  // Merge the corners found for the same L, keeping the outermost
+  // corner and the longest arms. Corners come row by row, the shapes
+  // left behind by more than maxDistance rows can't grow anymore.
+  vector<LShape> shapes;
+  const int maxDistance = 4 * CORNER_TOLERANCE;
+  size_t active = 0;
+  for (size_t c = 0; c < corners.size(); c++) {
+    const LShape& corner = corners[c];
+    const int dx = sign(corner.endX - corner.cornerX);
+    const int dy = sign(corner.endY - corner.cornerY);
+    bool merged = false;
+    while (active < shapes.size() &&
+           shapes[active].cornerY + maxDistance < corner.cornerY) {
+      active++;
+    }
+    for (size_t s = active; s < shapes.size() && !merged; s++) {
+      LShape& shape = shapes[s];
+      if (sign(shape.endX - shape.cornerX) == dx &&
+          sign(shape.endY - shape.cornerY) == dy &&
+          std::abs(shape.cornerX - corner.cornerX) <= maxDistance &&
+          std::abs(shape.cornerY - corner.cornerY) <= maxDistance) {
+        if (corner.cornerX * dx < shape.cornerX * dx) shape.cornerX = corner.cornerX;
+        if (corner.cornerY * dy < shape.cornerY * dy) shape.cornerY = corner.cornerY;
+        if (corner.endX * dx > shape.endX * dx) shape.endX = corner.endX;
+        if (corner.endY * dy > shape.endY * dy) shape.endY = corner.endY;
+        merged = true;
+      }
+    }
+    if (!merged) {
+      shapes.push_back(corner);
+    }
+  }
+
+  for (size_t s = 0; s < shapes.size(); s++) {
+    if (verifyLShape(shapes[s])) {
+      lShapes_.push_back(shapes[s]);
+    }
+  }
+  std::stable_sort(lShapes_.begin(), lShapes_.end(), LShapeScoreComparator());
+  if (lShapes_.size() > MAX_CANDIDATES) {
+    lShapes_.resize(MAX_CANDIDATES);
+  }
+}
+
+/**
+ * The arms of a Data Matrix "L" are one module thick and the two sides
+ * opposite to them alternate between black and white (timing pattern).
+ */
+bool RunLengthDetector::verifyLShape(LShape& shape) const {
+  const int dx = sign(shape.endX - shape.cornerX);
+  const int dy = sign(shape.endY - shape.cornerY);
+  const int lengthX = (shape.endX - shape.cornerX) * dx + 1;
+  const int lengthY = (shape.endY - shape.cornerY) * dy + 1;
+
+  // Data modules next to the arm may be black too, the thinner arm
+  // is the better estimate
+  const int thicknessX = thickness(shape.cornerX + dx * (lengthX / 2), shape.cornerY,
+                                   0, dy, lengthY / 4);
+  const int thicknessY = thickness(shape.cornerX, shape.cornerY + dy * (lengthY / 2),
+                                   dx, 0, lengthX / 4);
+  const int moduleSize = std::min(thicknessX, thicknessY);
+  if (moduleSize < 1 || moduleSize * 8 > std::min(lengthX, lengthY)) {
+    return false;
+  }
+
+  const int offset = moduleSize / 2;
+  const int timingX = transitions(shape.cornerX + dx * moduleSize, shape.endY - dy * offset,
+                                  dx, 0, lengthX - moduleSize);
+  const int timingY = transitions(shape.endX - dx * offset, shape.cornerY + dy * moduleSize,
+                                  0, dy, lengthY - moduleSize);
+
+  // Expect at least half of the transitions the size of the module implies
+  if (timingX < 4 || timingY < 4 ||
+      2 * (timingX + 2) * moduleSize < lengthX ||
+      2 * (timingY + 2) * moduleSize < lengthY) {
+    return false;
+  }
+
+  shape.moduleSize = moduleSize;
+  shape.score = timingX + timingY;
+  return true;
+}
+
+int RunLengthDetector::thickness(int x, int y, int dx, int dy, int max) const {
+  const int width = image_->getWidth();
+  const int height = image_->getHeight();
+  int count = 0;
+  while (count < max && x >= 0 && x < width && y >= 0 && y < height && image_->get(x, y)) {
+    count++;
+    x += dx;
+    y += dy;
+  }
+  return count;
+}
+
+int RunLengthDetector::transitions(int x, int y, int dx, int dy, int length) const {
+  const int width = image_->getWidth();
+  const int height = image_->getHeight();
+  if (x < 0 || x >= width || y < 0 || y >= height) {
+    return 0;
+  }
+  int count = 0;
+  bool last = image_->get(x, y);
+  for (int i = 1; i < length; i++) {
+    x += dx;
+    y += dy;
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+      break;
+    }
+    const bool black = image_->get(x, y);
+    if (black != last) {
+      count++;
+      last = black;
+    }
+  }
+  return count;
+}
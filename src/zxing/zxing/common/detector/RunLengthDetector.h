@@ -0,0 +1,105 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __RUNLENGTHDETECTOR_H__
+#define __RUNLENGTHDETECTOR_H__
+
+/*
+ *  RunLengthDetector.h
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include <zxing/common/BitMatrix.h>
+#include <zxing/common/Counted.h>
+
+namespace zxing {
+
+/**
+ * Finds the Aztec bull's eye (concentric rings) and the Data Matrix "L"
+ * (two solid perpendicular borders) in a single pass over the image.
+ * Rows are converted into runs 32 pixels at a time by looking at the
+ * changed bits of each word, vertical runs are tracked at the same time
+ * by comparing each row with the previous one. Rows as busy as noise
+ * are only tracked vertically. The result is cached by BinaryBitmap and
+ * shared by the Aztec and Data Matrix readers.
+ */
+class RunLengthDetector : public Counted {
+ public:
+  struct BullsEye {
+    float x;
+    float y;
+    float moduleSize;
+    int count;
+  };
+
+  // Corner of the L and the far ends of its two arms. The horizontal
+  // arm runs from (cornerX,cornerY) to (endX,cornerY), the vertical one
+  // from (cornerX,cornerY) to (cornerX,endY).
+  struct LShape {
+    int cornerX;
+    int cornerY;
+    int endX;
+    int endY;
+    int moduleSize;
+    int score;
+  };
+
+ private:
+  struct Run {
+    int pos;
+    int start;
+    int end;
+  };
+
+  Ref<BitMatrix> image_;
+  std::vector<BullsEye> bullsEyes_;
+  std::vector<LShape> lShapes_;
+  int edgeCount_;
+  int partialRings_;
+  int cornerCount_;
+
+ public:
+  RunLengthDetector(Ref<BitMatrix> image);
+
+  Ref<BitMatrix> getImage() const { return image_; }
+  const std::vector<BullsEye>& getBullsEyes() const { return bullsEyes_; }
+  const std::vector<LShape>& getLShapes() const { return lShapes_; }
+
+  // Cheap hints that a symbol may be there even if no candidate was
+  // confirmed: rings matching both across and down (but not necessarily
+  // across again at the refined center), pairs of runs meeting at a
+  // corner (verified or not) and the number of black and white
+  // transitions along the rows, which is how busy the image is
+  int getPartialRingCount() const { return partialRings_; }
+  int getCornerCount() const { return cornerCount_; }
+  int getEdgeCount() const { return edgeCount_; }
+
+ private:
+  void scan();
+  void findBullsEyes(int y, const std::vector<int>& edges,
+                     const std::vector<int>& above, std::vector<int>& found);
+  void addBullsEye(float x, float y, float moduleSize);
+  float crossCheck(int x, int y, bool vertical, int total) const;
+  void findLShapes(const std::vector<Run>& hruns, const std::vector<Run>& vruns);
+  bool verifyLShape(LShape& shape) const;
+  int thickness(int x, int y, int dx, int dy, int max) const;
+  int transitions(int x, int y, int dx, int dy, int length) const;
+  static bool checkRingRatios(const int* counts, int total);
+};
+
+}
+
+#endif
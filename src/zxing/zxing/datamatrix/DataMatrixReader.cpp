@@ -21,6 +21,7 @@
 
 #include <zxing/datamatrix/DataMatrixReader.h>
 #include <zxing/datamatrix/detector/Detector.h>
+#include <zxing/NotFoundException.h>
 #include <iostream>
 
 namespace zxing {
@@ -34,13 +35,43 @@ DataMatrixReader::DataMatrixReader() :
 
 Ref<Result> DataMatrixReader::decode(Ref<BinaryBitmap> image, DecodeHints hints) {
   (void)hints;
-  Detector detector(image->getBlackMatrix());
-  Ref<DetectorResult> detectorResult(detector.detect());
-  ArrayRef< Ref<ResultPoint> > points(detectorResult->getPoints());
+  Ref<RunLengthDetector> runs(image->getRunLengthDetector());
+  Detector detector(runs->getImage());
 
+  // Start with the solid borders found by the run scan, they give the
+  // corners right away. The fourth one is placed on the black module
+  // next to the white corner, where WhiteRectangleDetector would put it.
+  // The arms of a rotated symbol aren't made of horizontal and vertical
+  // runs though, the center of the image gets its chance after that.
+  // Unless there was no corner at all and the image is as busy as noise,
+  // WhiteRectangleDetector won't find any white space around a symbol
+  // there anyway.
+  const vector<RunLengthDetector::LShape>& shapes = runs->getLShapes();
+  for (size_t i = 0; i < shapes.size(); i++) {
+    const RunLengthDetector::LShape& shape = shapes[i];
+    const int dy = (shape.endY > shape.cornerY) ? 1 : -1;
+    vector<Ref<ResultPoint> > corners(4);
+    corners[0] = new ResultPoint(shape.cornerX, shape.cornerY);
+    corners[1] = new ResultPoint(shape.endX, shape.cornerY);
+    corners[2] = new ResultPoint(shape.cornerX, shape.endY);
+    corners[3] = new ResultPoint(shape.endX, shape.endY - dy * shape.moduleSize);
+    try {
+      return decodeDetected(detector.detect(corners));
+    } catch (ReaderException const& e) {
+      (void)e;
+    }
+  }
+  Ref<BitMatrix> bits(runs->getImage());
+  if (!runs->getCornerCount() &&
+      runs->getEdgeCount() * 8 > bits->getWidth() * bits->getHeight()) {
+    throw NotFoundException("No L-shape");
+  }
+  return decodeDetected(detector.detect());
+}
 
+Ref<Result> DataMatrixReader::decodeDetected(Ref<DetectorResult> detectorResult) {
+  ArrayRef< Ref<ResultPoint> > points(detectorResult->getPoints());
   Ref<DecoderResult> decoderResult(decoder_.decode(detectorResult->getBits()));
-
   Ref<Result> result(
     new Result(decoderResult->getText(), decoderResult->getRawBytes(), points, BarcodeFormat::DATA_MATRIX));
 
@@ -24,6 +24,7 @@
 #include <zxing/Reader.h>
 #include <zxing/DecodeHints.h>
 #include <zxing/datamatrix/decoder/Decoder.h>
+#include <zxing/common/DetectorResult.h>
 
 namespace zxing {
 namespace datamatrix {
@@ -32,6 +33,8 @@ class DataMatrixReader : public Reader {
 private:
   Decoder decoder_;
 
+  Ref<Result> decodeDetected(Ref<DetectorResult> detectorResult);
+
 public:
   DataMatrixReader();
   virtual Ref<Result> decode(Ref<BinaryBitmap> image, DecodeHints hints);
@@ -23,6 +23,7 @@
 #include <zxing/datamatrix/decoder/DecodedBitStreamParser.h>
 #include <iostream>
 #include <zxing/common/DecoderResult.h>
+#include <zxing/common/CharacterSetDecoder.h>
 
 namespace zxing {
 namespace datamatrix {
@@ -88,7 +89,7 @@ Ref<DecoderResult> DecodedBitStreamParser::decode(ArrayRef<byte> bytes) {
     result << resultTrailer.str();
   }
   ArrayRef<byte> rawBytes(bytes);
-  Ref<String> text(new String(result.str()));
+  Ref<String> text(new String(common::CharacterSetDecoder::toUTF8(result.str())));
   return Ref<DecoderResult>(new DecoderResult(rawBytes, text));
 }
 
@@ -163,12 +164,18 @@ void DecodedBitStreamParser::decodeC40Segment(Ref<BitSource> bits, ostringstream
     if (bits->available() == 8) {
       return;
     }
-    int firstByte = bits->readBits(8);
-    if (firstByte == 254) {  // Unlatch codeword
+    // Three values are packed into two codewords, read both at once
+    int twoBytes;
+    if (!bits->peekBits(16, twoBytes)) {
+      throw FormatException("not enough codewords");
+    }
+    if ((twoBytes >> 8) == 254) {  // Unlatch codeword
+      bits->skipBits(8);
       return;
     }
+    bits->skipBits(16);
 
-    parseTwoBytes(firstByte, bits->readBits(8), cValues);
+    parseTwoBytes(twoBytes >> 8, twoBytes & 0xFF, cValues);
 
     for (int i = 0; i < 3; i++) {
       int cValue = cValues[i];
@@ -240,12 +247,18 @@ void DecodedBitStreamParser::decodeTextSegment(Ref<BitSource> bits, ostringstrea
     if (bits->available() == 8) {
       return;
     }
-    int firstByte = bits->readBits(8);
-    if (firstByte == 254) {  // Unlatch codeword
+    // Three values are packed into two codewords, read both at once
+    int twoBytes;
+    if (!bits->peekBits(16, twoBytes)) {
+      throw FormatException("not enough codewords");
+    }
+    if ((twoBytes >> 8) == 254) {  // Unlatch codeword
+      bits->skipBits(8);
       return;
     }
+    bits->skipBits(16);
 
-    parseTwoBytes(firstByte, bits->readBits(8), cValues);
+    parseTwoBytes(twoBytes >> 8, twoBytes & 0xFF, cValues);
 
     for (int i = 0; i < 3; i++) {
       int cValue = cValues[i];
@@ -315,12 +328,18 @@ void DecodedBitStreamParser::decodeAnsiX12Segment(Ref<BitSource> bits, ostringst
     if (bits->available() == 8) {
       return;
     }
-    int firstByte = bits->readBits(8);
-    if (firstByte == 254) {  // Unlatch codeword
+    // Three values are packed into two codewords, read both at once
+    int twoBytes;
+    if (!bits->peekBits(16, twoBytes)) {
+      throw FormatException("not enough codewords");
+    }
+    if ((twoBytes >> 8) == 254) {  // Unlatch codeword
+      bits->skipBits(8);
       return;
     }
+    bits->skipBits(16);
 
-    parseTwoBytes(firstByte, bits->readBits(8), cValues);
+    parseTwoBytes(twoBytes >> 8, twoBytes & 0xFF, cValues);
 
     for (int i = 0; i < 3; i++) {
       int cValue = cValues[i];
@@ -360,16 +379,18 @@ void DecodedBitStreamParser::decodeEdifactSegment(Ref<BitSource> bits, ostringst
       return;
     }
 
+    // Four 6-bit values are packed into three codewords, read them at once
+    int group;
+    if (!bits->peekBits(24, group)) {
+      throw FormatException("not enough codewords");
+    }
     for (int i = 0; i < 4; i++) {
-      int edifactValue = bits->readBits(6);
+      int edifactValue = (group >> (18 - 6 * i)) & 0x3F;
 
       // Check for the unlatch character
       if (edifactValue == 0x1f) {  // 011111
-        // Read rest of byte, which should be 0, and stop
-        int bitsLeft = 8 - bits->getBitOffset();
-        if (bitsLeft != 8) {
-          bits->readBits(bitsLeft);
-        }
+        // Skip the rest of the byte, which should be 0, and stop
+        bits->skipBits(((6 * (i + 1) + 7) / 8) * 8);
         return;
       }
 
@@ -378,6 +399,7 @@ void DecodedBitStreamParser::decodeEdifactSegment(Ref<BitSource> bits, ostringst
       }
       result << (byte)(edifactValue);
     }
+    bits->skipBits(24);
   } while (bits->available() > 0);
 }
   
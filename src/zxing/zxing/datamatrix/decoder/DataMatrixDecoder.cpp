@@ -69,6 +69,14 @@ Ref<DecoderResult> Decoder::decode(Ref<BitMatrix> bits) {
 
   // Read codewords
   ArrayRef<byte> codewords(parser.readCodewords());
+
+  // Same symbol as in one of the previous frames?
+  const int tag = version->getVersionNumber();
+  Ref<DecoderResult> cached(cache_.find(codewords, tag));
+  if (cached) {
+    return cached;
+  }
+
   // Separate into data blocks
   std::vector<Ref<DataBlock> > dataBlocks = DataBlock::getDataBlocks(codewords, version);
 
@@ -94,7 +102,9 @@ Ref<DecoderResult> Decoder::decode(Ref<BitMatrix> bits) {
   }
   // Decode the contents of that stream of bytes
   DecodedBitStreamParser decodedBSParser;
-  return Ref<DecoderResult> (decodedBSParser.decode(resultBytes));
+  Ref<DecoderResult> result(decodedBSParser.decode(resultBytes));
+  cache_.add(codewords, tag, result);
+  return result;
 }
 
 }
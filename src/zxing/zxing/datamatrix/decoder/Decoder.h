@@ -25,6 +25,7 @@
 #include <zxing/common/Counted.h>
 #include <zxing/common/Array.h>
 #include <zxing/common/DecoderResult.h>
+#include <zxing/common/DecoderResultCache.h>
 #include <zxing/common/BitMatrix.h>
 
 
@@ -34,6 +35,7 @@ namespace datamatrix {
 class Decoder {
 private:
   ReedSolomonDecoder rsDecoder_;
+  DecoderResultCache cache_;
 
   void correctErrors(ArrayRef<byte> bytes, int numDataCodewords);
 
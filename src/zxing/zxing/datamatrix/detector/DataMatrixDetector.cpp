@@ -82,7 +82,15 @@ Ref<BitMatrix> Detector::getImage() {
 
 Ref<DetectorResult> Detector::detect() {
   Ref<WhiteRectangleDetector> rectangleDetector_(new WhiteRectangleDetector(image_));
-  std::vector<Ref<ResultPoint> > ResultPoints = rectangleDetector_->detect();
+  return detect(rectangleDetector_->detect());
+}
+
+/**
+ * Detects the symbol bounded by the given points, in the order returned
+ * by WhiteRectangleDetector (the first and the last are opposite corners,
+ * as are the second and the third).
+ */
+Ref<DetectorResult> Detector::detect(std::vector<Ref<ResultPoint> > const& ResultPoints) {
   Ref<ResultPoint> pointA = ResultPoints[0];
   Ref<ResultPoint> pointB = ResultPoints[1];
   Ref<ResultPoint> pointC = ResultPoints[2];
@@ -83,6 +83,7 @@ class Detector: public Counted {
         int dimensionX, int dimensionY);
 
     Ref<DetectorResult> detect();
+    Ref<DetectorResult> detect(std::vector<Ref<ResultPoint> > const& cornerPoints);
 
   private:
     int compare(Ref<ResultPointsAndTransitions> a, Ref<ResultPointsAndTransitions> b);
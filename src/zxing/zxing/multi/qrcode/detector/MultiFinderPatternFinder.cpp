@@ -136,7 +136,7 @@ vector<Ref<FinderPatternInfo> > MultiFinderPatternFinder::findMulti(DecodeHints
 }
 
 vector<vector<Ref<FinderPattern> > > MultiFinderPatternFinder::selectBestPatterns(){
-  vector<Ref<FinderPattern> > possibleCenters = possibleCenters_;
+  vector<Ref<FinderPattern> > possibleCenters = getPossibleCenters();
   
   int size = possibleCenters.size();
 
@@ -151,7 +151,7 @@ vector<vector<Ref<FinderPattern> > > MultiFinderPatternFinder::selectBestPattern
    * Begin HE modifications to safely detect multiple codes of equal size
    */
   if (size == 3) {
-    results.push_back(possibleCenters_);
+    results.push_back(possibleCenters);
     return results;
   }
 
@@ -76,7 +76,9 @@ const int CodaBarReader::PADDING =
 CodaBarReader::CodaBarReader() 
   : counters(80, 0), counterLength(0) {}
 
-Ref<Result> CodaBarReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::DecodeHints /*hints*/) {
+Ref<Result> CodaBarReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::DecodeHints hints) {
+  vector<int> const& allowedLengths(hints.getAllowedLengths(BarcodeFormat::CODABAR));
+  const int maxLength = maxAllowedLength(allowedLengths);
 
   { // Arrays.fill(counters, 0);
     int size = counters.size();
@@ -103,6 +105,10 @@ Ref<Result> CodaBarReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::De
         arrayContains(STARTEND_ENCODING, ALPHABET[charOffset])) {
       break;
     }
+    // Longer than allowed, even if the next one turns out to be the end
+    if ((int)decodeRowResult.length() - 1 > maxLength) {
+      throw NotFoundException();
+    }
   } while (nextStart < counterLength); // no fixed end pattern so keep on reading while data is available
 
   // Look for whitespace after pattern:
@@ -144,6 +150,10 @@ Ref<Result> CodaBarReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::De
   decodeRowResult.erase(decodeRowResult.length() - 1, 1);
   decodeRowResult.erase(0, 1);
 
+  if (!isAllowedLength(allowedLengths, (int)decodeRowResult.length())) {
+    throw NotFoundException();
+  }
+
   int runningCount = 0;
   for (int i = 0; i < startOffset; i++) {
     runningCount += counters[i];
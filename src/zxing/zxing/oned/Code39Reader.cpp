@@ -92,7 +92,10 @@ Code39Reader::Code39Reader(bool usingCheckDigit_, bool extendedMode_) {
   init(usingCheckDigit_, extendedMode_);
 }
 
-Ref<Result> Code39Reader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::DecodeHints /*hints*/) {
+Ref<Result> Code39Reader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::DecodeHints hints) {
+  vector<int> const& allowedLengths(hints.getAllowedLengths(BarcodeFormat::CODE_39));
+  const int maxLength = maxAllowedLength(allowedLengths);
+
   std::vector<int>& theCounters (counters);
   { // Arrays.fill(counters, 0);
     int size = theCounters.size();
@@ -116,6 +119,10 @@ Ref<Result> Code39Reader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::Dec
     }
     decodedChar = patternToChar(pattern);
     result.append(1, decodedChar);
+    // Don't bother reading any further than the longest allowed string
+    if (decodedChar != '*' && (int)result.length() - (usingCheckDigit ? 1 : 0) > maxLength) {
+      throw NotFoundException();
+    }
     lastStart = nextStart;
     for (int i = 0, end=theCounters.size(); i < end; i++) {
       nextStart += theCounters[i];
@@ -153,6 +160,10 @@ Ref<Result> Code39Reader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::Dec
     // Almost false positive
     throw NotFoundException();
   }
+
+  if (!isAllowedLength(allowedLengths, (int)result.length())) {
+    throw NotFoundException();
+  }
   
   Ref<String> resultString;
   if (extendedMode) {
@@ -41,6 +41,8 @@ public:
                    std::string& resultString);
 
   BarcodeFormat getBarcodeFormat();
+
+  friend class MultiFormatUPCEANReader;
 };
 
 }
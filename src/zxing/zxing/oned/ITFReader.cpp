@@ -45,7 +45,7 @@ const int N = 1; // Pixed width of a narrow line
 
 const int DEFAULT_ALLOWED_LENGTHS_[] =
 { 48, 44, 24, 20, 18, 16, 14, 12, 10, 8, 6 };
-const ArrayRef<int> DEFAULT_ALLOWED_LENGTHS (new Array<int>(VECTOR_INIT(DEFAULT_ALLOWED_LENGTHS_)));
+const vector<int> DEFAULT_ALLOWED_LENGTHS (VECTOR_INIT(DEFAULT_ALLOWED_LENGTHS_));
 
 /**
  * Start/end guard pattern.
@@ -81,36 +81,22 @@ ITFReader::ITFReader() : narrowLineWidth(-1) {
 }
 
 
-Ref<Result> ITFReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::DecodeHints /*hints*/) {
-  // Find out where the Middle section (payload) starts & ends
+Ref<Result> ITFReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::DecodeHints hints) {
+  // To avoid false positives with 2D barcodes (and other patterns), make
+  // an assumption that the decoded string must be one of the known lengths.
+  vector<int> const& hintLengths(hints.getAllowedLengths(BarcodeFormat::ITF));
+  vector<int> const& allowedLengths(hintLengths.empty() ? DEFAULT_ALLOWED_LENGTHS : hintLengths);
 
+  // Find out where the Middle section (payload) starts & ends
   Range startRange = decodeStart(row);
   Range endRange = decodeEnd(row);
 
   std::string result;
-  decodeMiddle(row, startRange[1], endRange[0], result);
-  Ref<String> resultString(new String(result));
-
-  ArrayRef<int> allowedLengths;
-  // Java hints stuff missing
-  if (!allowedLengths) {
-    allowedLengths = DEFAULT_ALLOWED_LENGTHS;
-  }
-
-  // To avoid false positives with 2D barcodes (and other patterns), make
-  // an assumption that the decoded string must be 6, 10 or 14 digits.
-  int length = resultString->size();
-  bool lengthOK = false;
-  for (int i = 0, e = allowedLengths->size(); i < e; i++) {
-    if (length == allowedLengths[i]) {
-      lengthOK = true;
-      break;
-    }
-  }
-
-  if (!lengthOK) {
+  decodeMiddle(row, startRange[1], endRange[0], maxAllowedLength(allowedLengths), result);
+  if (!isAllowedLength(allowedLengths, (int)result.length())) {
     throw FormatException();
   }
+  Ref<String> resultString(new String(result));
 
   ArrayRef< Ref<ResultPoint> > resultPoints(2);
   resultPoints[0] =
@@ -123,12 +109,14 @@ Ref<Result> ITFReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::Decode
 /**
  * @param row          row of black/white values to search
  * @param payloadStart offset of start pattern
+ * @param maxLength    give up once the string gets longer than that
  * @param resultString {@link StringBuffer} to append decoded chars to
  * @throws ReaderException if decoding could not complete successfully
  */
 void ITFReader::decodeMiddle(Ref<BitArray> row,
                              int payloadStart,
                              int payloadEnd,
+                             int maxLength,
                              std::string& resultString) {
   // Digits are interleaved in pairs - 5 black lines for one digit, and the
   // 5
@@ -154,6 +142,9 @@ void ITFReader::decodeMiddle(Ref<BitArray> row,
     resultString.append(1, (byte) ('0' + bestMatch));
     bestMatch = decodeDigit(counterWhite);
     resultString.append(1, (byte) ('0' + bestMatch));
+    if ((int)resultString.length() > maxLength) {
+      throw FormatException();
+    }
 
     for (int i = 0, e = counterDigitPair.size(); i < e; i++) {
       payloadStart += counterDigitPair[i];
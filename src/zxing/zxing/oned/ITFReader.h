@@ -34,7 +34,8 @@ private:
 			
   Range decodeStart(Ref<BitArray> row);
   Range decodeEnd(Ref<BitArray> row);
-  static void decodeMiddle(Ref<BitArray> row, int payloadStart, int payloadEnd, std::string& resultString);
+  static void decodeMiddle(Ref<BitArray> row, int payloadStart, int payloadEnd, int maxLength,
+                           std::string& resultString);
   void validateQuietZone(Ref<BitArray> row, int startPattern);
   static int skipWhiteSpace(Ref<BitArray> row);
 			
@@ -0,0 +1,185 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  MotionDeblur.cpp
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/oned/MotionDeblur.h>
+#include <algorithm>
+
+using zxing::ArrayRef;
+using zxing::oned::MotionDeblur;
+
+namespace {
+  // Anything shorter than that is handled by the sub-pixel edge finder
+  const int MIN_BLUR_LENGTH = 3;
+  // Deconvolution can't restore bars that have been smeared further
+  const int MAX_BLUR_LENGTH = 24;
+  const int MIN_DYNAMIC_RANGE = 24;
+  // Minimum number of full contrast edges to estimate the blur from
+  const int MIN_EDGES = 4;
+}
+
+MotionDeblur::MotionDeblur()
+{
+  widths_.reserve(256);
+}
+
+// A box blur of length L turns each edge into a ramp L pixels long,
+// i.e. a plateau of the gradient L pixels wide. Bars and spaces
+// narrower than L don't reach full contrast and produce narrower
+// plateaus, so only the ramps spanning most of the dynamic range are
+// measured. The median keeps noise from skewing the estimate.
+int MotionDeblur::estimateLength(const byte* l, int width)
+{
+  int min = l[0], max = l[0];
+  for (int x = 1; x < width; x++) {
+    const int v = l[x];
+    if (v < min) {
+      min = v;
+    } else if (v > max) {
+      max = v;
+    }
+  }
+  const int range = max - min;
+  if (range < MIN_DYNAMIC_RANGE) {
+    return 0;
+  }
+
+  const int floor = std::max(2, range / 32);
+  const int fullRise = (range * 3) / 4;
+  widths_.clear();
+  for (int x = 0; x + 1 < width;) {
+    const int g = l[x + 1] - l[x];
+    if (g < floor && g > -floor) {
+      x++;
+      continue;
+    }
+    // Find the extent and the peak of this run of same-signed gradient
+    const int sign = (g > 0) ? 1 : -1;
+    int end = x, peak = 0, top = x;
+    while (end + 1 < width) {
+      const int m = sign * (l[end + 1] - l[end]);
+      if (m < floor) {
+        break;
+      }
+      if (m > peak) {
+        peak = m;
+        top = end;
+      }
+      end++;
+    }
+    if (sign * (l[end] - l[x]) >= fullRise) {
+      // Measure the plateau at half of the peak height
+      const int half = (peak + 1) / 2;
+      int left = top, right = top;
+      while (left > x && sign * (l[left] - l[left - 1]) >= half) {
+        left--;
+      }
+      while (right + 1 < end && sign * (l[right + 2] - l[right + 1]) >= half) {
+        right++;
+      }
+      widths_.push_back(right - left + 1);
+    }
+    x = end;
+  }
+
+  const int count = widths_.size();
+  if (count < MIN_EDGES) {
+    return 0;
+  }
+  std::vector<int>::iterator median = widths_.begin() + count / 2;
+  std::nth_element(widths_.begin(), median, widths_.end());
+  return *median;
+}
+
+// Box filter of the given length, replicating the edge pixels. Boxes
+// of even length are centered by giving half weight to both ends.
+void MotionDeblur::boxFilter(const float* in, float* out, int n, int length)
+{
+  float* s = &sums_[0];
+  s[0] = 0;
+  for (int i = 0; i < n; i++) {
+    s[i + 1] = s[i] + in[i];
+  }
+  const int radius = length / 2;
+  const bool even = !(length & 1);
+  const float scale = 1.0f / length;
+  for (int i = 0; i < n; i++) {
+    const int a = i - radius;
+    const int b = i + radius + 1;
+    float sum = s[std::min(b, n)] - s[std::max(a, 0)];
+    if (a < 0) {
+      sum -= a * in[0];
+    }
+    if (b > n) {
+      sum += (b - n) * in[n - 1];
+    }
+    if (even) {
+      sum -= 0.5f * (in[std::max(a, 0)] + in[std::min(b, n) - 1]);
+    }
+    out[i] = sum * scale;
+  }
+}
+
+bool MotionDeblur::deblur(ArrayRef<byte> const& row, ArrayRef<byte>& out)
+{
+  const int n = row->size();
+  if (n < 2) {
+    return false;
+  }
+  const byte* l = &row[0];
+  const int length = estimateLength(l, n);
+  if (length < MIN_BLUR_LENGTH || length > MAX_BLUR_LENGTH) {
+    return false;
+  }
+
+  // Richardson-Lucy with the box as the point spread function. Values
+  // are offset by one to keep the ratios finite.
+  observed_.resize(n);
+  estimate_.resize(n);
+  buf1_.resize(n);
+  buf2_.resize(n);
+  sums_.resize(n + 1);
+  float* d = &observed_[0];
+  float* u = &estimate_[0];
+  float* c = &buf1_[0];
+  float* r = &buf2_[0];
+  for (int i = 0; i < n; i++) {
+    d[i] = u[i] = l[i] + 1.0f;
+  }
+  for (int k = 0; k < ITERATIONS; k++) {
+    boxFilter(u, c, n, length);
+    for (int i = 0; i < n; i++) {
+      c[i] = d[i] / c[i];
+    }
+    boxFilter(c, r, n, length);
+    for (int i = 0; i < n; i++) {
+      u[i] *= r[i];
+    }
+  }
+
+  if (!out || out->size() != n) {
+    out = ArrayRef<byte>(n);
+  }
+  byte* o = &out[0];
+  for (int i = 0; i < n; i++) {
+    const float v = u[i] - 1.0f;
+    o[i] = (byte)(v <= 0.0f ? 0 : v >= 255.0f ? 255 : (int)(v + 0.5f));
+  }
+  return true;
+}
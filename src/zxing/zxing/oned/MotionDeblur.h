@@ -0,0 +1,66 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __MOTION_DEBLUR_H__
+#define __MOTION_DEBLUR_H__
+
+/*
+ *  MotionDeblur.h
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include <zxing/ZXing.h>
+#include <zxing/common/Array.h>
+
+namespace zxing {
+namespace oned {
+
+/**
+ * Undoes horizontal motion blur in a single row of luminance values.
+ *
+ * Movement along the row during exposure smears every edge into a ramp
+ * as long as the distance travelled, i.e. the row is convolved with a
+ * box. The length of the box is estimated from the width of the ramps
+ * at the strongest edges, then a few Richardson-Lucy iterations restore
+ * the bars. Box filters are computed from running sums, so the cost
+ * doesn't depend on the amount of blur.
+ */
+class MotionDeblur {
+private:
+  static const int ITERATIONS = 24;
+
+  std::vector<int> widths_;
+  std::vector<float> observed_;
+  std::vector<float> estimate_;
+  std::vector<float> buf1_;
+  std::vector<float> buf2_;
+  std::vector<float> sums_;
+
+  int estimateLength(const byte* l, int width);
+  void boxFilter(const float* in, float* out, int n, int length);
+
+public:
+  MotionDeblur();
+
+  // Returns false if the row doesn't appear to be blurred, in which
+  // case the output is left untouched.
+  bool deblur(ArrayRef<byte> const& row, ArrayRef<byte>& out);
+};
+
+}
+}
+
+#endif // __MOTION_DEBLUR_H__
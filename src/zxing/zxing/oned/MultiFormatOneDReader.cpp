@@ -42,7 +42,7 @@ MultiFormatOneDReader::MultiFormatOneDReader(DecodeHints hints) : readers() {
     readers.push_back(Ref<OneDReader>(new MultiFormatUPCEANReader(hints)));
   }
   if (hints.containsFormat(BarcodeFormat::CODE_39)) {
-    readers.push_back(Ref<OneDReader>(new Code39Reader()));
+    readers.push_back(Ref<OneDReader>(new Code39Reader(hints.getAssumeCode39CheckDigit())));
   }
   if (hints.containsFormat(BarcodeFormat::CODE_93)) {
     readers.push_back(Ref<OneDReader>(new Code93Reader()));
@@ -68,7 +68,7 @@ MultiFormatOneDReader::MultiFormatOneDReader(DecodeHints hints) : readers() {
 */
   if (readers.size() == 0) {
     readers.push_back(Ref<OneDReader>(new MultiFormatUPCEANReader(hints)));
-    readers.push_back(Ref<OneDReader>(new Code39Reader()));
+    readers.push_back(Ref<OneDReader>(new Code39Reader(hints.getAssumeCode39CheckDigit())));
     readers.push_back(Ref<OneDReader>(new CodaBarReader()));
     readers.push_back(Ref<OneDReader>(new Code93Reader()));
     readers.push_back(Ref<OneDReader>(new Code128Reader()));
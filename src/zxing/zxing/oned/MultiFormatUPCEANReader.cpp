@@ -21,9 +21,7 @@
 #include <zxing/ZXing.h>
 #include <zxing/oned/MultiFormatUPCEANReader.h>
 #include <zxing/oned/EAN13Reader.h>
-#include <zxing/oned/EAN8Reader.h>
 #include <zxing/oned/UPCEReader.h>
-#include <zxing/oned/UPCAReader.h>
 #include <zxing/oned/OneDResultPoint.h>
 #include <zxing/common/Array.h>
 #include <zxing/ReaderException.h>
@@ -34,82 +32,193 @@ using zxing::NotFoundException;
 using zxing::Ref;
 using zxing::Result;
 using zxing::oned::MultiFormatUPCEANReader;
+using zxing::oned::UPCEANReader;
+using zxing::oned::EAN13Reader;
+using zxing::oned::UPCEReader;
     
 // VC++
 using zxing::DecodeHints;
 using zxing::BitArray;
+using zxing::String;
+using zxing::ResultPoint;
 
-MultiFormatUPCEANReader::MultiFormatUPCEANReader(DecodeHints hints) : readers() {
-  if (hints.containsFormat(BarcodeFormat::EAN_13)) {
-    readers.push_back(Ref<UPCEANReader>(new EAN13Reader()));
-  } else if (hints.containsFormat(BarcodeFormat::UPC_A)) {
-    readers.push_back(Ref<UPCEANReader>(new UPCAReader()));
-  }
-  if (hints.containsFormat(BarcodeFormat::EAN_8)) {
-    readers.push_back(Ref<UPCEANReader>(new EAN8Reader()));
-  }
-  if (hints.containsFormat(BarcodeFormat::UPC_E)) {
-    readers.push_back(Ref<UPCEANReader>(new UPCEReader()));
-  }
-  if (readers.size() == 0) {
-    readers.push_back(Ref<UPCEANReader>(new EAN13Reader()));
+MultiFormatUPCEANReader::MultiFormatUPCEANReader(DecodeHints hints) :
+  ean13(hints.containsFormat(BarcodeFormat::EAN_13)),
+  upcA(hints.containsFormat(BarcodeFormat::UPC_A)),
+  ean8(hints.containsFormat(BarcodeFormat::EAN_8)),
+  upcE(hints.containsFormat(BarcodeFormat::UPC_E)),
+  counters(4, 0) {
+  if (!ean13 && !upcA && !ean8 && !upcE) {
     // UPC-A is covered by EAN-13
-    readers.push_back(Ref<UPCEANReader>(new EAN8Reader()));
-    readers.push_back(Ref<UPCEANReader>(new UPCEReader()));
+    ean13 = ean8 = upcE = true;
   }
 }
 
-#include <typeinfo>
+// Matches the current counters against both odd (L) and even (G) parity
+// patterns. lgMatch is the best match of all (10 and above being G),
+// lMatch is the best L match. Either one is -1 if nothing is close enough.
+void MultiFormatUPCEANReader::matchDigit(int& lgMatch, int& lMatch) {
+  std::vector<int const*> const& patterns(UPCEANReader::L_AND_G_PATTERNS);
+  int bestVariance = UPCEANReader::MAX_AVG_VARIANCE; // worst variance we'll accept
+  lgMatch = lMatch = -1;
+  for (int i = 0, n = patterns.size(); i < n; i++) {
+    if (i == 10) {
+      lMatch = lgMatch;
+    }
+    int variance = patternMatchVariance(counters, patterns[i], UPCEANReader::MAX_INDIVIDUAL_VARIANCE);
+    if (variance < bestVariance) {
+      bestVariance = variance;
+      lgMatch = i;
+    }
+  }
+}
 
-Ref<Result> MultiFormatUPCEANReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::DecodeHints /*hints*/) {
-  // Compute this location once and reuse it on multiple implementations
-  UPCEANReader::Range startGuardPattern = UPCEANReader::findStartGuardPattern(row);
-  for (int i = 0, e = readers.size(); i < e; i++) {
-    Ref<UPCEANReader> reader = readers[i];
-    Ref<Result> result;
-    try {
-      result = reader->decodeRow(rowNumber, row, startGuardPattern);
-    } catch (ReaderException const& ignored) {
-      (void)ignored;
-      continue;
+// Appends count odd parity digits, returns false if any of them doesn't match
+bool MultiFormatUPCEANReader::decodeDigits(Ref<BitArray> row, int rowOffset, int count,
+                                           std::string& digits, int& end) {
+  const int size = row->getSize();
+  for (int x = 0; x < count; x++) {
+    if (rowOffset >= size) {
+      return false;
+    }
+    recordPattern(row, rowOffset, counters);
+    int lgMatch, lMatch;
+    matchDigit(lgMatch, lMatch);
+    if (lMatch < 0) {
+      return false;
+    }
+    digits.append(1, (char) ('0' + lMatch));
+    for (int i = 0, e = counters.size(); i < e; i++) {
+      rowOffset += counters[i];
     }
+  }
+  end = rowOffset;
+  return true;
+}
 
-    //added this because reader->decodeRow returns null if row is null
-    //TODO: investigate why the execution reaches here with empty row.
-    if(result.empty())
-        continue;
+// Checks the end guard, the quiet zone and the checksum of the digits
+// collected in text. Returns null if something doesn't fit.
+Ref<Result> MultiFormatUPCEANReader::decodeEnd(int rowNumber, Ref<BitArray> row,
+                                               UPCEANReader::Range const& startRange, int endStart,
+                                               bool upcEEnd, BarcodeFormat format) {
+  UPCEANReader::Range endRange = upcEEnd ?
+    UPCEReader::findEndGuardPattern(row, endStart) :
+    UPCEANReader::findGuardPattern(row, endStart, false, UPCEANReader::START_END_PATTERN);
 
-    // Special case: a 12-digit code encoded in UPC-A is identical
-    // to a "0" followed by those 12 digits encoded as EAN-13. Each
-    // will recognize such a code, UPC-A as a 12-digit string and
-    // EAN-13 as a 13-digit string starting with "0".  Individually
-    // these are correct and their readers will both read such a
-    // code and correctly call it EAN-13, or UPC-A, respectively.
-    //
-    // In this case, if we've been looking for both types, we'd like
-    // to call it a UPC-A code. But for efficiency we only run the
-    // EAN-13 decoder to also read UPC-A. So we special case it
-    // here, and convert an EAN-13 result to a UPC-A result if
-    // appropriate.
-    bool ean13MayBeUPCA =
-      result->getBarcodeFormat() == BarcodeFormat::EAN_13 &&
-      result->getText()->charAt(0) == '0';
+  // Make sure there is a quiet zone at least as big as the end pattern after the barcode.
+  int end = endRange[1];
+  int quietEnd = end + (end - endRange[0]);
+  if (quietEnd >= row->getSize() || !row->isRange(end, quietEnd, false)) {
+    return Ref<Result>();
+  }
 
-    // Note: doesn't match Java which uses hints
+  Ref<String> resultString(new String(text));
+  if (!UPCEANReader::checkStandardUPCEANChecksum((format == BarcodeFormat::UPC_E) ?
+      UPCEReader::convertUPCEtoUPCA(resultString) : resultString)) {
+    return Ref<Result>();
+  }
 
-    bool canReturnUPCA = true;
+  float left = (float) (startRange[1] + startRange[0]) / 2.0f;
+  float right = (float) (endRange[1] + endRange[0]) / 2.0f;
+  ArrayRef< Ref<ResultPoint> > resultPoints(2);
+  resultPoints[0] = Ref<ResultPoint>(new OneDResultPoint(left, (float) rowNumber));
+  resultPoints[1] = Ref<ResultPoint>(new OneDResultPoint(right, (float) rowNumber));
+  return Ref<Result>(new Result(resultString, ArrayRef<byte>(), resultPoints, format));
+}
 
-    if (ean13MayBeUPCA && canReturnUPCA) {
-      // Transfer the metdata across
-      Ref<Result> resultUPCA (new Result(result->getText()->substring(1),
-                                         result->getRawBytes(),
-                                         result->getResultPoints(),
-                                         BarcodeFormat::UPC_A));
-      // needs java metadata stuff
-      return resultUPCA;
+Ref<Result> MultiFormatUPCEANReader::decodeRow(int rowNumber, Ref<BitArray> row, zxing::DecodeHints /*hints*/) {
+  // Compute this location once and reuse it for all the variants
+  UPCEANReader::Range startGuardPattern = UPCEANReader::findStartGuardPattern(row);
+
+  // All variants start with at least four digits. The first six are
+  // decoded once, EAN-13 and UPC-E tell something from their parity,
+  // EAN-8 needs the first four of them to be of odd parity.
+  const int size = row->getSize();
+  char lgDigits[6], lDigits[4];
+  int offsets[7];
+  int lgPatternFound = 0;
+  int count = 0, lCount = 0;
+  int rowOffset = startGuardPattern[1];
+  offsets[0] = rowOffset;
+  try {
+    while (count < 6 && rowOffset < size) {
+      recordPattern(row, rowOffset, counters);
+      int lgMatch, lMatch;
+      matchDigit(lgMatch, lMatch);
+      if (lgMatch < 0) {
+        break;
+      }
+      if (lCount == count && lCount < 4 && lMatch >= 0) {
+        lDigits[lCount++] = (char) ('0' + lMatch);
+      }
+      lgDigits[count] = (char) ('0' + lgMatch % 10);
+      if (lgMatch >= 10) {
+        lgPatternFound |= 1 << (5 - count);
+      }
+      for (int i = 0, e = counters.size(); i < e; i++) {
+        rowOffset += counters[i];
+      }
+      offsets[++count] = rowOffset;
     }
-    return result;
+  } catch (ReaderException const& ignored) {
+    (void)ignored;
   }
 
-  throw NotFoundException();
+  Ref<Result> result;
+  int end;
+  if ((ean13 || upcA) && count == 6) {
+    try {
+      text.assign(lgDigits, 6);
+      EAN13Reader::determineFirstDigit(text, lgPatternFound);
+      UPCEANReader::Range middleRange =
+        UPCEANReader::findGuardPattern(row, offsets[6], true, UPCEANReader::MIDDLE_PATTERN);
+      if (decodeDigits(row, middleRange[1], 6, text, end)) {
+        // Special case: a 12-digit code encoded in UPC-A is identical
+        // to a "0" followed by those 12 digits encoded as EAN-13. Each
+        // will recognize such a code, UPC-A as a 12-digit string and
+        // EAN-13 as a 13-digit string starting with "0".  Individually
+        // these are correct and their readers will both read such a
+        // code and correctly call it EAN-13, or UPC-A, respectively.
+        //
+        // In this case, we'd like to call it a UPC-A code. The leading
+        // zero doesn't affect the checksum, so it's dropped right here
+        // and the result is created only once.
+        // Note: doesn't match Java which uses hints
+        if (text[0] == '0') {
+          text.erase(0, 1);
+          result = decodeEnd(rowNumber, row, startGuardPattern, end, false, BarcodeFormat::UPC_A);
+        } else if (ean13) {
+          result = decodeEnd(rowNumber, row, startGuardPattern, end, false, BarcodeFormat::EAN_13);
+        }
+      }
+    } catch (ReaderException const& ignored) {
+      (void)ignored;
+    }
+  }
+  if (!result && ean8 && lCount == 4) {
+    try {
+      text.assign(lDigits, 4);
+      UPCEANReader::Range middleRange =
+        UPCEANReader::findGuardPattern(row, offsets[4], true, UPCEANReader::MIDDLE_PATTERN);
+      if (decodeDigits(row, middleRange[1], 4, text, end)) {
+        result = decodeEnd(rowNumber, row, startGuardPattern, end, false, BarcodeFormat::EAN_8);
+      }
+    } catch (ReaderException const& ignored) {
+      (void)ignored;
+    }
+  }
+  if (!result && upcE && count == 6) {
+    text.assign(lgDigits, 6);
+    if (UPCEReader::determineNumSysAndCheckDigit(text, lgPatternFound)) {
+      try {
+        result = decodeEnd(rowNumber, row, startGuardPattern, offsets[6], true, BarcodeFormat::UPC_E);
+      } catch (ReaderException const& ignored) {
+        (void)ignored;
+      }
+    }
+  }
+  if (!result) {
+    throw NotFoundException();
+  }
+  return result;
 }
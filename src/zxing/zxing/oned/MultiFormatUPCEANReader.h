@@ -25,11 +25,22 @@
 namespace zxing {
 namespace oned {
 
-class UPCEANReader;
-
 class MultiFormatUPCEANReader : public OneDReader {
 private:
-    std::vector< Ref<UPCEANReader> > readers;
+  bool ean13;
+  bool upcA;
+  bool ean8;
+  bool upcE;
+
+  // Keep these to avoid reallocations
+  std::vector<int> counters;
+  std::string text;
+
+  void matchDigit(int& lgMatch, int& lMatch);
+  bool decodeDigits(Ref<BitArray> row, int rowOffset, int count, std::string& digits, int& end);
+  Ref<Result> decodeEnd(int rowNumber, Ref<BitArray> row, Range const& startRange, int endStart,
+                        bool upcEEnd, BarcodeFormat format);
+
 public:
     MultiFormatUPCEANReader(DecodeHints hints);
     Ref<Result> decodeRow(int rowNumber, Ref<BitArray> row, DecodeHints hints);
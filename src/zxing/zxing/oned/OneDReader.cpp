@@ -19,6 +19,9 @@
 #include <zxing/oned/OneDReader.h>
 #include <zxing/ReaderException.h>
 #include <zxing/oned/OneDResultPoint.h>
+#include <zxing/common/GlareMask.h>
+#include <zxing/oned/MotionDeblur.h>
+#include <zxing/oned/SubPixelRow.h>
 #include <zxing/NotFoundException.h>
 #include <math.h>
 #include <limits.h>
@@ -29,12 +32,17 @@ using zxing::Ref;
 using zxing::Result;
 using zxing::NotFoundException;
 using zxing::oned::OneDReader;
+using zxing::oned::MotionDeblur;
+using zxing::oned::SubPixelRow;
 
 // VC++
 using zxing::BinaryBitmap;
 using zxing::BitArray;
+using zxing::GlareMask;
 using zxing::DecodeHints;
 
+OneDReader::OneDReader() {}
+
 Ref<Result> OneDReader::decode(Ref<BinaryBitmap> image, DecodeHints hints) {
   try {
     return doDecode(image, hints);
@@ -81,6 +89,16 @@ Ref<Result> OneDReader::doDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
   } else {
     maxLines = 15; // 15 rows spaced 1/32 apart is roughly the middle half of the image
   }
+  const size_t maxGlareRows = maxLines;
+  vector<int> glareRows;
+
+  // Scratch buffers, reused from row to row. They are local so that
+  // the reader itself stays free of per-decode state.
+  SubPixelRow subPixelRow;
+  MotionDeblur motionDeblur;
+  ArrayRef<byte> luminances(0);
+  ArrayRef<byte> deblurred(0);
+  Ref<BitArray> subPixelBits;
 
   for (int x = 0; x < maxLines; x++) {
 
@@ -103,6 +121,19 @@ Ref<Result> OneDReader::doDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
       break;
     }
 
+    // A row crossing a highlight is unlikely to decode, spend the
+    // attempt on another row first and come back to this one later
+    luminances = image->getLuminanceSource()->getRow(rowNumber, luminances);
+    if (GlareMask::detectInRow(&luminances[0], width)) {
+      if (glareRows.size() < maxGlareRows) {
+        glareRows.push_back(rowNumber);
+      }
+      if (maxLines < height) {
+        maxLines++;
+      }
+      continue;
+    }
+
     // Estimate black point for this row and load it:
     try {
       row = image->getBlackRow(rowNumber, row);
@@ -111,41 +142,95 @@ Ref<Result> OneDReader::doDecode(Ref<BinaryBitmap> image, DecodeHints hints) {
       continue;
     }
 
-    // While we have the image data in a BitArray, it's fairly cheap to reverse it in place to
-    // handle decoding upside down barcodes.
-    for (int attempt = 0; attempt < 2; attempt++) {
-      if (attempt == 1) {
-        row->reverse(); // reverse the row and continue
-      }
+    Ref<Result> result = decodeBothWays(rowNumber, row, 1, hints);
+    if (result) {
+      return result;
+    }
 
-      try {
-        // Look for a barcode
-        // std::cerr << "rn " << rowNumber << " " << typeid(*this).name() << std::endl;
-        Ref<Result> result = decodeRow(rowNumber, row, hints);
-        // We found our barcode
-        if (attempt == 1) {
-          // But it was upside down, so note that
-          // result.putMetadata(ResultMetadataType.ORIENTATION, new Integer(180));
-          // And remember to flip the result points horizontally.
-          ArrayRef< Ref<ResultPoint> > points(result->getResultPoints());
-          if (points) {
-            points[0] = Ref<ResultPoint>(new OneDResultPoint(width - points[0]->getX() - 1,
-                                                             points[0]->getY()));
-            points[1] = Ref<ResultPoint>(new OneDResultPoint(width - points[1]->getX() - 1,
-                                                             points[1]->getY()));
-            
+    // Thresholding rounds every bar to whole pixels, which is too coarse
+    // for narrow or blurry bars. Locate the edges in the grayscale row
+    // instead and try again at sub-pixel resolution.
+    Ref<BitArray> bits = subPixelRow.sample(luminances, subPixelBits);
+    if (bits) {
+      subPixelBits = bits;
+      result = decodeBothWays(rowNumber, bits, SubPixelRow::SCALE, hints);
+      if (result) {
+        return result;
+      }
+      // The row looks like a barcode but doesn't decode. If that's
+      // because it's smeared by motion, deconvolution may bring it back.
+      if (hints.getMotionDeblur() &&
+          motionDeblur.deblur(luminances, deblurred)) {
+        bits = subPixelRow.threshold(deblurred, subPixelBits);
+        if (bits) {
+          result = decodeBothWays(rowNumber, bits, SubPixelRow::SCALE, hints);
+          if (result) {
+            return result;
           }
         }
-        return result;
-      } catch (ReaderException const& re) {
-        (void)re;
-        continue;
       }
     }
   }
+
+  // A highlight running across the barcode (common on glossy bottles)
+  // hits every row. Those rows still have a chance with the glare
+  // filled in from the bars on either side of it.
+  for (size_t i = 0; i < glareRows.size(); i++) {
+    const int rowNumber = glareRows[i];
+    luminances = image->getLuminanceSource()->getRow(rowNumber, luminances);
+    try {
+      row = image->getBlackRow(rowNumber, row);
+    } catch (NotFoundException const& ignored) {
+      (void)ignored;
+      continue;
+    }
+    GlareMask::fill(&luminances[0], width, row);
+    Ref<Result> result = decodeBothWays(rowNumber, row, 1, hints);
+    if (result) {
+      return result;
+    }
+  }
   throw NotFoundException();
 }
 
+// Returns an empty reference if there's no barcode on this row. The row
+// may be sampled at a higher resolution than the image, in which case
+// scale is the number of row bits per image pixel.
+Ref<Result> OneDReader::decodeBothWays(int rowNumber, Ref<BitArray> row,
+                                       int scale, DecodeHints hints) {
+  // While we have the image data in a BitArray, it's fairly cheap to reverse it in place to
+  // handle decoding upside down barcodes.
+  const int size = row->getSize();
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (attempt == 1) {
+      row->reverse(); // reverse the row and continue
+    }
+
+    try {
+      // Look for a barcode
+      Ref<Result> result = decodeRow(rowNumber, row, hints);
+      // We found our barcode
+      ArrayRef< Ref<ResultPoint> > points(result->getResultPoints());
+      if (points && (attempt == 1 || scale != 1)) {
+        // If it was upside down, remember to flip the result points horizontally.
+        // result.putMetadata(ResultMetadataType.ORIENTATION, new Integer(180));
+        for (int i = 0; i < 2; i++) {
+          float x = points[i]->getX();
+          if (attempt == 1) {
+            x = size - x - 1;
+          }
+          points[i] = Ref<ResultPoint>(new OneDResultPoint(x / scale, points[i]->getY()));
+        }
+      }
+      return result;
+    } catch (ReaderException const& re) {
+      (void)re;
+      continue;
+    }
+  }
+  return Ref<Result>();
+}
+
 int OneDReader::patternMatchVariance(vector<int>& counters,
                                      vector<int> const& pattern,
                                      int maxIndividualVariance) {
@@ -186,6 +271,16 @@ int OneDReader::patternMatchVariance(vector<int>& counters,
   return totalVariance / total;
 }
 
+bool OneDReader::isAllowedLength(vector<int> const& allowedLengths, int length) {
+  return allowedLengths.empty() ||
+    std::find(allowedLengths.begin(), allowedLengths.end(), length) != allowedLengths.end();
+}
+
+int OneDReader::maxAllowedLength(vector<int> const& allowedLengths) {
+  return allowedLengths.empty() ? INT_MAX :
+    *std::max_element(allowedLengths.begin(), allowedLengths.end());
+}
+
 void OneDReader::recordPattern(Ref<BitArray> row,
                                int start,
                                vector<int>& counters) {
@@ -30,6 +30,7 @@ namespace oned {
 class OneDReader : public Reader {
 private:
   Ref<Result> doDecode(Ref<BinaryBitmap> image, DecodeHints hints);
+  Ref<Result> decodeBothWays(int rowNumber, Ref<BitArray> row, int scale, DecodeHints hints);
 
 protected:
   static const int INTEGER_MATH_SHIFT = 8;
@@ -58,10 +59,15 @@ protected:
                                   int const pattern[],
                                   int maxIndividualVariance);
 
+  // See DecodeHints::setAllowedLengths(). Empty list allows any length.
+  static bool isAllowedLength(std::vector<int> const& allowedLengths, int length);
+  static int maxAllowedLength(std::vector<int> const& allowedLengths);
+
 protected:
   static const int PATTERN_MATCH_RESULT_SCALE_FACTOR = 1 << INTEGER_MATH_SHIFT;
 
 public:
+  OneDReader();
 
   virtual Ref<Result> decode(Ref<BinaryBitmap> image, DecodeHints hints);
 
@@ -0,0 +1,242 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+/*
+ *  SubPixelRow.cpp
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zxing/oned/SubPixelRow.h>
+#include <algorithm>
+
+using zxing::Ref;
+using zxing::ArrayRef;
+using zxing::BitArray;
+using zxing::oned::SubPixelRow;
+
+namespace {
+  // A barcode row has at least this many edges (even the shortest
+  // EAN-8 has 43 and Code 39 has 30 for a single character)
+  const int MIN_EDGES = 20;
+  // Rows with less contrast than this are not worth looking at
+  const int MIN_DYNAMIC_RANGE = 24;
+  const int MIN_EDGE_STRENGTH = 8;
+  // Number of bars and spaces checked by isStartPattern()
+  const int GUARD_ELEMENTS = 6;
+  const float MAX_ELEMENT_MODULES = 4.5f;
+  const float MIN_QUIET_ZONE_MODULES = 6.0f;
+}
+
+SubPixelRow::SubPixelRow()
+{
+  gradient_.reserve(1024);
+  edges_.reserve(256);
+}
+
+// Gradient magnitude as seen from an edge of the given sign. Neighbours
+// sloping the other way belong to the adjacent edge and count as flat.
+inline int SubPixelRow::magnitude(int g, int sign)
+{
+  return ((g ^ sign) < 0) ? 0 : (g < 0 ? -g : g);
+}
+
+// Returns false if the row doesn't have enough contrast to bother
+bool SubPixelRow::getRange(const byte* l, int width, int& min, int& max)
+{
+  min = max = l[0];
+  for (int x = 1; x < width; x++) {
+    const int v = l[x];
+    if (v < min) {
+      min = v;
+    } else if (v > max) {
+      max = v;
+    }
+  }
+  return (max - min) >= MIN_DYNAMIC_RANGE;
+}
+
+Ref<BitArray> SubPixelRow::sample(ArrayRef<byte> const& luminances, Ref<BitArray> row)
+{
+  const int width = luminances->size();
+  if (width < 3) {
+    return Ref<BitArray>();
+  }
+
+  const byte* l = &luminances[0];
+  int min, max;
+  if (!getRange(l, width, min, max)) {
+    return Ref<BitArray>();
+  }
+
+  // The gradient at index x sits halfway between pixels x and x + 1
+  const int n = width - 1;
+  gradient_.resize(n);
+  int* g = &gradient_[0];
+  for (int x = 0; x < n; x++) {
+    g[x] = l[x + 1] - l[x];
+  }
+
+  // Edges are local maxima of the gradient magnitude. Two edges of the
+  // same sign in a row mean that a bar or space was too faint to make
+  // it over the threshold; keep the stronger of the two.
+  const int threshold = std::max(MIN_EDGE_STRENGTH, (max - min) / 8);
+  edges_.clear();
+  for (int x = 0; x < n; x++) {
+    const int gx = g[x];
+    const int m = gx < 0 ? -gx : gx;
+    if (m < threshold) {
+      continue;
+    }
+    const int prev = (x > 0) ? magnitude(g[x - 1], gx) : 0;
+    const int next = (x + 1 < n) ? magnitude(g[x + 1], gx) : 0;
+    if (m < prev || m <= next) {
+      continue;
+    }
+    // Vertex of the parabola through (-1,prev) (0,m) (1,next)
+    float offset = 0.0f;
+    const int d = prev - 2 * m + next;
+    if (d < 0) {
+      offset = 0.5f * (prev - next) / d;
+    }
+    Edge edge;
+    edge.position = x + 0.5f + offset;
+    edge.strength = gx;
+    if (!edges_.empty() && ((edges_.back().strength ^ gx) >= 0)) {
+      Edge& last = edges_.back();
+      if (m > (last.strength < 0 ? -last.strength : last.strength)) {
+        last = edge;
+      }
+    } else {
+      edges_.push_back(edge);
+    }
+  }
+
+  return render(width, row);
+}
+
+Ref<BitArray> SubPixelRow::threshold(ArrayRef<byte> const& luminances, Ref<BitArray> row)
+{
+  const int width = luminances->size();
+  if (width < 3) {
+    return Ref<BitArray>();
+  }
+
+  const byte* l = &luminances[0];
+  int min, max;
+  if (!getRange(l, width, min, max)) {
+    return Ref<BitArray>();
+  }
+
+  // Interpolate between the two pixels on either side of the crossing
+  const float middle = (min + max) / 2.0f;
+  edges_.clear();
+  bool dark = l[0] < middle;
+  for (int x = 0; x + 1 < width; x++) {
+    const int a = l[x], b = l[x + 1];
+    if ((b < middle) != dark) {
+      Edge edge;
+      edge.position = x + (a - middle) / (a - b);
+      edge.strength = b - a;
+      edges_.push_back(edge);
+      dark = !dark;
+    }
+  }
+  return render(width, row);
+}
+
+// Checks whether the elements at [start, start + GUARD_ELEMENTS) could
+// be a start or guard pattern next to a quiet zone of the given width.
+// Bars and spaces of all the supported symbologies are 1 to 4 modules
+// wide and the quiet zone is about 10 modules.
+bool SubPixelRow::isStartPattern(int start, float quiet) const
+{
+  const Edge* e = &edges_[start];
+  float narrowest = e[1].position - e[0].position;
+  float widest = narrowest;
+  for (int k = 1; k < GUARD_ELEMENTS; k++) {
+    const float w = e[k + 1].position - e[k].position;
+    if (w < narrowest) {
+      narrowest = w;
+    } else if (w > widest) {
+      widest = w;
+    }
+  }
+  return widest <= MAX_ELEMENT_MODULES * narrowest &&
+    quiet >= MIN_QUIET_ZONE_MODULES * narrowest &&
+    quiet >= widest;
+}
+
+// Looks for a light gap followed by something that may be a start or
+// guard pattern, in either direction (the row may be upside down).
+// Rows without one can't be decoded by any of the readers, and most
+// of the rows don't contain a barcode at all.
+bool SubPixelRow::hasStartPattern(int width) const
+{
+  const int count = edges_.size();
+  const Edge* e = &edges_[0];
+  for (int i = 0; i < count; i++) {
+    if (e[i].strength < 0) {
+      // Light to dark, a bar starts after a space
+      if (i + GUARD_ELEMENTS < count &&
+          isStartPattern(i, e[i].position - (i ? e[i - 1].position : 0.0f))) {
+        return true;
+      }
+    } else if (i >= GUARD_ELEMENTS) {
+      // Dark to light, a bar ends before a space
+      const float next = (i + 1 < count) ? e[i + 1].position : (float)width;
+      if (isStartPattern(i - GUARD_ELEMENTS, next - e[i].position)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Renders the edges found by sample() or threshold() into the row
+Ref<BitArray> SubPixelRow::render(int width, Ref<BitArray> row)
+{
+  const int count = edges_.size();
+  if (count < MIN_EDGES || !hasStartPattern(width)) {
+    return Ref<BitArray>();
+  }
+
+  // A rising edge (dark to light) ends a bar, a falling one starts it.
+  // Pixel centers are at x + 0.5 in edge coordinates.
+  const int size = width * SCALE;
+  if (!row || row->getSize() != size) {
+    row = new BitArray(size);
+  } else {
+    row->clear();
+  }
+  const Edge* e = &edges_[0];
+  int start = (e[0].strength > 0) ? 0 : -1;
+  for (int i = 0; i < count; i++) {
+    const int pos = (int)(e[i].position * SCALE + 0.5f);
+    if (e[i].strength < 0) {
+      start = pos;
+    } else if (start >= 0) {
+      for (int x = start; x < pos; x++) {
+        row->set(x);
+      }
+      start = -1;
+    }
+  }
+  if (start >= 0) {
+    for (int x = start; x < size; x++) {
+      row->set(x);
+    }
+  }
+  return row;
+}
@@ -0,0 +1,77 @@
+// -*- mode:c++; tab-width:2; indent-tabs-mode:nil; c-basic-offset:2 -*-
+#ifndef __SUB_PIXEL_ROW_H__
+#define __SUB_PIXEL_ROW_H__
+
+/*
+ *  SubPixelRow.h
+ *  zxing
+ *
+ *  Copyright 2020 ZXing authors All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include <zxing/common/Array.h>
+#include <zxing/common/BitArray.h>
+
+namespace zxing {
+namespace oned {
+
+/**
+ * Turns a row of luminance values into a bar/space row without a global
+ * threshold. Bar edges are located at the peaks of the luminance
+ * gradient and refined to a fraction of a pixel by fitting a parabola
+ * through the peak and its neighbours. The result is rendered SCALE
+ * times wider than the source row, so that the existing row decoders
+ * see bar widths to 1/SCALE of a pixel. This is what makes narrow
+ * modules (1-2 pixels) and blurry edges decodable, where thresholding
+ * rounds every width to a whole pixel and often to the wrong one.
+ */
+class SubPixelRow {
+public:
+  static const int SCALE = 4;
+
+private:
+  struct Edge {
+    float position;
+    int strength;  // Negative when going from light to dark
+  };
+
+  std::vector<int> gradient_;
+  std::vector<Edge> edges_;
+
+  static int magnitude(int g, int sign);
+  static bool getRange(const byte* l, int width, int& min, int& max);
+  bool isStartPattern(int start, float quiet) const;
+  bool hasStartPattern(int width) const;
+  Ref<BitArray> render(int width, Ref<BitArray> row);
+
+public:
+  SubPixelRow();
+
+  // Returns an empty reference if the row doesn't have enough edges
+  // to possibly contain a barcode, or nothing that looks like a quiet
+  // zone followed by a start or guard pattern.
+  Ref<BitArray> sample(ArrayRef<byte> const& luminances, Ref<BitArray> row);
+
+  // Same as above but places the edges where the luminance crosses the
+  // middle of its range. That ignores the ripples which deconvolution
+  // leaves around the edges but requires the full contrast restored.
+  Ref<BitArray> threshold(ArrayRef<byte> const& luminances, Ref<BitArray> row);
+};
+
+}
+}
+
+#endif // __SUB_PIXEL_ROW_H__
@@ -79,6 +79,10 @@ int UPCEReader::decodeMiddle(Ref<BitArray> row, Range const& startRange, string&
 }
 
 UPCEReader::Range UPCEReader::decodeEnd(Ref<BitArray> row, int endStart) {
+  return findEndGuardPattern(row, endStart);
+}
+
+UPCEReader::Range UPCEReader::findEndGuardPattern(Ref<BitArray> row, int endStart) {
   return findGuardPattern(row, endStart, true, MIDDLE_END_PATTERN);
 }
 
@@ -28,6 +28,7 @@ class UPCEReader : public UPCEANReader {
 private:
   std::vector<int> decodeMiddleCounters;
   static bool determineNumSysAndCheckDigit(std::string& resultString, int lgPatternFound);
+  static Range findEndGuardPattern(Ref<BitArray> row, int endStart);
 
 protected:
   Range decodeEnd(Ref<BitArray> row, int endStart);
@@ -39,6 +40,8 @@ public:
   static Ref<String> convertUPCEtoUPCA(Ref<String> const& upce);
 
   BarcodeFormat getBarcodeFormat();
+
+  friend class MultiFormatUPCEANReader;
 };
 
 }
@@ -65,7 +65,6 @@ public:
 private:
   bool VerifyOuterColumns(int rownumber);
   static ArrayRef<int> trimArray(ArrayRef<int> array, int size);
-  static int findCodewordIndex(int64_t symbol);
 
   
   int processRow(int rowNumber,
@@ -24,6 +24,7 @@
  */
 
 #include <zxing/pdf417/decoder/BitMatrixParser.h>
+#include <string.h>
 
 using zxing::pdf417::decoder::BitMatrixParser;
 using zxing::ArrayRef;
@@ -201,18 +202,57 @@ ArrayRef<int> BitMatrixParser::trimArray(ArrayRef<int> array, int size)
   * @return the codeword corresponding to the symbol.
   */
 
+namespace {
+
+/**
+  * Every valid symbol is 17 modules wide and starts with a bar and ends
+  * with a space, i.e. it's 1xxxxxxxxxxxxxxx0 in binary. The 15 bits in
+  * between are unique, so they can index the table directly. Each entry
+  * holds CODEWORD_TABLE value (cluster * 929 + codeword + 1) or zero
+  * if there's no such symbol.
+  */
+class SymbolLookup {
+public:
+  static const int BITS = 15;
+  static const int64_t MASK = 0x30001;
+  static const int64_t MATCH = 0x10000;
+
+  SymbolLookup() {
+    memset(table_, 0, sizeof(table_));
+    for (int i = 0; i < BitMatrixParser::SYMBOL_TABLE_LENGTH; i++) {
+      table_[index(BitMatrixParser::SYMBOL_TABLE[i])] =
+        (unsigned short)BitMatrixParser::CODEWORD_TABLE[i];
+    }
+  }
+
+  int get(int64_t symbol) const {
+    // The mask makes sure that index 0 (which is never a valid symbol)
+    // is used for anything that doesn't look like 1xxxxxxxxxxxxxxx0
+    return table_[index(symbol) & -(int)((symbol & MASK) == MATCH)];
+  }
+
+private:
+  static int index(int64_t symbol) {
+    return (int)(symbol >> 1) & ((1 << BITS) - 1);
+  }
+
+  unsigned short table_[1 << BITS];
+};
+
+}
+
 /**
   * 2012-06-27 hfn With the second argument, it is possible to verify in which of the three
   * "blocks" of the codeword table the codeword has been found: 0, 1 or 2.
   */
 int BitMatrixParser::getCodeword(int64_t symbol, int *pi)
 {
-  int64_t sym = symbol & 0x3FFFF;
-  int i = findCodewordIndex(sym);
-  if (i == -1) {
+  static const SymbolLookup lookup;
+  int entry = lookup.get(symbol & 0x3FFFF);
+  if (!entry) {
     return -1;
   } else {
-    int cw = CODEWORD_TABLE[i] - 1;
+    int cw = entry - 1;
     if (pi!= NULL) {
       *pi = cw / 929;
     }
@@ -221,30 +261,6 @@ int BitMatrixParser::getCodeword(int64_t symbol, int *pi)
   }
 }
 
-/**
-  * Use a binary search to find the index of the codeword corresponding to
-  * this symbol.
-  *
-  * @param symbol the symbol from the barcode.
-  * @return the index into the codeword table.
-  */
-int BitMatrixParser::findCodewordIndex(int64_t symbol)
-{
-  int first = 0;
-  int upto = SYMBOL_TABLE_LENGTH;
-  while (first < upto) {
-    int mid = ((unsigned int)(first + upto)) >> 1; // Compute mid point.
-    if (symbol < SYMBOL_TABLE[mid]) {
-      upto = mid; // repeat search in bottom half.
-    } else if (symbol > SYMBOL_TABLE[mid]) {
-      first = mid + 1; // Repeat search in top half.
-    } else {
-      return mid; // Found it. return position
-    }
-  }
-  return -1;
-}
-
 /*
  * 2012-06-22 hfn additional verification of outer columns
  */
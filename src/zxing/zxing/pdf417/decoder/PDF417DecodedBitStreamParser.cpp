@@ -20,6 +20,7 @@
 #include <zxing/FormatException.h>
 #include <zxing/pdf417/decoder/DecodedBitStreamParser.h>
 #include <zxing/common/DecoderResult.h>
+#include <zxing/common/CharacterSetDecoder.h>
 
 using std::string;
 using zxing::pdf417::DecodedBitStreamParser;
@@ -27,6 +28,7 @@ using zxing::ArrayRef;
 using zxing::Ref;
 using zxing::DecoderResult;
 using zxing::String;
+using zxing::common::CharacterSetDecoder;
 
 namespace zxing {
 namespace pdf417 {
@@ -116,6 +118,7 @@ Ref<DecoderResult> DecodedBitStreamParser::decode(ArrayRef<int> codewords)
       throw FormatException();
     }
   }
+  result = new String(CharacterSetDecoder::toUTF8(result->getText()));
   return Ref<DecoderResult>(new DecoderResult(ArrayRef<byte>(), result));
 }
 
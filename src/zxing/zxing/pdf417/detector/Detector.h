@@ -20,6 +20,7 @@
  * limitations under the License.
  */
 
+#include <vector>
 #include <zxing/common/Point.h>
 #include <zxing/common/DetectorResult.h>
 #include <zxing/NotFoundException.h>
@@ -48,14 +49,24 @@ private:
 
   Ref<BinaryBitmap> image_;
   
-  static ArrayRef< Ref<ResultPoint> > findVertices(Ref<BitMatrix> matrix, int rowStep);
-  static ArrayRef< Ref<ResultPoint> > findVertices180(Ref<BitMatrix> matrix, int rowStep);
+  // Start and end of the topmost and bottommost guard patterns
+  struct GuardRows {
+    int top;
+    int bottom;
+    ArrayRef<int> topLoc;
+    ArrayRef<int> bottomLoc;
+  };
 
-  static ArrayRef<int> findGuardPattern(Ref<BitMatrix> matrix,
-                                        int column,
-                                        int row,
-                                        int width,
+  static ArrayRef< Ref<ResultPoint> > findVertices(Ref<BitMatrix> matrix, int rowStep,
+                                                   bool& upsideDown);
+  static void refineGuardRows(Ref<BitMatrix> matrix, int rowStep, GuardRows& rows,
+                              const int pattern[], int patternSize, bool whiteFirst,
+                              bool reversed, ArrayRef<int>& counters,
+                              std::vector<int>& runs);
+  static void getRowRuns(Ref<BitMatrix> matrix, int row, std::vector<int>& runs);
+  static ArrayRef<int> findGuardPattern(std::vector<int> const& runs,
                                         bool whiteFirst,
+                                        bool reversed,
                                         const int pattern[],
                                         int patternSize,
                                         ArrayRef<int>& counters);
@@ -23,6 +23,7 @@
 
 using std::max;
 using std::abs;
+using std::vector;
 using std::numeric_limits;
 using zxing::pdf417::detector::Detector;
 using zxing::common::detector::MathUtils;
@@ -82,22 +83,14 @@ Ref<DetectorResult> Detector::detect(DecodeHints const& hints) {
   // Fetch the 1 bit matrix once up front.
   Ref<BitMatrix> matrix = image_->getBlackMatrix();
 
-  // Try to find the vertices assuming the image is upright.
+  // Look for the upright and the upside down guard patterns at once.
   const int rowStep = 8;
-  ArrayRef< Ref<ResultPoint> > vertices (findVertices(matrix, rowStep));
-  if (!vertices) {
-    // Maybe the image is rotated 180 degrees?
-    vertices = findVertices180(matrix, rowStep);
-    if (vertices) {
-      correctVertices(matrix, vertices, true);
-    }
-  } else {
-    correctVertices(matrix, vertices, false);
-  }
-
+  bool upsideDown = false;
+  ArrayRef< Ref<ResultPoint> > vertices (findVertices(matrix, rowStep, upsideDown));
   if (!vertices) {
     throw NotFoundException("No vertices found.");
   }
+  correctVertices(matrix, vertices, upsideDown);
   
   float moduleWidth = computeModuleWidth(vertices);
   if (moduleWidth < 1.0f) {
@@ -125,12 +118,43 @@ Ref<DetectorResult> Detector::detect(DecodeHints const& hints) {
   return Ref<DetectorResult>(new DetectorResult(linesGrid, points));
 }
 
+namespace {
+
+// The wide bar is 7 or 8 modules, no less than 6.2 after the allowed
+// variance even with one pixel per module
+const int MIN_WIDE_BAR = 6;
+
+inline int numberOfTrailingZeros(unsigned int i) {
+#if defined(__clang__) || defined(__GNUC__)
+  return __builtin_ctz(i);
+#else
+  int n = 0;
+  while (!(i & 1)) {
+    i >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+inline bool overlap(ArrayRef<int> const& a, ArrayRef<int> const& b) {
+  return a[0] < b[1] && b[0] < a[1];
+}
+
+}
+
 /**
  * Locate the vertices and the codewords area of a black blob using the Start
  * and Stop patterns as locators.
  *
+ * Every rowStep-th row is converted into runs once and searched for all four
+ * guard patterns (Start and Stop, upright and rotated by 180 degrees). Only
+ * the rows next to the topmost and the bottommost hits are looked at again,
+ * to find where the patterns actually end.
+ *
  * @param matrix the scanned barcode image.
  * @param rowStep the step size for iterating rows (every n-th row).
+ * @param upsideDown set to true if the barcode is rotated by 180 degrees.
  * @return an array containing the vertices:
  *           vertices[0] x, y top left barcode
  *           vertices[1] x, y bottom left barcode
@@ -141,196 +165,195 @@ Ref<DetectorResult> Detector::detect(DecodeHints const& hints) {
  *           vertices[6] x, y top right codeword area
  *           vertices[7] x, y bottom right codeword area
  */
-ArrayRef< Ref<ResultPoint> > Detector::findVertices(Ref<BitMatrix> matrix, int rowStep)
+ArrayRef< Ref<ResultPoint> > Detector::findVertices(Ref<BitMatrix> matrix, int rowStep,
+                                                    bool& upsideDown)
 {
-  const int height = matrix->getHeight();
-  const int width = matrix->getWidth();
-  
-  ArrayRef< Ref<ResultPoint> > result(16);
-  bool found = false;
+  enum { START, STOP, START_REVERSE, STOP_REVERSE, GUARD_COUNT };
+  struct Guard {
+    const int* pattern;
+    int patternSize;
+    bool whiteFirst;
+    bool reversed;  // wide bar is the last element
+  };
+  const Guard guards[GUARD_COUNT] = {
+    { START_PATTERN, START_PATTERN_LENGTH, false, false },
+    { STOP_PATTERN, STOP_PATTERN_LENGTH, false, false },
+    { START_PATTERN_REVERSE, START_PATTERN_REVERSE_LENGTH, true, true },
+    { STOP_PATTERN_REVERSE, STOP_PATTERN_REVERSE_LENGTH, false, true }
+  };
 
-  ArrayRef<int> counters(new Array<int>(START_PATTERN_LENGTH));
+  const int height = matrix->getHeight();
+  GuardRows rows[GUARD_COUNT];
+  ArrayRef<int> counters[GUARD_COUNT];
+  for (int g = 0; g < GUARD_COUNT; g++) {
+    rows[g].top = rows[g].bottom = -1;
+    counters[g] = new Array<int>(guards[g].patternSize);
+  }
 
-  // Top Left
+  vector<int> runs;
   for (int i = 0; i < height; i += rowStep) {
-    ArrayRef<int> loc = findGuardPattern(matrix, 0, i, width, false, START_PATTERN,
-                                         START_PATTERN_LENGTH, counters);
-    if (loc) {
-      result[0] = new ResultPoint((float)loc[0], (float)i);
-      result[4] = new ResultPoint((float)loc[1], (float)i);
-      found = true;
-      break;
-    }
-  }
-  // Bottom left
-  if (found) { // Found the Top Left vertex
-    found = false;
-    for (int i = height - 1; i > 0; i -= rowStep) {
-      ArrayRef<int> loc = findGuardPattern(matrix, 0, i, width, false, START_PATTERN,
-                                           START_PATTERN_LENGTH, counters);
+    getRowRuns(matrix, i, runs);
+    for (int g = 0; g < GUARD_COUNT; g++) {
+      ArrayRef<int> loc = findGuardPattern(runs, guards[g].whiteFirst, guards[g].reversed,
+                                           guards[g].pattern, guards[g].patternSize,
+                                           counters[g]);
       if (loc) {
-        result[1] = new ResultPoint((float)loc[0], (float)i);
-        result[5] = new ResultPoint((float)loc[1], (float)i);
-        found = true;
-        break;
+        if (rows[g].top < 0) {
+          rows[g].top = i;
+          rows[g].topLoc = loc;
+        }
+        rows[g].bottom = i;
+        rows[g].bottomLoc = loc;
       }
     }
   }
 
-  counters = new Array<int>(STOP_PATTERN_LENGTH);
-
-  // Top right
-  if (found) { // Found the Bottom Left vertex
-    found = false;
-    for (int i = 0; i < height; i += rowStep) {
-      ArrayRef<int> loc = findGuardPattern(matrix, 0, i, width, false, STOP_PATTERN,
-                                           STOP_PATTERN_LENGTH, counters);
-      if (loc) {
-        result[2] = new ResultPoint((float)loc[1], (float)i);
-        result[6] = new ResultPoint((float)loc[0], (float)i);
-        found = true;
-        break;
-      }
-    }
+  // Prefer the upright orientation if both are there
+  int startGuard, stopGuard;
+  if (rows[START].top >= 0 && rows[STOP].top >= 0) {
+    startGuard = START;
+    stopGuard = STOP;
+    upsideDown = false;
+  } else if (rows[START_REVERSE].top >= 0 && rows[STOP_REVERSE].top >= 0) {
+    startGuard = START_REVERSE;
+    stopGuard = STOP_REVERSE;
+    upsideDown = true;
+  } else {
+    return ArrayRef< Ref<ResultPoint> >();
   }
-  // Bottom right
-  if (found) { // Found the Top right vertex
-    found = false;
-    for (int i = height - 1; i > 0; i -= rowStep) {
-      ArrayRef<int> loc = findGuardPattern(matrix, 0, i, width, false, STOP_PATTERN,
-                                           STOP_PATTERN_LENGTH, counters);
-      if (loc) {
-        result[3] = new ResultPoint((float)loc[1], (float)i);
-        result[7] = new ResultPoint((float)loc[0], (float)i);
-        found = true;
-        break;
-      }
-    }
+
+  const int used[] = { startGuard, stopGuard };
+  for (int k = 0; k < 2; k++) {
+    const Guard& guard = guards[used[k]];
+    refineGuardRows(matrix, rowStep, rows[used[k]], guard.pattern, guard.patternSize,
+                    guard.whiteFirst, guard.reversed, counters[used[k]], runs);
   }
 
-  return found ? result : ArrayRef< Ref<ResultPoint> >();
+  const GuardRows& start = rows[startGuard];
+  const GuardRows& stop = rows[stopGuard];
+  ArrayRef< Ref<ResultPoint> > result(16);
+  if (!upsideDown) {
+    result[0] = new ResultPoint((float)start.topLoc[0], (float)start.top);
+    result[4] = new ResultPoint((float)start.topLoc[1], (float)start.top);
+    result[1] = new ResultPoint((float)start.bottomLoc[0], (float)start.bottom);
+    result[5] = new ResultPoint((float)start.bottomLoc[1], (float)start.bottom);
+    result[2] = new ResultPoint((float)stop.topLoc[1], (float)stop.top);
+    result[6] = new ResultPoint((float)stop.topLoc[0], (float)stop.top);
+    result[3] = new ResultPoint((float)stop.bottomLoc[1], (float)stop.bottom);
+    result[7] = new ResultPoint((float)stop.bottomLoc[0], (float)stop.bottom);
+  } else {
+    // Top of the barcode is at the bottom of the image
+    result[0] = new ResultPoint((float)start.bottomLoc[1], (float)start.bottom);
+    result[4] = new ResultPoint((float)start.bottomLoc[0], (float)start.bottom);
+    result[1] = new ResultPoint((float)start.topLoc[1], (float)start.top);
+    result[5] = new ResultPoint((float)start.topLoc[0], (float)start.top);
+    result[2] = new ResultPoint((float)stop.bottomLoc[0], (float)stop.bottom);
+    result[6] = new ResultPoint((float)stop.bottomLoc[1], (float)stop.bottom);
+    result[3] = new ResultPoint((float)stop.topLoc[0], (float)stop.top);
+    result[7] = new ResultPoint((float)stop.topLoc[1], (float)stop.top);
+  }
+  return result;
 }
 
-ArrayRef< Ref<ResultPoint> > Detector::findVertices180(Ref<BitMatrix> matrix, int rowStep) {
+/**
+ * Moves the topmost and the bottommost rows found on the coarse grid
+ * outwards, one row at a time, for as long as the guard pattern continues.
+ */
+void Detector::refineGuardRows(Ref<BitMatrix> matrix, int rowStep, GuardRows& rows,
+                               const int pattern[], int patternSize, bool whiteFirst,
+                               bool reversed, ArrayRef<int>& counters, vector<int>& runs)
+{
   const int height = matrix->getHeight();
-  const int width = matrix->getWidth();
-  const int halfWidth = width >> 1;
-  
-  ArrayRef< Ref<ResultPoint> > result(16);
-  bool found = false;
-  
-  ArrayRef<int> counters = new Array<int>(START_PATTERN_REVERSE_LENGTH);
-  
-  // Top Left
-  for (int i = height - 1; i > 0; i -= rowStep) {
-    ArrayRef<int> loc =
-        findGuardPattern(matrix, halfWidth, i, halfWidth, true, START_PATTERN_REVERSE,
-                         START_PATTERN_REVERSE_LENGTH, counters);
-    if (loc) {
-      result[0] = new ResultPoint((float)loc[1], (float)i);
-      result[4] = new ResultPoint((float)loc[0], (float)i);
-      found = true;
+  for (int i = rows.top - 1; i >= 0 && i > rows.top - rowStep; i--) {
+    getRowRuns(matrix, i, runs);
+    ArrayRef<int> loc = findGuardPattern(runs, whiteFirst, reversed, pattern, patternSize,
+                                         counters);
+    if (!loc || !overlap(loc, rows.topLoc)) {
       break;
     }
+    rows.top = i;
+    rows.topLoc = loc;
   }
-  // Bottom Left
-  if (found) { // Found the Top Left vertex
-    found = false;
-    for (int i = 0; i < height; i += rowStep) {
-      ArrayRef<int> loc =
-          findGuardPattern(matrix, halfWidth, i, halfWidth, true, START_PATTERN_REVERSE,
-                           START_PATTERN_REVERSE_LENGTH, counters);
-      if (loc) {
-        result[1] = new ResultPoint((float)loc[1], (float)i);
-        result[5] = new ResultPoint((float)loc[0], (float)i);
-        found = true;
-        break;
-      }
+  for (int i = rows.bottom + 1; i < height && i < rows.bottom + rowStep; i++) {
+    getRowRuns(matrix, i, runs);
+    ArrayRef<int> loc = findGuardPattern(runs, whiteFirst, reversed, pattern, patternSize,
+                                         counters);
+    if (!loc || !overlap(loc, rows.bottomLoc)) {
+      break;
     }
+    rows.bottom = i;
+    rows.bottomLoc = loc;
   }
+}
 
-  counters = new Array<int>(STOP_PATTERN_REVERSE_LENGTH);
-
-  // Top Right
-  if (found) { // Found the Bottom Left vertex
-    found = false;
-    for (int i = height - 1; i > 0; i -= rowStep) {
-      ArrayRef<int> loc = findGuardPattern(matrix, 0, i, halfWidth, false, STOP_PATTERN_REVERSE,
-                                           STOP_PATTERN_REVERSE_LENGTH, counters);
-      if (loc) {
-        result[2] = new ResultPoint((float)loc[0], (float)i);
-        result[6] = new ResultPoint((float)loc[1], (float)i);
-        found = true;
-        break;
-      }
-    }
-  }
-  // Bottom Right
-  if (found) { // Found the Top Right vertex
-    found = false;
-    for (int i = 0; i < height; i += rowStep) {
-      ArrayRef<int> loc = findGuardPattern(matrix, 0, i, halfWidth, false, STOP_PATTERN_REVERSE,
-                                           STOP_PATTERN_REVERSE_LENGTH, counters);
-      if (loc) {
-        result[3] = new ResultPoint((float)loc[0], (float)i);
-        result[7] = new ResultPoint((float)loc[1], (float)i);
-        found = true;
-        break;
-      }
+/**
+ * Converts a row into run lengths, 32 pixels at a time. The first run is
+ * white (possibly empty), the colors alternate from there.
+ */
+void Detector::getRowRuns(Ref<BitMatrix> matrix, int row, vector<int>& runs)
+{
+  const int width = matrix->getWidth();
+  const int rowSize = matrix->getRowSize();
+  const unsigned int* bits = (const unsigned int*)matrix->getRowBits(row);
+  int last = 0;
+  unsigned int carry = 0;
+
+  runs.clear();
+  for (int i = 0; i < rowSize; i++) {
+    const unsigned int word = bits[i];
+    // Bit n is set if pixel n differs from the one on its left
+    unsigned int diff = word ^ ((word << 1) | carry);
+    carry = word >> 31;
+    while (diff) {
+      const int x = (i << 5) + numberOfTrailingZeros(diff);
+      runs.push_back(x - last);
+      last = x;
+      diff &= diff - 1;
     }
   }
-
-  return found ? result : ArrayRef< Ref<ResultPoint> >();
+  runs.push_back(width - last);
 }
 
 /**
- * @param matrix row of black/white values to search
- * @param column x position to start search
- * @param row y position to start search
- * @param width the number of pixels to search on this row
+ * @param runs run lengths of the row, starting with white
+ * @param whiteFirst whether the pattern starts with a space
+ * @param reversed whether the wide bar is the last element of the pattern
  * @param pattern pattern of counts of number of black and white pixels that are
  *                 being searched for as a pattern
  * @param counters array of counters, as long as pattern, to re-use
- * @return start/end horizontal offset of guard pattern, as an array of two ints.
+ * @return start/end horizontal offset of the leftmost guard pattern, as an
+ *         array of two ints.
  */
-ArrayRef<int> Detector::findGuardPattern(Ref<BitMatrix> matrix,
-                                         int column,
-                                         int row,
-                                         int width,
+ArrayRef<int> Detector::findGuardPattern(vector<int> const& runs,
                                          bool whiteFirst,
+                                         bool reversed,
                                          const int pattern[],
                                          int patternSize,
                                          ArrayRef<int>& counters) {
-  counters->values().assign(counters->size(), 0);
-  int patternLength = patternSize;
-  bool isWhite = whiteFirst;
-
-  int counterPosition = 0;
-  int patternStart = column;
-  for (int x = column; x < column + width; x++) {
-    bool pixel = matrix->get(x, row);
-    if (pixel ^ isWhite) {
-      counters[counterPosition]++;
-    } else {
-      if (counterPosition == patternLength - 1) {
-        if (patternMatchVariance(counters, pattern,
-                                 MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
-          ArrayRef<int> result = new Array<int>(2);
-          result[0] = patternStart;
-          result[1] = x;
-          return result;
-        }
-        patternStart += counters[0] + counters[1];
-        for(int i = 0; i < patternLength - 2; ++i)
-          counters[i] = counters[ i + 2];
-        counters[patternLength - 2] = 0;
-        counters[patternLength - 1] = 0;
-        counterPosition--;
-      } else {
-        counterPosition++;
-      }
-      counters[counterPosition] = 1;
-      isWhite = !isWhite;
+  const int n = (int)runs.size();
+  int patternStart = 0;
+  for (int i = 0; i + patternSize <= n; patternStart += runs[i], i++) {
+    // Even runs are white, odd ones are black
+    if ((i & 1) != (whiteFirst ? 0 : 1)) {
+      continue;
+    }
+    // Cheap test first: the wide bar is at least three times as wide
+    // as the narrow element next to it
+    const int wide = reversed ? (i + patternSize - 1) : i;
+    const int narrow = reversed ? (wide - 1) : (wide + 1);
+    if (runs[wide] < MIN_WIDE_BAR || runs[wide] < 3 * runs[narrow]) {
+      continue;
+    }
+    int patternEnd = patternStart;
+    for (int k = 0; k < patternSize; k++) {
+      counters[k] = runs[i + k];
+      patternEnd += runs[i + k];
+    }
+    if (patternMatchVariance(counters, pattern, MAX_INDIVIDUAL_VARIANCE) < MAX_AVG_VARIANCE) {
+      ArrayRef<int> result = new Array<int>(2);
+      result[0] = patternStart;
+      result[1] = patternEnd;
+      return result;
     }
   }
   return ArrayRef<int>();
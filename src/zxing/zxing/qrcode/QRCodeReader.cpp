@@ -21,6 +21,7 @@
 
 #include <zxing/qrcode/QRCodeReader.h>
 #include <zxing/qrcode/detector/Detector.h>
+#include <zxing/ReaderException.h>
 
 #include <iostream>
 
@@ -36,7 +37,18 @@ namespace zxing {
             Detector detector(image->getBlackMatrix());
             Ref<DetectorResult> detectorResult(detector.detect(hints));
             ArrayRef< Ref<ResultPoint> > points (detectorResult->getPoints());
-            Ref<DecoderResult> decoderResult(decoder_.decode(detectorResult->getBits()));
+            Ref<DecoderResult> decoderResult;
+            try {
+                decoderResult = decoder_.decode(detectorResult->getBits());
+            } catch (ReaderException const&) {
+                // Large symbols are sampled cell by cell, which breaks if
+                // an alignment pattern was matched in the wrong place
+                Ref<BitMatrix> bits(detector.sampleFallbackGrid());
+                if (!bits) {
+                    throw;
+                }
+                decoderResult = decoder_.decode(bits);
+            }
             Ref<Result> result(
                                new Result(decoderResult->getText(), decoderResult->getRawBytes(), points, BarcodeFormat::QR_CODE, decoderResult->charSet()));
             return result;
@@ -39,7 +39,7 @@ public:
   static int buildDataMasks();
   DataMask();
   virtual ~DataMask();
-  void unmaskBitMatrix(BitMatrix& matrix, size_t dimension);
+  virtual void unmaskBitMatrix(BitMatrix& matrix, size_t dimension);
   virtual bool isMasked(size_t x, size_t y) = 0;
   static DataMask& forReference(int reference);
 };
@@ -24,6 +24,7 @@
 #include <zxing/common/Counted.h>
 #include <zxing/common/Array.h>
 #include <zxing/common/DecoderResult.h>
+#include <zxing/common/DecoderResultCache.h>
 #include <zxing/common/BitMatrix.h>
 
 namespace zxing {
@@ -34,6 +35,7 @@ class BitMatrixParser;
 class Decoder {
 private:
   ReedSolomonDecoder rsDecoder_;
+  DecoderResultCache cache_;
 
   Ref<DecoderResult> decode(BitMatrixParser& parser);
   void correctErrors(ArrayRef<byte> bytes, int numDataCodewords);
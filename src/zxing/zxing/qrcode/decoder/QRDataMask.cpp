@@ -54,34 +54,60 @@ void DataMask::unmaskBitMatrix(BitMatrix& bits, size_t dimension) {
   }
 }
 
+namespace {
+
 /**
- * 000: mask bits for which (x + y) mod 2 == 0
+ * The masks are applied to every module of the symbol. The generic
+ * DataMask::unmaskBitMatrix() calls the virtual isMasked() for each
+ * of them, this one gets the mask function inlined and flips 32 bits
+ * at a time.
  */
-class DataMask000 : public DataMask {
+template <class M>
+class DataMaskTemplate : public DataMask {
 public:
   bool isMasked(size_t x, size_t y) {
-    //		return ((x + y) & 0x01) == 0;
-    return ((x + y) % 2) == 0;
+    return M::isMasked(x, y);
+  }
+
+  void unmaskBitMatrix(BitMatrix& bits, size_t dimension) {
+    for (size_t y = 0; y < dimension; y++) {
+      int* row = bits.getRowBits((int)y);
+      for (size_t x0 = 0; x0 < dimension; x0 += 32) {
+        const size_t end = (x0 + 32 < dimension) ? (x0 + 32) : dimension;
+        unsigned int mask = 0;
+        for (size_t x = x0; x < end; x++) {
+          // Coordinates are swapped, see DataMask::unmaskBitMatrix()
+          mask |= (unsigned int)M::isMasked(y, x) << (x & 0x1f);
+        }
+        row[x0 >> 5] ^= (int)mask;
+      }
+    }
+  }
+};
+
+/**
+ * 000: mask bits for which (x + y) mod 2 == 0
+ */
+struct Mask000 {
+  static bool isMasked(size_t x, size_t y) {
+    return ((x + y) & 0x01) == 0;
   }
 };
 
 /**
  * 001: mask bits for which x mod 2 == 0
  */
-class DataMask001 : public DataMask {
-public:
-  bool isMasked(size_t x, size_t) {
-    //		return (x & 0x01) == 0;
-    return (x % 2) == 0;
+struct Mask001 {
+  static bool isMasked(size_t x, size_t) {
+    return (x & 0x01) == 0;
   }
 };
 
 /**
  * 010: mask bits for which y mod 3 == 0
  */
-class DataMask010 : public DataMask {
-public:
-  bool isMasked(size_t, size_t y) {
+struct Mask010 {
+  static bool isMasked(size_t, size_t y) {
     return y % 3 == 0;
   }
 };
@@ -89,9 +115,8 @@ public:
 /**
  * 011: mask bits for which (x + y) mod 3 == 0
  */
-class DataMask011 : public DataMask {
-public:
-  bool isMasked(size_t x, size_t y) {
+struct Mask011 {
+  static bool isMasked(size_t x, size_t y) {
     return (x + y) % 3 == 0;
   }
 };
@@ -99,59 +124,52 @@ public:
 /**
  * 100: mask bits for which (x/2 + y/3) mod 2 == 0
  */
-class DataMask100 : public DataMask {
-public:
-  bool isMasked(size_t x, size_t y) {
-    //		return (((x >> 1) + (y / 3)) & 0x01) == 0;
-    return (((x >> 1) + (y / 3)) % 2) == 0;
+struct Mask100 {
+  static bool isMasked(size_t x, size_t y) {
+    return (((x >> 1) + (y / 3)) & 0x01) == 0;
   }
 };
 
 /**
  * 101: mask bits for which xy mod 2 + xy mod 3 == 0
  */
-class DataMask101 : public DataMask {
-public:
-  bool isMasked(size_t x, size_t y) {
+struct Mask101 {
+  static bool isMasked(size_t x, size_t y) {
     size_t temp = x * y;
-    //		return (temp & 0x01) + (temp % 3) == 0;
-    return (temp % 2) + (temp % 3) == 0;
-
+    return (temp & 0x01) + (temp % 3) == 0;
   }
 };
 
 /**
  * 110: mask bits for which (xy mod 2 + xy mod 3) mod 2 == 0
  */
-class DataMask110 : public DataMask {
-public:
-  bool isMasked(size_t x, size_t y) {
+struct Mask110 {
+  static bool isMasked(size_t x, size_t y) {
     size_t temp = x * y;
-    //		return (((temp & 0x01) + (temp % 3)) & 0x01) == 0;
-    return (((temp % 2) + (temp % 3)) % 2) == 0;
+    return (((temp & 0x01) + (temp % 3)) & 0x01) == 0;
   }
 };
 
 /**
  * 111: mask bits for which ((x+y)mod 2 + xy mod 3) mod 2 == 0
  */
-class DataMask111 : public DataMask {
-public:
-  bool isMasked(size_t x, size_t y) {
-    //		return ((((x + y) & 0x01) + ((x * y) % 3)) & 0x01) == 0;
-    return ((((x + y) % 2) + ((x * y) % 3)) % 2) == 0;
+struct Mask111 {
+  static bool isMasked(size_t x, size_t y) {
+    return ((((x + y) & 0x01) + ((x * y) % 3)) & 0x01) == 0;
   }
 };
 
+}
+
 int DataMask::buildDataMasks() {
-  DATA_MASKS.push_back(Ref<DataMask> (new DataMask000()));
-  DATA_MASKS.push_back(Ref<DataMask> (new DataMask001()));
-  DATA_MASKS.push_back(Ref<DataMask> (new DataMask010()));
-  DATA_MASKS.push_back(Ref<DataMask> (new DataMask011()));
-  DATA_MASKS.push_back(Ref<DataMask> (new DataMask100()));
-  DATA_MASKS.push_back(Ref<DataMask> (new DataMask101()));
-  DATA_MASKS.push_back(Ref<DataMask> (new DataMask110()));
-  DATA_MASKS.push_back(Ref<DataMask> (new DataMask111()));
+  DATA_MASKS.push_back(Ref<DataMask> (new DataMaskTemplate<Mask000>()));
+  DATA_MASKS.push_back(Ref<DataMask> (new DataMaskTemplate<Mask001>()));
+  DATA_MASKS.push_back(Ref<DataMask> (new DataMaskTemplate<Mask010>()));
+  DATA_MASKS.push_back(Ref<DataMask> (new DataMaskTemplate<Mask011>()));
+  DATA_MASKS.push_back(Ref<DataMask> (new DataMaskTemplate<Mask100>()));
+  DATA_MASKS.push_back(Ref<DataMask> (new DataMaskTemplate<Mask101>()));
+  DATA_MASKS.push_back(Ref<DataMask> (new DataMaskTemplate<Mask110>()));
+  DATA_MASKS.push_back(Ref<DataMask> (new DataMaskTemplate<Mask111>()));
   return DATA_MASKS.size();
 }
 
@@ -23,21 +23,8 @@
 #include <zxing/common/CharacterSetECI.h>
 #include <zxing/FormatException.h>
 #include <zxing/common/StringUtils.h>
+#include <zxing/common/CharacterSetDecoder.h>
 #include <iostream>
-#ifndef NO_ICONV
-#include <iconv.h>
-#endif
-
-// Required for compatibility. TODO : test on Symbian
-#ifdef ZXING_ICONV_CONST
-#undef ICONV_CONST
-#define ICONV_CONST const
-#endif
-
-#ifndef ICONV_CONST
-#define ICONV_CONST /**/
-#endif
-#include <qglobal.h>
 
 
 using namespace std;
@@ -64,47 +51,7 @@ void DecodedBitStreamParser::append(std::string &result,
                                     const byte *bufIn,
                                     size_t nIn,
                                     const char *src) {
-#ifndef NO_ICONV
-    if (nIn == 0) {
-        return;
-    }
-
-    iconv_t cd = iconv_open(StringUtils::UTF8, src);
-    if (cd == (iconv_t)-1) {
-        result.append((const char *)bufIn, nIn);
-        return;
-    }
-
-    const int maxOut = 4 * nIn + 1;
-    char* bufOut = new char[maxOut];
-
-    ICONV_CONST char *fromPtr = (ICONV_CONST char *)bufIn;
-    size_t nFrom = nIn;
-    char *toPtr = (char *)bufOut;
-    size_t nTo = maxOut;
-
-    while (nFrom > 0) {
-#if defined(Q_OS_SYMBIAN)
-    size_t oneway = iconv(cd,(const char**) &fromPtr, &nFrom, &toPtr, &nTo);
-#else
-    size_t oneway = iconv(cd,(char**) &fromPtr, &nFrom, &toPtr, &nTo);
-#endif
-        if (oneway == (size_t)(-1)) {
-            iconv_close(cd);
-            delete[] bufOut;
-            throw ReaderException("error converting characters");
-        }
-    }
-    iconv_close(cd);
-
-    int nResult = maxOut - nTo;
-    bufOut[nResult] = '\0';
-    result.append((const char *)bufOut);
-    delete[] bufOut;
-#else
-    Q_UNUSED(src);
-    result.append((const char *)bufIn, nIn);
-#endif
+    CharacterSetDecoder::append(result, bufIn, nIn, src);
 }
 
 void DecodedBitStreamParser::decodeHanziSegment(Ref<BitSource> bits_,
@@ -182,6 +129,18 @@ void DecodedBitStreamParser::decodeKanjiSegment(Ref<BitSource> bits, std::string
     delete[] buffer;
 }
 
+namespace {
+// The segment decoders check the length up front, running out of
+// bits here still means the segment is broken rather than a bug
+inline int readSegmentBits(BitSource& bits, int numBits) {
+  int value = 0;
+  if (!bits.readBits(numBits, value)) {
+    throw FormatException();
+  }
+  return value;
+}
+}
+
 std::string DecodedBitStreamParser::decodeByteSegment(Ref<BitSource> bits_,
                                                       string& result,
                                                       int count,
@@ -197,8 +156,19 @@ std::string DecodedBitStreamParser::decodeByteSegment(Ref<BitSource> bits_,
 
     ArrayRef<byte> bytes_ (count);
     byte* readBytes = &(*bytes_)[0];
-    for (int i = 0; i < count; i++) {
-        readBytes[i] = (byte) bits.readBits(8);
+    int i = 0;
+    int value = 0;
+    // Read four bytes at a time
+    for (; i + 4 <= count; i += 4) {
+        value = readSegmentBits(bits, 32);
+        readBytes[i] = (byte) (value >> 24);
+        readBytes[i + 1] = (byte) (value >> 16);
+        readBytes[i + 2] = (byte) (value >> 8);
+        readBytes[i + 3] = (byte) value;
+    }
+    for (; i < count; i++) {
+        value = readSegmentBits(bits, 8);
+        readBytes[i] = (byte) value;
     }
     string encoding;
     if (currentCharacterSetECI == 0) {
@@ -221,58 +191,53 @@ std::string DecodedBitStreamParser::decodeByteSegment(Ref<BitSource> bits_,
     return encoding;
 }
 
-void DecodedBitStreamParser::decodeNumericSegment(Ref<BitSource> bits, std::string &result, int count) {
-    int nBytes = count;
-    byte* bytes = new byte[nBytes];
-    int i = 0;
-    // Read three digits at a time
+namespace {
+const int NUMERIC_UNIT_LIMIT[] = { 1, 10, 100, 1000 };
+
+// Appends the digits of a 10, 7 or 4 bit numeric unit
+void appendNumericUnit(string& result, int value, int digits) {
+    if (value >= NUMERIC_UNIT_LIMIT[digits]) {
+        throw FormatException();
+    }
+    char buffer[3];
+    for (int i = digits - 1; i >= 0; i--) {
+        buffer[i] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    result.append(buffer, digits);
+}
+}
+
+void DecodedBitStreamParser::decodeNumericSegment(Ref<BitSource> bits_, std::string &result, int count) {
+    BitSource& bits (*bits_);
+    // Three digits take 10 bits, two leftover digits 7 bits and one leftover digit 4 bits.
+    // Checking the whole segment up front keeps the loops below free of bounds checks.
+    static const int LEFTOVER_BITS[] = { 0, 4, 7 };
+    if ((count / 3) * 10 + LEFTOVER_BITS[count % 3] > bits.available()) {
+        throw FormatException();
+    }
+    result.reserve(result.length() + count);
+    int value = 0;
+    // Read nine digits (three 10-bit units) at a time
+    while (count >= 9) {
+        value = readSegmentBits(bits, 30);
+        appendNumericUnit(result, value >> 20, 3);
+        appendNumericUnit(result, (value >> 10) & 0x3FF, 3);
+        appendNumericUnit(result, value & 0x3FF, 3);
+        count -= 9;
+    }
     while (count >= 3) {
-        // Each 10 bits encodes three digits
-        if (bits->available() < 10) {
-            throw ReaderException("format exception");
-        }
-        int threeDigitsBits = bits->readBits(10);
-        if (threeDigitsBits >= 1000) {
-            ostringstream s;
-            s << "Illegal value for 3-digit unit: " << threeDigitsBits;
-            delete[] bytes;
-            throw ReaderException(s.str().c_str());
-        }
-        bytes[i++] = ALPHANUMERIC_CHARS[threeDigitsBits / 100];
-        bytes[i++] = ALPHANUMERIC_CHARS[(threeDigitsBits / 10) % 10];
-        bytes[i++] = ALPHANUMERIC_CHARS[threeDigitsBits % 10];
+        value = readSegmentBits(bits, 10);
+        appendNumericUnit(result, value, 3);
         count -= 3;
     }
     if (count == 2) {
-        if (bits->available() < 7) {
-            throw ReaderException("format exception");
-        }
-        // Two digits left over to read, encoded in 7 bits
-        int twoDigitsBits = bits->readBits(7);
-        if (twoDigitsBits >= 100) {
-            ostringstream s;
-            s << "Illegal value for 2-digit unit: " << twoDigitsBits;
-            delete[] bytes;
-            throw ReaderException(s.str().c_str());
-        }
-        bytes[i++] = ALPHANUMERIC_CHARS[twoDigitsBits / 10];
-        bytes[i++] = ALPHANUMERIC_CHARS[twoDigitsBits % 10];
+        value = readSegmentBits(bits, 7);
+        appendNumericUnit(result, value, 2);
     } else if (count == 1) {
-        if (bits->available() < 4) {
-            throw ReaderException("format exception");
-        }
-        // One digit left over to read
-        int digitBits = bits->readBits(4);
-        if (digitBits >= 10) {
-            ostringstream s;
-            s << "Illegal value for digit unit: " << digitBits;
-            delete[] bytes;
-            throw ReaderException(s.str().c_str());
-        }
-        bytes[i++] = ALPHANUMERIC_CHARS[digitBits];
+        value = readSegmentBits(bits, 4);
+        appendNumericUnit(result, value, 1);
     }
-    append(result, bytes, nBytes, StringUtils::ASCII);
-    delete[] bytes;
 }
 
 char DecodedBitStreamParser::toAlphaNumericChar(size_t value) {
@@ -287,45 +252,55 @@ void DecodedBitStreamParser::decodeAlphanumericSegment(Ref<BitSource> bits_,
                                                        int count,
                                                        bool fc1InEffect) {
     BitSource& bits (*bits_);
-    ostringstream bytes;
-    // Read two characters at a time
-    while (count > 1) {
-        if (bits.available() < 11) {
-            throw FormatException();
-        }
-        int nextTwoCharsBits = bits.readBits(11);
-        bytes << toAlphaNumericChar(nextTwoCharsBits / 45);
-        bytes << toAlphaNumericChar(nextTwoCharsBits % 45);
+    // Each pair of characters takes 11 bits, a leftover character 6 bits
+    if ((count / 2) * 11 + (count % 2) * 6 > bits.available()) {
+        throw FormatException();
+    }
+    const size_t start = result.length();
+    result.reserve(start + count);
+    int value = 0;
+    // Read four characters (two 11-bit pairs) at a time
+    while (count >= 4) {
+        value = readSegmentBits(bits, 22);
+        int pair = value >> 11;
+        result.push_back(toAlphaNumericChar(pair / 45));
+        result.push_back(toAlphaNumericChar(pair % 45));
+        pair = value & 0x7FF;
+        result.push_back(toAlphaNumericChar(pair / 45));
+        result.push_back(toAlphaNumericChar(pair % 45));
+        count -= 4;
+    }
+    if (count >= 2) {
+        value = readSegmentBits(bits, 11);
+        result.push_back(toAlphaNumericChar(value / 45));
+        result.push_back(toAlphaNumericChar(value % 45));
         count -= 2;
     }
     if (count == 1) {
         // special case: one character left
-        if (bits.available() < 6) {
-            throw FormatException();
-        }
-        bytes << toAlphaNumericChar(bits.readBits(6));
+        value = readSegmentBits(bits, 6);
+        result.push_back(toAlphaNumericChar(value));
     }
     // See section 6.4.8.1, 6.4.8.2
-    string s = bytes.str();
     if (fc1InEffect) {
-        // We need to massage the result a bit if in an FNC1 mode:
-        ostringstream r;
-        for (size_t i = 0; i < s.length(); i++) {
-            if (s[i] != '%') {
-                r << s[i];
+        // We need to massage the result a bit if in an FNC1 mode. This only
+        // ever shortens the segment, so it is rewritten in place:
+        size_t out = start;
+        for (size_t i = start; i < result.length(); i++) {
+            if (result[i] != '%') {
+                result[out++] = result[i];
             } else {
-                if (i < s.length() - 1 && s[i + 1] == '%') {
+                if (i < result.length() - 1 && result[i + 1] == '%') {
                     // %% is rendered as %
-                    r << s[i++];
+                    result[out++] = result[i++];
                 } else {
                     // In alpha mode, % should be converted to FNC1 separator 0x1D
-                    r << (byte)0x1D;
+                    result[out++] = (char)0x1D;
                 }
             }
         }
-        s = r.str();
+        result.resize(out);
     }
-    append(result, s, StringUtils::ASCII);
 }
 
 namespace {
@@ -366,16 +341,12 @@ DecodedBitStreamParser::decode(ArrayRef<byte> bytes,
         Mode* mode = 0;
         do {
             // While still another segment to read...
-            if (bits.available() < 4) {
+            int modeBits;
+            if (!bits.readBits(4, modeBits)) {
                 // OK, assume we're done. Really, a TERMINATOR mode should have been recorded here
                 mode = &Mode::TERMINATOR;
             } else {
-                try {
-                    mode = &Mode::forBits(bits.readBits(4)); // mode is encoded by 4 bits
-                } catch (IllegalArgumentException const& iae) {
-                    throw iae;
-                    // throw FormatException.getFormatInstance();
-                }
+                mode = &Mode::forBits(modeBits); // mode is encoded by 4 bits
             }
             if (mode != &Mode::TERMINATOR) {
                 if ((mode == &Mode::FNC1_FIRST_POSITION) || (mode == &Mode::FNC1_SECOND_POSITION)) {
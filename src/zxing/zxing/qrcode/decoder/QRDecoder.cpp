@@ -101,6 +101,12 @@ Ref<DecoderResult> Decoder::decode(BitMatrixParser& parser) {
   // Read codewords
   ArrayRef<byte> codewords(parser.readCodewords());
 
+  // Same symbol as in one of the previous frames?
+  const int tag = (version->getVersionNumber() << 2) | ecLevel.ordinal();
+  Ref<DecoderResult> cached(cache_.find(codewords, tag));
+  if (cached) {
+    return cached;
+  }
 
   // Separate into data blocks
   std::vector<Ref<DataBlock> > dataBlocks(DataBlock::getDataBlocks(codewords, version, ecLevel));
@@ -126,10 +132,12 @@ Ref<DecoderResult> Decoder::decode(BitMatrixParser& parser) {
     }
   }
 
-  return DecodedBitStreamParser::decode(resultBytes,
-                                        version,
-                                        ecLevel,
-                                        DecodedBitStreamParser::Hashtable());
+  Ref<DecoderResult> result(DecodedBitStreamParser::decode(resultBytes,
+                                                           version,
+                                                           ecLevel,
+                                                           DecodedBitStreamParser::Hashtable()));
+  cache_.add(codewords, tag, result);
+  return result;
 }
 
 }
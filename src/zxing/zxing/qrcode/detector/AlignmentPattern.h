@@ -34,9 +34,6 @@ namespace zxing {
 			
 		public:
 			AlignmentPattern(float posX, float posY, float estimatedModuleSize);
-			bool aboutEquals(float moduleSize, float i, float j) const;
-      Ref<AlignmentPattern> combineEstimate(float i, float j,
-                                            float newModuleSize) const;
 		};
 		
 	}
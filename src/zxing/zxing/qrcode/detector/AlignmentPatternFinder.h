@@ -35,8 +35,20 @@ private:
   static int MIN_SKIP;
   static int MAX_MODULES;
 
+  // Unconfirmed candidates, see FinderPatternFinder::Center
+  struct Center {
+    float x;
+    float y;
+    float estimatedModuleSize;
+
+    Center(float posX, float posY, float moduleSize) :
+      x(posX), y(posY), estimatedModuleSize(moduleSize) {}
+    bool aboutEquals(float moduleSize, float i, float j) const;
+    Ref<AlignmentPattern> combineEstimate(float i, float j, float newModuleSize) const;
+  };
+
   Ref<BitMatrix> image_;
-  std::vector<AlignmentPattern *> *possibleCenters_;
+  std::vector<Center> possibleCenters_;
   int startX_;
   int startY_;
   int width_;
@@ -53,7 +65,6 @@ private:
 public:
   AlignmentPatternFinder(Ref<BitMatrix> image, int startX, int startY, int width, int height,
                          float moduleSize, Ref<ResultPointCallback>const& callback);
-  ~AlignmentPatternFinder();
   Ref<AlignmentPattern> find();
   
 private:
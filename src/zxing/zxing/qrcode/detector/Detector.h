@@ -28,6 +28,7 @@
 #include <zxing/common/PerspectiveTransform.h>
 #include <zxing/ResultPointCallback.h>
 #include <zxing/qrcode/detector/FinderPatternInfo.h>
+#include <vector>
 
 namespace zxing {
 
@@ -39,6 +40,9 @@ class Detector : public Counted {
 private:
   Ref<BitMatrix> image_;
   Ref<ResultPointCallback> callback_;
+  // Set when the grid was sampled cell by cell (see sampleFallbackGrid)
+  Ref<PerspectiveTransform> fallbackTransform_;
+  int fallbackDimension_;
 
 protected:
   Ref<BitMatrix> getImage() const;
@@ -53,6 +57,8 @@ protected:
   float sizeOfBlackWhiteBlackRun(int fromX, int fromY, int toX, int toY);
   Ref<AlignmentPattern> findAlignmentInRegion(float overallEstModuleSize, int estAlignmentX, int estAlignmentY,
       float allowanceFactor);
+  Ref<BitMatrix> sampleGridByAlignment(int dimension, float moduleSize, std::vector<int>& alignmentCenters,
+                                       Ref<PerspectiveTransform> transform);
   Ref<DetectorResult> processFinderPatternInfo(Ref<FinderPatternInfo> info);
 public:
   virtual Ref<PerspectiveTransform> createTransform(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRight, Ref <
@@ -61,6 +67,11 @@ public:
   Detector(Ref<BitMatrix> image);
   Ref<DetectorResult> detect(DecodeHints const& hints);
 
+  // Samples the grid the way it's done for small symbols, with a single
+  // transform. Returns null unless the last detected result was sampled
+  // cell by cell, which a falsely matched alignment pattern can spoil.
+  Ref<BitMatrix> sampleFallbackGrid();
+
 
 };
 }
@@ -32,15 +32,12 @@ namespace zxing {
 			float estimatedModuleSize_;
 			int count_;
 			
-			FinderPattern(float posX, float posY, float estimatedModuleSize, int count);
-
 		public:
 			FinderPattern(float posX, float posY, float estimatedModuleSize);
+			FinderPattern(float posX, float posY, float estimatedModuleSize, int count);
 			int getCount() const;
 			float getEstimatedModuleSize() const;
 			void incrementCount();
-			bool aboutEquals(float moduleSize, float i, float j) const;
-			Ref<FinderPattern> combineEstimate(float i, float j, float newModuleSize) const;
 		};
 	}
 }
@@ -42,8 +42,24 @@ protected:
   static int MIN_SKIP;
   static int MAX_MODULES;
 
+  // Candidates are plain values, they get merged and dropped all the
+  // time while the image is being scanned. FinderPattern objects are
+  // only created for the ones that make it into the result.
+  struct Center {
+    float x;
+    float y;
+    float estimatedModuleSize;
+    int count;
+
+    Center(float posX, float posY, float moduleSize) :
+      x(posX), y(posY), estimatedModuleSize(moduleSize), count(1) {}
+    bool aboutEquals(float moduleSize, float i, float j) const;
+    void combineEstimate(float i, float j, float newModuleSize);
+    Ref<FinderPattern> toFinderPattern() const;
+  };
+
   Ref<BitMatrix> image_;
-  std::vector<Ref<FinderPattern> > possibleCenters_;
+  std::vector<Center> possibleCenters_;
   bool hasSkipped_;
 
   Ref<ResultPointCallback> callback_;
@@ -64,7 +80,7 @@ protected:
   static std::vector<Ref<FinderPattern> > orderBestPatterns(std::vector<Ref<FinderPattern> > patterns);
 
   Ref<BitMatrix> getImage();
-  std::vector<Ref<FinderPattern> >& getPossibleCenters();
+  std::vector<Ref<FinderPattern> > getPossibleCenters() const;
 
   bool crossCheckDiagonal(int startI, int centerJ, int maxCount, int originalStateCountTotal) const;
   int *getCrossCheckStateCount() const;
@@ -21,27 +21,8 @@
 
 #include <zxing/qrcode/detector/AlignmentPattern.h>
 
-using std::abs;
-using zxing::Ref;
 using zxing::qrcode::AlignmentPattern;
 
 AlignmentPattern::AlignmentPattern(float posX, float posY, float estimatedModuleSize) :
     ResultPoint(posX,posY), estimatedModuleSize_(estimatedModuleSize) {
 }
-
-bool AlignmentPattern::aboutEquals(float moduleSize, float i, float j) const {
-  if (abs(i - getY()) <= moduleSize && abs(j - getX()) <= moduleSize) {
-    float moduleSizeDiff = abs(moduleSize - estimatedModuleSize_);
-    return moduleSizeDiff <= 1.0f || moduleSizeDiff <= estimatedModuleSize_;
-  }
-  return false;
-}
-
-Ref<AlignmentPattern> AlignmentPattern::combineEstimate(float i, float j, float newModuleSize) const {
-  float combinedX = (getX() + j) / 2.0f;
-  float combinedY = (getY() + i) / 2.0f;
-  float combinedModuleSize = (estimatedModuleSize_ + newModuleSize) / 2.0f;
-  Ref<AlignmentPattern> result
-      (new AlignmentPattern(combinedX, combinedY, combinedModuleSize));
-  return result;
-}
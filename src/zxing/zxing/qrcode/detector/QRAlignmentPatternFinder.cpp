@@ -31,8 +31,24 @@ using zxing::qrcode::AlignmentPattern;
 // VC++
 
 using zxing::BitMatrix;
+using zxing::ResultPoint;
 using zxing::ResultPointCallback;
 
+bool AlignmentPatternFinder::Center::aboutEquals(float moduleSize, float i, float j) const {
+  if (abs(i - y) <= moduleSize && abs(j - x) <= moduleSize) {
+    float moduleSizeDiff = abs(moduleSize - estimatedModuleSize);
+    return moduleSizeDiff <= 1.0f || moduleSizeDiff <= estimatedModuleSize;
+  }
+  return false;
+}
+
+Ref<AlignmentPattern> AlignmentPatternFinder::Center::combineEstimate(float i, float j, float newModuleSize) const {
+  float combinedX = (x + j) / 2.0f;
+  float combinedY = (y + i) / 2.0f;
+  float combinedModuleSize = (estimatedModuleSize + newModuleSize) / 2.0f;
+  return Ref<AlignmentPattern>(new AlignmentPattern(combinedX, combinedY, combinedModuleSize));
+}
+
 float AlignmentPatternFinder::centerFromEnd(vector<int>& stateCount, int end) {
   return (float)(end - stateCount[2]) - stateCount[1] / 2.0f;
 }
@@ -102,20 +118,18 @@ Ref<AlignmentPattern> AlignmentPatternFinder::handlePossibleCenter(vector<int> &
   float centerI = crossCheckVertical(i, (int)centerJ, 2 * stateCount[1], stateCountTotal);
   if (!isnan_z(centerI)) {
     float estimatedModuleSize = (float)(stateCount[0] + stateCount[1] + stateCount[2]) / 3.0f;
-    int max = possibleCenters_->size();
+    int max = possibleCenters_.size();
     for (int index = 0; index < max; index++) {
-      Ref<AlignmentPattern> center((*possibleCenters_)[index]);
+      const Center& center = possibleCenters_[index];
       // Look for about the same center and module size:
-      if (center->aboutEquals(estimatedModuleSize, centerI, centerJ)) {
-        return center->combineEstimate(centerI, centerJ, estimatedModuleSize);
+      if (center.aboutEquals(estimatedModuleSize, centerI, centerJ)) {
+        return center.combineEstimate(centerI, centerJ, estimatedModuleSize);
       }
     }
-    AlignmentPattern *tmp = new AlignmentPattern(centerJ, centerI, estimatedModuleSize);
     // Hadn't found this before; save it
-    tmp->retain();
-    possibleCenters_->push_back(tmp);
+    possibleCenters_.push_back(Center(centerJ, centerI, estimatedModuleSize));
     if (callback_ != 0) {
-      callback_->foundPossibleResultPoint(*tmp);
+      callback_->foundPossibleResultPoint(ResultPoint(centerJ, centerI));
     }
   }
   Ref<AlignmentPattern> result;
@@ -125,16 +139,9 @@ Ref<AlignmentPattern> AlignmentPatternFinder::handlePossibleCenter(vector<int> &
 AlignmentPatternFinder::AlignmentPatternFinder(Ref<BitMatrix> image, int startX, int startY, int width,
                                                int height, float moduleSize, 
                                                Ref<ResultPointCallback>const& callback) :
-    image_(image), possibleCenters_(new vector<AlignmentPattern *> ()), startX_(startX), startY_(startY),
+    image_(image), possibleCenters_(), startX_(startX), startY_(startY),
     width_(width), height_(height), moduleSize_(moduleSize), callback_(callback) {
-}
-
-AlignmentPatternFinder::~AlignmentPatternFinder() {
-  for (int i = 0; i < int(possibleCenters_->size()); i++) {
-    (*possibleCenters_)[i]->release();
-    (*possibleCenters_)[i] = 0;
-  }
-  delete possibleCenters_;
+  possibleCenters_.reserve(8);
 }
 
 Ref<AlignmentPattern> AlignmentPatternFinder::find() {
@@ -199,9 +206,10 @@ Ref<AlignmentPattern> AlignmentPatternFinder::find() {
 
   // Hmm, nothing we saw was observed and confirmed twice. If we had
   // any guess at all, return it.
-  if (possibleCenters_->size() > 0) {
-    Ref<AlignmentPattern> center((*possibleCenters_)[0]);
-    return center;
+  if (possibleCenters_.size() > 0) {
+    const Center& center = possibleCenters_[0];
+    return Ref<AlignmentPattern>(new AlignmentPattern(center.x, center.y,
+                                                      center.estimatedModuleSize));
   }
 
   throw zxing::ReaderException("Could not find alignment pattern");
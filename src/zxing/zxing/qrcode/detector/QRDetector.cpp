@@ -36,6 +36,7 @@ using std::ostringstream;
 using std::abs;
 using std::min;
 using std::max;
+using std::vector;
 using zxing::qrcode::Detector;
 using zxing::Ref;
 using zxing::BitMatrix;
@@ -51,8 +52,18 @@ using zxing::qrcode::FinderPatternFinder;
 using zxing::qrcode::FinderPatternInfo;
 using zxing::ResultPoint;
 
+namespace {
+
+// Version 7 and up, that's where a single transform starts to drift
+const size_t MIN_ALIGNMENT_GRID = 3;
+
+// In modules, around the predicted position of each alignment pattern
+const float ALIGNMENT_ALLOWANCE = 4.0f;
+
+}
+
 Detector::Detector(Ref<BitMatrix> image) :
-  image_(image) {
+  image_(image), fallbackDimension_(0) {
 }
 
 Ref<BitMatrix> Detector::getImage() const {
@@ -117,7 +128,17 @@ Ref<DetectorResult> Detector::processFinderPatternInfo(Ref<FinderPatternInfo> in
   }
 
   Ref<PerspectiveTransform> transform = createTransform(topLeft, topRight, bottomLeft, alignmentPattern, dimension);
-  Ref<BitMatrix> bits(sampleGrid(image_, dimension, transform));
+  Ref<BitMatrix> bits;
+  fallbackTransform_.reset(0);
+  if (provisionalVersion->getAlignmentPatternCenters().size() >= MIN_ALIGNMENT_GRID) {
+    bits = sampleGridByAlignment(dimension, moduleSize, provisionalVersion->getAlignmentPatternCenters(), transform);
+  }
+  if (bits) {
+    fallbackTransform_ = transform;
+    fallbackDimension_ = dimension;
+  } else {
+    bits = sampleGrid(image_, dimension, transform);
+  }
   ArrayRef< Ref<ResultPoint> > points(new Array< Ref<ResultPoint> >(alignmentPattern == 0 ? 3 : 4));
   points[0].reset(bottomLeft);
   points[1].reset(topLeft);
@@ -158,11 +179,122 @@ Ref<PerspectiveTransform> Detector::createTransform(Ref<ResultPoint> topLeft, Re
   return transform;
 }
 
+Ref<BitMatrix> Detector::sampleFallbackGrid() {
+  if (!fallbackTransform_) {
+    return Ref<BitMatrix>();
+  }
+  Ref<BitMatrix> bits(sampleGrid(image_, fallbackDimension_, fallbackTransform_));
+  fallbackTransform_.reset(0);
+  return bits;
+}
+
 Ref<BitMatrix> Detector::sampleGrid(Ref<BitMatrix> image, int dimension, Ref<PerspectiveTransform> transform) {
   GridSampler &sampler = GridSampler::getInstance();
   return sampler.sampleGrid(image, dimension, transform);
 }
 
+// Large symbols are rarely flat enough for a single transform to hold
+// across the whole symbol. Locate the alignment patterns, each one
+// predicted from the transform plus the drift seen at its already
+// located neighbours, and sample each cell between them with its own
+// transform. Finder pattern centers anchor the three corners where
+// there's no alignment pattern. Returns null if no alignment pattern
+// could be found or a cell doesn't fit into the image.
+Ref<BitMatrix> Detector::sampleGridByAlignment(int dimension, float moduleSize, vector<int>& alignmentCenters,
+                                               Ref<PerspectiveTransform> transform) {
+  const int n = (int)alignmentCenters.size();
+  const float farFinder = (float)dimension - 3.5f;
+  vector<float> from(2 * n * n);
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < n; i++) {
+      from[2 * (j * n + i)] = alignmentCenters[i] + 0.5f;
+      from[2 * (j * n + i) + 1] = alignmentCenters[j] + 0.5f;
+    }
+  }
+  from[0] = from[1] = 3.5f;
+  from[2 * (n - 1)] = farFinder;
+  from[2 * (n - 1) + 1] = 3.5f;
+  from[2 * (n - 1) * n] = 3.5f;
+  from[2 * (n - 1) * n + 1] = farFinder;
+  vector<float> points(from);
+  transform->transformPoints(points);
+
+  vector<float> driftX(n * n, 0.0f);
+  vector<float> driftY(n * n, 0.0f);
+  vector<bool> located(n * n, false);
+  located[0] = located[n - 1] = located[(n - 1) * n] = true;
+  int found = 0;
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < n; i++) {
+      const int k = j * n + i;
+      if (located[k]) {
+        continue;
+      }
+      int neighbours = 0;
+      float dx = 0.0f, dy = 0.0f;
+      if (i > 0 && located[k - 1]) {
+        dx += driftX[k - 1];
+        dy += driftY[k - 1];
+        neighbours++;
+      }
+      if (j > 0 && located[k - n]) {
+        dx += driftX[k - n];
+        dy += driftY[k - n];
+        neighbours++;
+      }
+      if (neighbours > 1) {
+        dx /= neighbours;
+        dy /= neighbours;
+      }
+      const float estX = points[2 * k] + dx;
+      const float estY = points[2 * k + 1] + dy;
+      try {
+        Ref<AlignmentPattern> pattern(findAlignmentInRegion(moduleSize, (int)estX, (int)estY, ALIGNMENT_ALLOWANCE));
+        driftX[k] = pattern->getX() - points[2 * k];
+        driftY[k] = pattern->getY() - points[2 * k + 1];
+        located[k] = true;
+        found++;
+      } catch (zxing::ReaderException const& re) {
+        (void)re;
+        driftX[k] = dx;
+        driftY[k] = dy;
+      }
+      points[2 * k] += driftX[k];
+      points[2 * k + 1] += driftY[k];
+    }
+  }
+  if (!found) {
+    return Ref<BitMatrix>();
+  }
+
+  // The outermost cells extend to the edges of the symbol
+  GridSampler &sampler = GridSampler::getInstance();
+  Ref<BitMatrix> bits(new BitMatrix(dimension));
+  try {
+    for (int j = 0; j < n - 1; j++) {
+      const int top = j ? alignmentCenters[j] : 0;
+      const int bottom = (j < n - 2) ? alignmentCenters[j + 1] : dimension;
+      for (int i = 0; i < n - 1; i++) {
+        const int left = i ? alignmentCenters[i] : 0;
+        const int right = (i < n - 2) ? alignmentCenters[i + 1] : dimension;
+        const int k = j * n + i;
+        Ref<PerspectiveTransform> cell(PerspectiveTransform::quadrilateralToQuadrilateral(
+          from[2 * k], from[2 * k + 1], from[2 * (k + 1)], from[2 * (k + 1) + 1],
+          from[2 * (k + n + 1)], from[2 * (k + n + 1) + 1], from[2 * (k + n)], from[2 * (k + n) + 1],
+          points[2 * k], points[2 * k + 1], points[2 * (k + 1)], points[2 * (k + 1) + 1],
+          points[2 * (k + n + 1)], points[2 * (k + n + 1) + 1], points[2 * (k + n)], points[2 * (k + n) + 1]));
+        sampler.sampleGrid(image_, bits, left, top, right, bottom, cell);
+      }
+    }
+  } catch (zxing::ReaderException const& re) {
+    // A drifted corner near the edge of the frame may end up outside
+    // the image, leave it to the single transform
+    (void)re;
+    return Ref<BitMatrix>();
+  }
+  return bits;
+}
+
 int Detector::computeDimension(Ref<ResultPoint> topLeft, Ref<ResultPoint> topRight, Ref<ResultPoint> bottomLeft,
                                float moduleSize) {
   int tltrCentersDimension =
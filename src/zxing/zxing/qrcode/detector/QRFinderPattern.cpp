@@ -21,8 +21,6 @@
 
 #include <zxing/qrcode/detector/FinderPattern.h>
 
-using std::abs;
-using zxing::Ref;
 using zxing::qrcode::FinderPattern;		
 
 FinderPattern::FinderPattern(float posX, float posY, float estimatedModuleSize)
@@ -43,27 +41,4 @@ void FinderPattern::incrementCount() {
   count_++;
   // cerr << "ic " << getX() << " " << getY() << " " << count_ << endl;
 }
-		
-/*
-  bool FinderPattern::aboutEquals(float moduleSize, float i, float j) const {
-  return abs(i - posY_) <= moduleSize && abs(j - posX_) <= moduleSize && (abs(moduleSize - estimatedModuleSize_)
-  <= 1.0f || abs(moduleSize - estimatedModuleSize_) / estimatedModuleSize_ <= 0.1f);
-  }
-*/
-bool FinderPattern::aboutEquals(float moduleSize, float i, float j) const {
-  if (abs(i - getY()) <= moduleSize && abs(j - getX()) <= moduleSize) {
-    float moduleSizeDiff = abs(moduleSize - estimatedModuleSize_);
-    return moduleSizeDiff <= 1.0f || moduleSizeDiff <= estimatedModuleSize_;
-  }
-  return false;
-}
-		
-Ref<FinderPattern> FinderPattern::combineEstimate(float i, float j, float newModuleSize) const {
-  // fprintf(stderr, "ce %f %f %f\n", i, j, newModuleSize);
 
-  int combinedCount = count_ + 1;
-  float combinedX = (count_ * getX() + j) / combinedCount;
-  float combinedY = (count_ * getY() + i) / combinedCount;
-  float combinedModuleSize = (count_ * getEstimatedModuleSize() + newModuleSize) / combinedCount;
-  return Ref<FinderPattern>(new FinderPattern(combinedX, combinedY, combinedModuleSize, combinedCount));
-}
@@ -50,9 +50,10 @@ public:
   FurthestFromAverageComparator(float averageModuleSize) :
     averageModuleSize_(averageModuleSize) {
   }
-  bool operator()(Ref<FinderPattern> a, Ref<FinderPattern> b) {
-    float dA = abs(a->getEstimatedModuleSize() - averageModuleSize_);
-    float dB = abs(b->getEstimatedModuleSize() - averageModuleSize_);
+  template <class T>
+  bool operator()(T const& a, T const& b) {
+    float dA = abs(a.estimatedModuleSize - averageModuleSize_);
+    float dB = abs(b.estimatedModuleSize - averageModuleSize_);
     return dA > dB;
   }
 };
@@ -63,13 +64,14 @@ public:
   CenterComparator(float averageModuleSize) :
     averageModuleSize_(averageModuleSize) {
   }
-  bool operator()(Ref<FinderPattern> a, Ref<FinderPattern> b) {
+  template <class T>
+  bool operator()(T const& a, T const& b) {
     // N.B.: we want the result in descending order ...
-    if (a->getCount() != b->getCount()) {
-      return a->getCount() > b->getCount();
+    if (a.count != b.count) {
+      return a.count > b.count;
     } else {
-      float dA = abs(a->getEstimatedModuleSize() - averageModuleSize_);
-      float dB = abs(b->getEstimatedModuleSize() - averageModuleSize_);
+      float dA = abs(a.estimatedModuleSize - averageModuleSize_);
+      float dB = abs(b.estimatedModuleSize - averageModuleSize_);
       return dA < dB;
     }
   }
@@ -81,6 +83,26 @@ int FinderPatternFinder::CENTER_QUORUM = 2;
 int FinderPatternFinder::MIN_SKIP = 3;
 int FinderPatternFinder::MAX_MODULES = 57;
 
+bool FinderPatternFinder::Center::aboutEquals(float moduleSize, float i, float j) const {
+  if (abs(i - y) <= moduleSize && abs(j - x) <= moduleSize) {
+    float moduleSizeDiff = abs(moduleSize - estimatedModuleSize);
+    return moduleSizeDiff <= 1.0f || moduleSizeDiff <= estimatedModuleSize;
+  }
+  return false;
+}
+
+void FinderPatternFinder::Center::combineEstimate(float i, float j, float newModuleSize) {
+  int combinedCount = count + 1;
+  x = (count * x + j) / combinedCount;
+  y = (count * y + i) / combinedCount;
+  estimatedModuleSize = (count * estimatedModuleSize + newModuleSize) / combinedCount;
+  count = combinedCount;
+}
+
+Ref<FinderPattern> FinderPatternFinder::Center::toFinderPattern() const {
+  return Ref<FinderPattern>(new FinderPattern(x, y, estimatedModuleSize, count));
+}
+
 float FinderPatternFinder::centerFromEnd(int* stateCount, int end) {
   return (float)(end - stateCount[4] - stateCount[3]) - stateCount[2] / 2.0f;
 }
@@ -245,19 +267,18 @@ bool FinderPatternFinder::handlePossibleCenter(int* stateCount, size_t i, size_t
       bool found = false;
       size_t max = possibleCenters_.size();
       for (size_t index = 0; index < max; index++) {
-        Ref<FinderPattern> center = possibleCenters_[index];
+        Center& center = possibleCenters_[index];
         // Look for about the same center and module size:
-        if (center->aboutEquals(estimatedModuleSize, centerI, centerJ)) {
-          possibleCenters_[index] = center->combineEstimate(centerI, centerJ, estimatedModuleSize);
+        if (center.aboutEquals(estimatedModuleSize, centerI, centerJ)) {
+          center.combineEstimate(centerI, centerJ, estimatedModuleSize);
           found = true;
           break;
         }
       }
       if (!found) {
-        Ref<FinderPattern> newPattern(new FinderPattern(centerJ, centerI, estimatedModuleSize));
-        possibleCenters_.push_back(newPattern);
+        possibleCenters_.push_back(Center(centerJ, centerI, estimatedModuleSize));
         if (callback_ != 0) {
-          callback_->foundPossibleResultPoint(*newPattern);
+          callback_->foundPossibleResultPoint(ResultPoint(centerJ, centerI));
         }
       }
       return true;
@@ -271,11 +292,11 @@ int FinderPatternFinder::findRowSkip() {
   if (max <= 1) {
     return 0;
   }
-  Ref<FinderPattern> firstConfirmedCenter;
+  const Center* firstConfirmedCenter = NULL;
   for (size_t i = 0; i < max; i++) {
-    Ref<FinderPattern> center = possibleCenters_[i];
-    if (center->getCount() >= CENTER_QUORUM) {
-      if (firstConfirmedCenter == 0) {
+    const Center* center = &possibleCenters_[i];
+    if (center->count >= CENTER_QUORUM) {
+      if (!firstConfirmedCenter) {
         firstConfirmedCenter = center;
       } else {
         // We have two confirmed centers
@@ -284,8 +305,8 @@ int FinderPatternFinder::findRowSkip() {
         // difference in the x / y coordinates of the two centers.
         // This is the case where you find top left first. Draw it out.
         hasSkipped_ = true;
-        return (int)(abs(firstConfirmedCenter->getX() - center->getX()) - abs(firstConfirmedCenter->getY()
-                     - center->getY()))/2;
+        return (int)(abs(firstConfirmedCenter->x - center->x) - abs(firstConfirmedCenter->y
+                     - center->y))/2;
       }
     }
   }
@@ -297,10 +318,10 @@ bool FinderPatternFinder::haveMultiplyConfirmedCenters() {
   float totalModuleSize = 0.0f;
   size_t max = possibleCenters_.size();
   for (size_t i = 0; i < max; i++) {
-    Ref<FinderPattern> pattern = possibleCenters_[i];
-    if (pattern->getCount() >= CENTER_QUORUM) {
+    const Center& pattern = possibleCenters_[i];
+    if (pattern.count >= CENTER_QUORUM) {
       confirmedCount++;
-      totalModuleSize += pattern->getEstimatedModuleSize();
+      totalModuleSize += pattern.estimatedModuleSize;
     }
   }
   if (confirmedCount < 3) {
@@ -313,8 +334,7 @@ bool FinderPatternFinder::haveMultiplyConfirmedCenters() {
   float average = totalModuleSize / (float)max;
   float totalDeviation = 0.0f;
   for (size_t i = 0; i < max; i++) {
-    Ref<FinderPattern> pattern = possibleCenters_[i];
-    totalDeviation += abs(pattern->getEstimatedModuleSize() - average);
+    totalDeviation += abs(possibleCenters_[i].estimatedModuleSize - average);
   }
   return totalDeviation <= 0.05f * totalModuleSize;
 }
@@ -333,7 +353,7 @@ vector< Ref<FinderPattern> > FinderPatternFinder::selectBestPatterns() {
     float totalModuleSize = 0.0f;
     float square = 0.0f;
     for (size_t i = 0; i < startSize; i++) {
-      float size = possibleCenters_[i]->getEstimatedModuleSize();
+      float size = possibleCenters_[i].estimatedModuleSize;
       totalModuleSize += size;
       square += size * size;
     }
@@ -345,7 +365,7 @@ vector< Ref<FinderPattern> > FinderPatternFinder::selectBestPatterns() {
     float limit = max(0.2f * average, stdDev);
 
     for (size_t i = 0; i < possibleCenters_.size() && possibleCenters_.size() > 3; i++) {
-      if (abs(possibleCenters_[i]->getEstimatedModuleSize() - average) > limit) {
+      if (abs(possibleCenters_[i].estimatedModuleSize - average) > limit) {
         possibleCenters_.erase(possibleCenters_.begin()+i);
         i--;
       }
@@ -356,7 +376,7 @@ vector< Ref<FinderPattern> > FinderPatternFinder::selectBestPatterns() {
     // Throw away all but those first size candidate points we found.
     float totalModuleSize = 0.0f;
     for (size_t i = 0; i < possibleCenters_.size(); i++) {
-      float size = possibleCenters_[i]->getEstimatedModuleSize();
+      float size = possibleCenters_[i].estimatedModuleSize;
       totalModuleSize += size;
     }
     float average = totalModuleSize / (float) possibleCenters_.size();
@@ -368,9 +388,9 @@ vector< Ref<FinderPattern> > FinderPatternFinder::selectBestPatterns() {
   }
 
   vector<Ref<FinderPattern> > result(3);
-  result[0] = possibleCenters_[0];
-  result[1] = possibleCenters_[1];
-  result[2] = possibleCenters_[2];
+  result[0] = possibleCenters_[0].toFinderPattern();
+  result[1] = possibleCenters_[1].toFinderPattern();
+  result[2] = possibleCenters_[2].toFinderPattern();
   return result;
 }
 
@@ -425,6 +445,7 @@ float FinderPatternFinder::distance(Ref<ResultPoint> p1, Ref<ResultPoint> p2) {
 FinderPatternFinder::FinderPatternFinder(Ref<BitMatrix> image,
                                            Ref<ResultPointCallback>const& callback) :
     image_(image), possibleCenters_(), hasSkipped_(false), callback_(callback) {
+  possibleCenters_.reserve(16);
 }
 
 Ref<FinderPatternInfo> FinderPatternFinder::find(DecodeHints const& hints) {
@@ -554,8 +575,13 @@ Ref<BitMatrix> FinderPatternFinder::getImage() {
   return image_;
 }
 
-vector<Ref<FinderPattern> >& FinderPatternFinder::getPossibleCenters() {
-    return possibleCenters_;
+vector<Ref<FinderPattern> > FinderPatternFinder::getPossibleCenters() const {
+  vector<Ref<FinderPattern> > centers;
+  centers.reserve(possibleCenters_.size());
+  for (size_t i = 0; i < possibleCenters_.size(); i++) {
+    centers.push_back(possibleCenters_[i].toFinderPattern());
+  }
+  return centers;
 }
 
 bool FinderPatternFinder::crossCheckDiagonal(int startI, int centerJ, int maxCount, int originalStateCountTotal) const
@@ -0,0 +1,270 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Compares the direct table lookup in BitMatrixParser::getCodeword()
+// with the binary search over SYMBOL_TABLE which it has replaced.
+// The symbols are sampled from real PDF417 images (binary PGM) exactly
+// the way BitMatrixParser::processRow() reads them, damaged ones and
+// row indicators included:
+//
+//   pdf417bench [-i ITERATIONS] [-r RUNS] PDF417.pgm...
+//
+// Both lookups must produce the same codeword and cluster for every
+// symbol, otherwise the exit status is non-zero.
+
+#include <zxing/DecodeHints.h>
+#include <zxing/Exception.h>
+#include <zxing/LuminanceSource.h>
+#include <zxing/BinaryBitmap.h>
+#include <zxing/common/DetectorResult.h>
+#include <zxing/common/HybridBinarizer.h>
+#include <zxing/pdf417/decoder/BitMatrixParser.h>
+#include <zxing/pdf417/detector/Detector.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
+using zxing::pdf417::decoder::BitMatrixParser;
+
+namespace {
+
+// ==========================================================================
+// Image
+// ==========================================================================
+
+class Image : public zxing::LuminanceSource {
+public:
+    Image(int aWidth, int aHeight, std::vector<unsigned char>& aPixels) :
+        zxing::LuminanceSource(aWidth, aHeight) { iPixels.swap(aPixels); }
+
+    static zxing::Ref<Image> load(const char* aPath);
+
+    zxing::ArrayRef<zxing::byte> getRow(int aY, zxing::ArrayRef<zxing::byte> aRow) const {
+        const int w = getWidth();
+        if (!aRow || aRow->size() < w) {
+            aRow = zxing::ArrayRef<zxing::byte>(w);
+        }
+        memcpy(&aRow[0], &iPixels[aY * w], w);
+        return aRow;
+    }
+
+    zxing::ArrayRef<zxing::byte> getMatrix() const {
+        zxing::ArrayRef<zxing::byte> matrix(getWidth() * getHeight());
+        memcpy(&matrix[0], &iPixels[0], iPixels.size());
+        return matrix;
+    }
+
+private:
+    std::vector<unsigned char> iPixels;
+};
+
+zxing::Ref<Image> Image::load(const char* aPath)
+{
+    zxing::Ref<Image> image;
+    FILE* f = fopen(aPath, "rb");
+    if (f) {
+        int w, h, max;
+        if (fscanf(f, "P5 %d %d %d", &w, &h, &max) == 3 &&
+            w > 0 && h > 0 && max == 255 && fgetc(f) != EOF) {
+            std::vector<unsigned char> data(w * h);
+            if (fread(&data[0], 1, data.size(), f) == data.size()) {
+                image = new Image(w, h, data);
+            }
+        }
+        fclose(f);
+    }
+    return image;
+}
+
+// ==========================================================================
+// Symbols
+// ==========================================================================
+
+// Appends the symbols of the detected PDF417 code to aSymbols, walking
+// the sampled matrix the same way as BitMatrixParser::processRow()
+int readSymbols(zxing::Ref<Image> aImage, std::vector<int64_t>* aSymbols)
+{
+    zxing::Ref<zxing::BinaryBitmap> bitmap(new zxing::BinaryBitmap
+        (zxing::Ref<zxing::Binarizer>(new zxing::HybridBinarizer(aImage))));
+    zxing::pdf417::detector::Detector detector(bitmap);
+    zxing::Ref<zxing::BitMatrix> bits(detector.detect
+        (zxing::DecodeHints(zxing::DecodeHints::PDF_417_HINT))->getBits());
+    const int n = 17; // BitMatrixParser::MODULES_IN_SYMBOL
+    const int width = bits->getWidth();
+    const int height = bits->getHeight();
+    int count = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x += n) {
+            int64_t symbol = 0;
+            for (int mask = n - 1; mask >= 0; mask--) {
+                if (bits->get(x + (n - 1 - mask), y)) {
+                    symbol |= int64_t(1) << mask;
+                }
+            }
+            aSymbols->push_back(symbol);
+            count++;
+        }
+    }
+    return count;
+}
+
+// ==========================================================================
+// Lookups
+// ==========================================================================
+
+// The binary search that BitMatrixParser::getCodeword() used to do
+int searchCodeword(int64_t aSymbol, int* aCluster)
+{
+    const int symbol = (int)(aSymbol & 0x3FFFF);
+    int first = 0;
+    int upto = BitMatrixParser::SYMBOL_TABLE_LENGTH;
+    while (first < upto) {
+        const int mid = ((unsigned int)(first + upto)) >> 1;
+        if (symbol < BitMatrixParser::SYMBOL_TABLE[mid]) {
+            upto = mid;
+        } else if (symbol > BitMatrixParser::SYMBOL_TABLE[mid]) {
+            first = mid + 1;
+        } else {
+            const int cw = BitMatrixParser::CODEWORD_TABLE[mid] - 1;
+            *aCluster = cw / 929;
+            return cw % 929;
+        }
+    }
+    return -1;
+}
+
+int lookupCodeword(int64_t aSymbol, int* aCluster)
+{
+    return BitMatrixParser::getCodeword(aSymbol, aCluster);
+}
+
+typedef int (*LookupFunc)(int64_t aSymbol, int* aCluster);
+
+// Returns the best of aRuns attempts in nanoseconds per lookup, which
+// filters out most of the scheduling noise
+double lookupTime(LookupFunc aLookup, const std::vector<int64_t>& aSymbols,
+    int aIterations, int aRuns, long* aSum)
+{
+    double best = 0;
+    for (int r = 0; r < aRuns; r++) {
+        long sum = 0;
+        const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        for (int i = 0; i < aIterations; i++) {
+            for (size_t k = 0; k < aSymbols.size(); k++) {
+                int cluster = -1;
+                sum += aLookup(aSymbols[k], &cluster) + cluster;
+            }
+        }
+        const double ns = std::chrono::duration<double,std::nano>
+            (std::chrono::steady_clock::now() - start).count() /
+            ((double)aIterations * aSymbols.size());
+        if (!r || ns < best) {
+            best = ns;
+        }
+        // Keeps the compiler from throwing the loop away
+        *aSum = sum;
+    }
+    return best;
+}
+
+int usage(const char* aName)
+{
+    fprintf(stderr, "Usage: %s [-i ITERATIONS] [-r RUNS] PDF417.pgm...\n",
+        aName);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int iterations = 1000;
+    int runs = 5;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:r:")) != -1) {
+        switch (opt) {
+        case 'i': iterations = atoi(optarg); break;
+        case 'r': runs = atoi(optarg); break;
+        default: return usage(argv[0]);
+        }
+    }
+    if (optind >= argc || iterations < 1 || runs < 1) {
+        return usage(argv[0]);
+    }
+
+    std::vector<int64_t> symbols;
+    for (int i = optind; i < argc; i++) {
+        zxing::Ref<Image> image(Image::load(argv[i]));
+        if (!image) {
+            fprintf(stderr, "%s: not an 8-bit binary PGM\n", argv[i]);
+            return 1;
+        }
+        try {
+            printf("%s: %d symbols\n", argv[i], readSymbols(image, &symbols));
+        } catch (const zxing::Exception& e) {
+            printf("%s: %s\n", argv[i], e.what());
+        }
+    }
+    if (symbols.empty()) {
+        fprintf(stderr, "No PDF417 symbols found\n");
+        return 1;
+    }
+
+    int invalid = 0, mismatches = 0;
+    for (size_t k = 0; k < symbols.size(); k++) {
+        int cluster1 = -1, cluster2 = -1;
+        const int cw1 = searchCodeword(symbols[k], &cluster1);
+        const int cw2 = lookupCodeword(symbols[k], &cluster2);
+        if (cw1 < 0) {
+            invalid++;
+        }
+        if (cw1 != cw2 || cluster1 != cluster2) {
+            fprintf(stderr, "0x%05lx: search %d/%d, lookup %d/%d\n",
+                (long)symbols[k], cw1, cluster1, cw2, cluster2);
+            mismatches++;
+        }
+    }
+
+    long sum1 = 0, sum2 = 0;
+    const double t1 = lookupTime(searchCodeword, symbols, iterations, runs, &sum1);
+    const double t2 = lookupTime(lookupCodeword, symbols, iterations, runs, &sum2);
+    printf("%u symbols (%d invalid), %d iterations\n",
+        (unsigned int)symbols.size(), invalid, iterations);
+    printf("binary search: %.2f ns/symbol\n", t1);
+    printf("table lookup:  %.2f ns/symbol (%.1fx)\n", t2, t1 / t2);
+    if (sum1 != sum2) {
+        mismatches++;
+    }
+    if (mismatches) {
+        printf("%d mismatch(es)\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,13 @@
+# PDF417 codeword lookup benchmark, see pdf417bench.cpp
+#
+# qmake && make
+# ./pdf417bench [-i ITERATIONS] PDF417.pgm...
+
+TEMPLATE = app
+TARGET = pdf417bench
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../zxing.pri)
+
+SOURCES += pdf417bench.cpp
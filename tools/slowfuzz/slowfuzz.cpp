@@ -0,0 +1,572 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Searches for inputs that take the decoder a long time to reject or
+// accept. Seed images (binary PGM) are mutated over and over, every
+// mutant is run through the same LuminanceSource -> MultiFormatReader
+// path the app uses, and the slowest ones are kept as the next parents.
+// When the search is over, the survivors are written out as PGM files
+// named after their decoding time:
+//
+//   slowfuzz [-o DIR] [-n KEEP] [-i ITERATIONS] [-r RUNS] [-s SEED]
+//            [-b global|hybrid|adaptive] [-t] SEED.pgm...
+//
+// Any of the results can be replayed in the app through the debug input
+// hook (see BarcodeScanner). Nothing is written to disk while a decode
+// is being timed.
+//
+// Building with SLOWFUZZ_LIBFUZZER defined (and -fsanitize=fuzzer)
+// produces a libFuzzer target instead, run it with -report_slow_units
+// and -timeout to have libFuzzer do the search.
+
+#include <zxing/DecodeHints.h>
+#include <zxing/Exception.h>
+#include <zxing/LuminanceSource.h>
+#include <zxing/MultiFormatReader.h>
+#include <zxing/BinaryBitmap.h>
+#include <zxing/common/GlobalHistogramBinarizer.h>
+#include <zxing/common/HybridBinarizer.h>
+#include <zxing/common/AdaptiveBinarizer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+// ==========================================================================
+// Image
+// ==========================================================================
+
+struct Image {
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+
+    Image() : width(0), height(0) {}
+    Image(int aWidth, int aHeight) : width(aWidth), height(aHeight),
+        pixels(aWidth * aHeight) {}
+
+    unsigned char* row(int aY) { return &pixels[aY * width]; }
+    const unsigned char* row(int aY) const { return &pixels[aY * width]; }
+};
+
+// ==========================================================================
+// Source
+// ==========================================================================
+
+class Source : public zxing::LuminanceSource {
+public:
+    Source(const Image& aImage) :
+        zxing::LuminanceSource(aImage.width, aImage.height),
+        iImage(aImage) {}
+
+    zxing::ArrayRef<zxing::byte> getRow(int aY, zxing::ArrayRef<zxing::byte> aRow) const {
+        const int w = getWidth();
+        if (!aRow || aRow->size() < w) {
+            aRow = zxing::ArrayRef<zxing::byte>(w);
+        }
+        memcpy(&aRow[0], iImage.row(aY), w);
+        return aRow;
+    }
+
+    zxing::ArrayRef<zxing::byte> getMatrix() const {
+        zxing::ArrayRef<zxing::byte> matrix(getWidth() * getHeight());
+        memcpy(&matrix[0], &iImage.pixels[0], iImage.pixels.size());
+        return matrix;
+    }
+
+private:
+    const Image& iImage;
+};
+
+// ==========================================================================
+// Decoder
+// ==========================================================================
+
+enum BinarizerType {
+    BinarizerGlobal,
+    BinarizerHybrid,
+    BinarizerAdaptive
+};
+
+class Decoder {
+public:
+    Decoder(BinarizerType aBinarizer, bool aTryHarder);
+
+    bool decode(const Image& aImage);
+
+private:
+    BinarizerType iBinarizer;
+    zxing::MultiFormatReader iReader;
+    zxing::DecodeHints iHints;
+};
+
+Decoder::Decoder(BinarizerType aBinarizer, bool aTryHarder) :
+    iBinarizer(aBinarizer),
+    iHints(zxing::DecodeHints::DEFAULT_HINT)
+{
+    // Same as the app
+    iHints.setMotionDeblur(true);
+    iHints.setTryHarder(aTryHarder);
+}
+
+bool Decoder::decode(const Image& aImage)
+{
+    zxing::Ref<zxing::LuminanceSource> source(new Source(aImage));
+    zxing::Ref<zxing::Binarizer> binarizer;
+    switch (iBinarizer) {
+    case BinarizerHybrid:
+        binarizer = new zxing::HybridBinarizer(source);
+        break;
+    case BinarizerAdaptive:
+        binarizer = new zxing::AdaptiveBinarizer(source);
+        break;
+    default:
+        binarizer = new zxing::GlobalHistogramBinarizer(source);
+        break;
+    }
+    try {
+        zxing::Ref<zxing::BinaryBitmap> bitmap(new zxing::BinaryBitmap(binarizer));
+        return iReader.decode(bitmap, iHints) != NULL;
+    } catch (zxing::Exception&) {
+        return false;
+    }
+}
+
+// ==========================================================================
+// Mutator
+//
+// Each mutation produces something a camera could plausibly deliver, or
+// something that looks like a part of a barcode to one of the readers.
+// ==========================================================================
+
+class Mutator {
+public:
+    typedef std::mt19937 Random;
+
+    Mutator(unsigned int aSeed) : iRandom(aSeed) {}
+
+    void mutate(Image& aImage);
+
+private:
+    int random(int aMax) { return std::uniform_int_distribution<int>(0, aMax - 1)(iRandom); }
+    int random(int aMin, int aMax) { return aMin + random(aMax - aMin + 1); }
+    void pickRect(const Image& aImage, int* aX, int* aY, int* aW, int* aH);
+
+    void noise(Image& aImage);
+    void stripes(Image& aImage);
+    void finders(Image& aImage);
+    void copyBlock(Image& aImage);
+    void contrast(Image& aImage);
+    void blur(Image& aImage);
+    void crop(Image& aImage);
+
+private:
+    Random iRandom;
+};
+
+void Mutator::mutate(Image& aImage)
+{
+    const int count = random(1, 4);
+    for (int i = 0; i < count; i++) {
+        switch (random(7)) {
+        case 0: noise(aImage); break;
+        case 1: stripes(aImage); break;
+        case 2: finders(aImage); break;
+        case 3: copyBlock(aImage); break;
+        case 4: contrast(aImage); break;
+        case 5: blur(aImage); break;
+        default: crop(aImage); break;
+        }
+    }
+}
+
+void Mutator::pickRect(const Image& aImage, int* aX, int* aY, int* aW, int* aH)
+{
+    *aW = random(1, aImage.width);
+    *aH = random(1, aImage.height);
+    *aX = random(aImage.width - *aW + 1);
+    *aY = random(aImage.height - *aH + 1);
+}
+
+void Mutator::noise(Image& aImage)
+{
+    int x0, y0, w, h;
+    pickRect(aImage, &x0, &y0, &w, &h);
+    std::normal_distribution<double> delta(0, random(4, 64));
+    for (int y = y0; y < y0 + h; y++) {
+        unsigned char* row = aImage.row(y);
+        for (int x = x0; x < x0 + w; x++) {
+            row[x] = (unsigned char)std::max(0, std::min(255,
+                (int)(row[x] + delta(iRandom))));
+        }
+    }
+}
+
+// Bars of random width, a lure for the 1D readers
+void Mutator::stripes(Image& aImage)
+{
+    int x0, y0, w, h;
+    pickRect(aImage, &x0, &y0, &w, &h);
+    const int dark = random(0, 96);
+    const int light = random(160, 255);
+    const int maxBar = random(1, 8);
+    std::vector<unsigned char> pattern(w);
+    bool black = random(2);
+    for (int x = 0; x < w;) {
+        const int end = std::min(w, x + random(1, maxBar));
+        std::fill(pattern.begin() + x, pattern.begin() + end,
+            (unsigned char)(black ? dark : light));
+        black = !black;
+        x = end;
+    }
+    for (int y = y0; y < y0 + h; y++) {
+        memcpy(aImage.row(y) + x0, &pattern[0], w);
+    }
+}
+
+// Squares with 1:1:3:1:1 rings, a lure for the QR and Aztec detectors
+void Mutator::finders(Image& aImage)
+{
+    const int count = random(1, 8);
+    for (int i = 0; i < count; i++) {
+        const int module = random(1, std::max(1, std::min(aImage.width,
+            aImage.height) / 14));
+        const int size = module * 7;
+        if (size > aImage.width || size > aImage.height) {
+            break;
+        }
+        const int x0 = random(aImage.width - size + 1);
+        const int y0 = random(aImage.height - size + 1);
+        for (int y = 0; y < size; y++) {
+            unsigned char* row = aImage.row(y0 + y) + x0;
+            const int my = y / module;
+            for (int x = 0; x < size; x++) {
+                const int mx = x / module;
+                const int ring = std::min(std::min(mx, my),
+                    std::min(6 - mx, 6 - my));
+                row[x] = (ring == 1) ? 255 : 0;
+            }
+        }
+    }
+}
+
+// Repeats a piece of the image elsewhere, which multiplies whatever
+// made that piece expensive
+void Mutator::copyBlock(Image& aImage)
+{
+    int x0, y0, w, h;
+    pickRect(aImage, &x0, &y0, &w, &h);
+    const int x1 = random(aImage.width - w + 1);
+    const int y1 = random(aImage.height - h + 1);
+    const Image copy(aImage);
+    for (int y = 0; y < h; y++) {
+        memcpy(aImage.row(y1 + y) + x1, copy.row(y0 + y) + x0, w);
+    }
+}
+
+void Mutator::contrast(Image& aImage)
+{
+    const int mid = random(32, 224);
+    const int percent = random(10, 300);
+    for (size_t i = 0; i < aImage.pixels.size(); i++) {
+        const int p = mid + (aImage.pixels[i] - mid) * percent / 100;
+        aImage.pixels[i] = (unsigned char)std::max(0, std::min(255, p));
+    }
+}
+
+// Horizontal box blur of a random radius, like motion or bad focus
+void Mutator::blur(Image& aImage)
+{
+    const int r = random(1, 6);
+    std::vector<unsigned char> line(aImage.width);
+    for (int y = 0; y < aImage.height; y++) {
+        unsigned char* row = aImage.row(y);
+        for (int x = 0; x < aImage.width; x++) {
+            const int left = std::max(0, x - r);
+            const int right = std::min(aImage.width - 1, x + r);
+            int sum = 0;
+            for (int k = left; k <= right; k++) {
+                sum += row[k];
+            }
+            line[x] = (unsigned char)(sum / (right - left + 1));
+        }
+        memcpy(row, &line[0], aImage.width);
+    }
+}
+
+void Mutator::crop(Image& aImage)
+{
+    static const int MinSize = 32;
+    if (aImage.width > MinSize && aImage.height > MinSize) {
+        const int w = random(MinSize, aImage.width);
+        const int h = random(MinSize, aImage.height);
+        const int x0 = random(aImage.width - w + 1);
+        const int y0 = random(aImage.height - h + 1);
+        Image cropped(w, h);
+        for (int y = 0; y < h; y++) {
+            memcpy(cropped.row(y), aImage.row(y0 + y) + x0, w);
+        }
+        aImage = cropped;
+    }
+}
+
+} // namespace
+
+#ifdef SLOWFUZZ_LIBFUZZER
+
+// The first two bytes are the width, the rest are pixels. libFuzzer
+// mutates the bytes, reports the units that take longer than
+// -report_slow_units seconds and keeps the ones that exceed -timeout.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* aData, size_t aSize)
+{
+    static Decoder decoder(BinarizerGlobal, true);
+    if (aSize > 2) {
+        const int width = (aData[0] << 8) | aData[1];
+        const int height = width ? (int)((aSize - 2) / width) : 0;
+        if (width > 0 && height > 0) {
+            Image image(width, height);
+            memcpy(&image.pixels[0], aData + 2, image.pixels.size());
+            decoder.decode(image);
+        }
+    }
+    return 0;
+}
+
+// Lets libFuzzer apply the image mutations rather than random byte flips,
+// which would mostly produce noise
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t* aData, size_t aSize,
+    size_t aMaxSize, unsigned int aSeed)
+{
+    const int width = (aSize > 2) ? ((aData[0] << 8) | aData[1]) : 0;
+    const int height = width ? (int)((aSize - 2) / width) : 0;
+    if (width > 0 && height > 0) {
+        Image image(width, height);
+        memcpy(&image.pixels[0], aData + 2, image.pixels.size());
+        Mutator(aSeed).mutate(image);
+        const size_t size = image.pixels.size() + 2;
+        if (size <= aMaxSize) {
+            aData[0] = (uint8_t)(image.width >> 8);
+            aData[1] = (uint8_t)image.width;
+            memcpy(aData + 2, &image.pixels[0], image.pixels.size());
+            return size;
+        }
+    }
+    return aSize;
+}
+
+#else // !SLOWFUZZ_LIBFUZZER
+
+// ==========================================================================
+// Search
+// ==========================================================================
+
+namespace {
+
+bool loadImage(Image* aImage, const char* aPath)
+{
+    bool ok = false;
+    FILE* f = fopen(aPath, "rb");
+    if (f) {
+        int w, h, max;
+        if (fscanf(f, "P5 %d %d %d", &w, &h, &max) == 3 &&
+            w > 0 && h > 0 && max == 255 && fgetc(f) != EOF) {
+            std::vector<unsigned char> data(w * h);
+            if (fread(&data[0], 1, data.size(), f) == data.size()) {
+                aImage->width = w;
+                aImage->height = h;
+                aImage->pixels.swap(data);
+                ok = true;
+            }
+        }
+        fclose(f);
+    }
+    return ok;
+}
+
+bool saveImage(const Image& aImage, const char* aPath)
+{
+    bool ok = false;
+    FILE* f = fopen(aPath, "wb");
+    if (f) {
+        ok = fprintf(f, "P5\n%d %d\n255\n", aImage.width, aImage.height) > 0 &&
+            fwrite(&aImage.pixels[0], 1, aImage.pixels.size(), f) ==
+            aImage.pixels.size();
+        ok = (fclose(f) == 0) && ok;
+    }
+    return ok;
+}
+
+// Returns the best of aRuns attempts in microseconds, which filters out
+// most of the scheduling noise
+double decodeTime(Decoder& aDecoder, const Image& aImage, int aRuns)
+{
+    double best = 0;
+    for (int i = 0; i < aRuns; i++) {
+        const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+        aDecoder.decode(aImage);
+        const double us = std::chrono::duration<double,std::micro>
+            (std::chrono::steady_clock::now() - start).count();
+        if (!i || us < best) {
+            best = us;
+        }
+    }
+    return best;
+}
+
+struct Corpus {
+    // Decoding time (us) => image. The first one is the fastest.
+    std::multimap<double,Image> iImages;
+    size_t iMax;
+
+    Corpus(size_t aMax) : iMax(aMax) {}
+
+    bool accepts(double aTime) const {
+        return iImages.size() < iMax || aTime > iImages.begin()->first;
+    }
+    void add(double aTime, const Image& aImage) {
+        iImages.insert(std::make_pair(aTime, aImage));
+        while (iImages.size() > iMax) {
+            iImages.erase(iImages.begin());
+        }
+    }
+    const Image& pick(unsigned int aIndex) const {
+        std::multimap<double,Image>::const_iterator it(iImages.begin());
+        std::advance(it, aIndex % iImages.size());
+        return it->second;
+    }
+};
+
+int usage(const char* aName)
+{
+    fprintf(stderr, "Usage: %s [-o DIR] [-n KEEP] [-i ITERATIONS] [-r RUNS] "
+        "[-s SEED] [-b global|hybrid|adaptive] [-t] SEED.pgm...\n", aName);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string dir(".");
+    int keep = 16;
+    int iterations = 1000;
+    int runs = 3;
+    unsigned int seed = 1;
+    bool tryHarder = false;
+    BinarizerType binarizer = BinarizerGlobal;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:n:i:r:s:b:t")) != -1) {
+        switch (opt) {
+        case 'o': dir = optarg; break;
+        case 'n': keep = atoi(optarg); break;
+        case 'i': iterations = atoi(optarg); break;
+        case 'r': runs = atoi(optarg); break;
+        case 's': seed = (unsigned int)strtoul(optarg, NULL, 0); break;
+        case 't': tryHarder = true; break;
+        case 'b':
+            if (!strcmp(optarg, "global")) {
+                binarizer = BinarizerGlobal;
+            } else if (!strcmp(optarg, "hybrid")) {
+                binarizer = BinarizerHybrid;
+            } else if (!strcmp(optarg, "adaptive")) {
+                binarizer = BinarizerAdaptive;
+            } else {
+                return usage(argv[0]);
+            }
+            break;
+        default:
+            return usage(argv[0]);
+        }
+    }
+    if (optind >= argc || keep < 1 || runs < 1 || iterations < 0) {
+        return usage(argv[0]);
+    }
+
+    Decoder decoder(binarizer, tryHarder);
+    Corpus corpus(keep);
+    std::vector<Image> seeds;
+    for (int i = optind; i < argc; i++) {
+        Image image;
+        if (loadImage(&image, argv[i])) {
+            const double us = decodeTime(decoder, image, runs);
+            printf("%s: %.0f us\n", argv[i], us);
+            seeds.push_back(image);
+            corpus.add(us, image);
+        } else {
+            fprintf(stderr, "%s: not an 8-bit binary PGM\n", argv[i]);
+        }
+    }
+    if (seeds.empty()) {
+        return 1;
+    }
+
+    // Parents mostly come from the slowest inputs found so far, with
+    // an occasional restart from one of the seeds
+    Mutator mutator(seed);
+    std::mt19937 random(seed);
+    double worst = corpus.iImages.rbegin()->first;
+    for (int i = 0; i < iterations; i++) {
+        Image image((random() % 8) ? corpus.pick(random()) :
+            seeds[random() % seeds.size()]);
+        mutator.mutate(image);
+        const double us = decodeTime(decoder, image, runs);
+        if (corpus.accepts(us)) {
+            corpus.add(us, image);
+            if (us > worst) {
+                worst = us;
+                printf("%d: %dx%d %.0f us\n", i, image.width, image.height, us);
+                fflush(stdout);
+            }
+        }
+    }
+
+    // The timing is over, only now touch the disk
+    int n = 0, failed = 0;
+    for (std::multimap<double,Image>::const_reverse_iterator it =
+         corpus.iImages.rbegin(); it != corpus.iImages.rend(); ++it) {
+        char name[64];
+        snprintf(name, sizeof(name), "slow_%08.0fus_%02d.pgm", it->first, n++);
+        const std::string path(dir + "/" + name);
+        if (saveImage(it->second, path.c_str())) {
+            printf("%s\n", path.c_str());
+        } else {
+            perror(path.c_str());
+            failed++;
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+#endif // SLOWFUZZ_LIBFUZZER
@@ -0,0 +1,20 @@
+# Standalone search for slow decoder inputs, see slowfuzz.cpp
+#
+# qmake && make
+# ./slowfuzz -o slow -i 5000 seed1.pgm seed2.pgm ...
+
+TEMPLATE = app
+TARGET = slowfuzz
+CONFIG += console
+CONFIG -= app_bundle
+
+# libFuzzer build: qmake CONFIG+=libfuzzer (requires clang)
+libfuzzer {
+    DEFINES += SLOWFUZZ_LIBFUZZER
+    QMAKE_CXXFLAGS += -fsanitize=fuzzer
+    QMAKE_LFLAGS += -fsanitize=fuzzer
+}
+
+include(../zxing.pri)
+
+SOURCES += slowfuzz.cpp
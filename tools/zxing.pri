@@ -0,0 +1,36 @@
+# zxing sources shared by the standalone tools, the same ones the app
+# builds (no encoder, no multi)
+
+QT = core
+CONFIG += c++11
+
+QMAKE_CXXFLAGS += -Wno-unused-parameter
+
+DEFINES += NO_ICONV
+
+ZXING_DIR = $$PWD/../src/zxing
+
+INCLUDEPATH += $$ZXING_DIR
+
+SOURCES += \
+    $$files($$ZXING_DIR/bigint/*.cc) \
+    $$files($$ZXING_DIR/zxing/*.cpp) \
+    $$files($$ZXING_DIR/zxing/aztec/*.cpp) \
+    $$files($$ZXING_DIR/zxing/aztec/decoder/*.cpp) \
+    $$files($$ZXING_DIR/zxing/aztec/detector/*.cpp) \
+    $$files($$ZXING_DIR/zxing/common/*.cpp) \
+    $$files($$ZXING_DIR/zxing/common/detector/*.cpp) \
+    $$files($$ZXING_DIR/zxing/common/reedsolomon/*.cpp) \
+    $$files($$ZXING_DIR/zxing/datamatrix/*.cpp) \
+    $$files($$ZXING_DIR/zxing/datamatrix/decoder/*.cpp) \
+    $$files($$ZXING_DIR/zxing/datamatrix/detector/*.cpp) \
+    $$files($$ZXING_DIR/zxing/oned/*.cpp) \
+    $$files($$ZXING_DIR/zxing/pdf417/*.cpp) \
+    $$files($$ZXING_DIR/zxing/pdf417/decoder/*.cpp) \
+    $$files($$ZXING_DIR/zxing/pdf417/decoder/ec/*.cpp) \
+    $$files($$ZXING_DIR/zxing/pdf417/detector/*.cpp) \
+    $$files($$ZXING_DIR/zxing/qrcode/*.cpp) \
+    $$files($$ZXING_DIR/zxing/qrcode/decoder/*.cpp) \
+    $$files($$ZXING_DIR/zxing/qrcode/detector/*.cpp)
+
+SOURCES -= $$ZXING_DIR/zxing/common/reedsolomon/ReedSolomonEncoder.cpp
@@ -0,0 +1,220 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2020 Slava Monich
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Regression tests for the decoder, run "zxingtest" or "zxingtest NAME".
+// The test images are rendered on the fly, so there's nothing to install.
+// Exits with a non-zero status if any of the tests fails.
+
+#include <zxing/DecodeHints.h>
+#include <zxing/Exception.h>
+#include <zxing/LuminanceSource.h>
+#include <zxing/BinaryBitmap.h>
+#include <zxing/Result.h>
+#include <zxing/common/GlobalHistogramBinarizer.h>
+#include <zxing/qrcode/QRCodeReader.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ==========================================================================
+// Image
+// ==========================================================================
+
+class Image : public zxing::LuminanceSource {
+public:
+    Image(int aWidth, int aHeight) :
+        zxing::LuminanceSource(aWidth, aHeight),
+        iPixels(aWidth * aHeight) {}
+
+    unsigned char* row(int aY) { return &iPixels[aY * getWidth()]; }
+
+    zxing::ArrayRef<zxing::byte> getRow(int aY, zxing::ArrayRef<zxing::byte> aRow) const {
+        const int w = getWidth();
+        if (!aRow || aRow->size() < w) {
+            aRow = zxing::ArrayRef<zxing::byte>(w);
+        }
+        memcpy(&aRow[0], &iPixels[aY * w], w);
+        return aRow;
+    }
+
+    zxing::ArrayRef<zxing::byte> getMatrix() const {
+        zxing::ArrayRef<zxing::byte> matrix(getWidth() * getHeight());
+        memcpy(&matrix[0], &iPixels[0], iPixels.size());
+        return matrix;
+    }
+
+private:
+    std::vector<unsigned char> iPixels;
+};
+
+std::string decodeQr(zxing::Ref<zxing::LuminanceSource> aSource)
+{
+    try {
+        zxing::qrcode::QRCodeReader reader;
+        zxing::Ref<zxing::BinaryBitmap> bitmap(new zxing::BinaryBitmap(
+            zxing::Ref<zxing::Binarizer>(new zxing::GlobalHistogramBinarizer(aSource))));
+        return reader.decode(bitmap, zxing::DecodeHints::DEFAULT_HINT)->
+            getText()->getText();
+    } catch (zxing::Exception& e) {
+        printf("  %s\n", e.what());
+        return std::string();
+    }
+}
+
+// ==========================================================================
+// QR code sampled cell by cell, partly outside the image
+// ==========================================================================
+
+// Version 7 ("EDGE TEST 7", level M, mask 0) without the quiet zone
+const char* const QR_EDGE_TEST_7[] = {
+    "XXXXXXX  XXXX    XX X X X XXXX      X XXXXXXX",
+    "X     X X  X  XXX X     X  X X  X  X  X     X",
+    "X XXX X    X XX X   X X  X  X X X  X  X XXX X",
+    "X XXX X  X  X  XX XX    XXX X   XX XX X XXX X",
+    "X XXX X X  X XX X XXXXXXXX    X   XXX X XXX X",
+    "X     X   X XXXX X  X   XX  X   X     X     X",
+    "XXXXXXX X X X X X X X X X X X X X X X XXXXXXX",
+    "         X XXXXX   XX   X X   X    X         ",
+    "X X X X  XXXXXX   XXXXXXX   X   X X X   X  X ",
+    "XX   X      XXXXX   X XX  X   X  X  X  X  XX ",
+    "  X XXXX  X  X    X X  X  X X X X    XX X  XX",
+    "X X  X X   XX  X    X XXXX   X X  X X X   X  ",
+    "X XX  X   XXX X X X   XX XX XXXX   XX   X XXX",
+    "X X       X XXXX    XX   X   X XX XX  X  X   ",
+    " XX X X XXXXX    X XXXX XXX XXXX  XXX X XXX X",
+    " X   X  XX   XXXXXXX X    XX X   X X X X X   ",
+    "XXX X X   XXXXX XX XXXX X  X XX XXXXXXXX XX X",
+    "XX   X X XX XXX  X X X X  XXXX   X   X XX XX ",
+    " X  X X XX    XX  X XXXX  XX XX XXXX XXX   X ",
+    " X  X    X XX X X   XX XXX    X   XX  X   XXX",
+    " X  XXXXX X     X X XXXXXXX X   X   XXXXX XX ",
+    "XXXXX   XX X  X X   X   XX    X   XXX   X    ",
+    "X  XX X XXXX  X XX XX X XXX X X X XXX X X X X",
+    "X XXX   XX   XX XXX X   XX X X X X  X   X    ",
+    "XXX XXXXX XXXX  XX XXXXXXXXX XXX  X XXXXX X X",
+    "XX  XX  XXX X    X X    XX XXX XXX  XXXX X X ",
+    "X     XXXXX XX X XX  X XXXXX XXX X X X XXXXXX",
+    "X      XX  XX X XX X XXX  XX  X  X X X X X  X",
+    " X  XXXX X   X   X   X XX  X    XXX  XX  XX  ",
+    "X   X   XX  XX X X X X X  XXX X  X X X X  XX ",
+    "X  XX X   XXX X X X   XXX XX  X XXX XXXXX  X ",
+    "X X      X   XX  X X   X X    XX  XXXX    XXX",
+    "XXXX XXXX  XXX      X XXXXX X  X   XX X X XX ",
+    "XXXXXX  XXX X     XXX  X X    XXX X X   XX   ",
+    "    X XXX   XX XX  XXX  XXX X XX  XX  X  XX X",
+    " XXXX  XXX XX XX    XXX X XX X X X XX   XX   ",
+    "X  XX X XX  XXXX   XXXXXX  X XXX XX XXXXXXX X",
+    "        XXX      XX X   X XXXX XXX  X   X  X ",
+    "XXXXXXX   X  X XX X X X X XX XXX XX X X XX X ",
+    "X     X  X X X XXX XX   X X   X     X   X  XX",
+    "X XXX X X  X X      XXXXX   X   XX  XXXXX XX ",
+    "X XXX X  XX X X   X   XXX X   X  X    X   XX ",
+    "X XXX X XXX X XXXX  X XX  X X X X X X   X   X",
+    "X     X  XX X  X XXX  X  X   X X  X   X   XX ",
+    "XXXXXXX XXX X  XX  X    XXX XXXX    X X X XXX",
+};
+
+// Renders the symbol flush with the right edge of the image, with the
+// area around the alignment pattern in the middle of the right column
+// (module 38,22) pushed aShift pixels to the right. The drift found
+// there makes the per-cell transform extrapolate the right column of
+// the symbol past the edge of the image, which the single transform
+// doesn't do.
+zxing::Ref<zxing::LuminanceSource> renderQrEdge(float aShift)
+{
+    const int n = sizeof(QR_EDGE_TEST_7)/sizeof(QR_EDGE_TEST_7[0]);
+    const int scale = 5;
+    const int margin = 20;
+    const int size = n * scale + 2 * margin;
+    const int x0 = size - n * scale;
+    const int y0 = margin;
+    const float cx = x0 + 38.5f * scale;
+    const float cy = y0 + 22.5f * scale;
+    const float sigma = 3.0f * scale;
+    Image* image = new Image(size, size);
+    for (int y = 0; y < size; y++) {
+        unsigned char* row = image->row(y);
+        for (int x = 0; x < size; x++) {
+            const float dx = x + 0.5f - cx;
+            const float dy = y + 0.5f - cy;
+            const float shift = aShift * expf(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+            const float u = (x + 0.5f - shift - x0) / scale;
+            const float v = (y + 0.5f - y0) / scale;
+            row[x] = (u >= 0 && u < n && v >= 0 && v < n &&
+                QR_EDGE_TEST_7[(int)v][(int)u] != ' ') ? 25 : 230;
+        }
+    }
+    return zxing::Ref<zxing::LuminanceSource>(image);
+}
+
+bool testQrEdge()
+{
+    static const float shifts[] = { 0.0f, 4.0f, 8.0f };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(shifts)/sizeof(shifts[0]); i++) {
+        const std::string text(decodeQr(renderQrEdge(shifts[i])));
+        if (text != "EDGE TEST 7") {
+            printf("  shift %.0f: \"%s\"\n", shifts[i], text.c_str());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// ==========================================================================
+// Test table
+// ==========================================================================
+
+const struct Test {
+    const char* name;
+    bool (*run)();
+} TESTS[] = {
+    { "qr_edge", testQrEdge }
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int failed = 0, count = 0;
+    for (size_t i = 0; i < sizeof(TESTS)/sizeof(TESTS[0]); i++) {
+        const Test& test = TESTS[i];
+        if (argc < 2 || !strcmp(argv[1], test.name)) {
+            const bool ok = test.run();
+            printf("%s %s\n", ok ? "PASS" : "FAIL", test.name);
+            failed += !ok;
+            count++;
+        }
+    }
+    if (!count) {
+        fprintf(stderr, "%s: no such test\n", argv[1]);
+        return 2;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+# Decoder regression tests, see zxingtest.cpp
+#
+# qmake && make && ./zxingtest
+
+TEMPLATE = app
+TARGET = zxingtest
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../zxing.pri)
+
+SOURCES += zxingtest.cpp